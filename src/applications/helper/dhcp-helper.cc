@@ -24,6 +24,7 @@
 #include "dhcp-helper.h"
 #include "ns3/dhcp-server.h"
 #include "ns3/dhcp-client.h"
+#include "ns3/dhcp-relay.h"
 #include "ns3/uinteger.h"
 #include "ns3/names.h"
 
@@ -59,6 +60,18 @@ void DhcpServerHelper::SetAttribute (
   m_factory.Set (name, value);
 }
 
+void DhcpServerHelper::AddPool (Ipv4Address pool_addr, Ipv4Mask pool_mask, Ipv4Address min_addr, Ipv4Address max_addr,
+                                Ipv4Address gateway)
+{
+  Pool pool;
+  pool.poolAddress = pool_addr;
+  pool.poolMask = pool_mask;
+  pool.minAddress = min_addr;
+  pool.maxAddress = max_addr;
+  pool.gateway = gateway;
+  m_pools.push_back (pool);
+}
+
 ApplicationContainer DhcpClientHelper::Install (Ptr<Node> node) const
 {
   return ApplicationContainer (InstallPriv (node));
@@ -79,7 +92,46 @@ Ptr<Application> DhcpClientHelper::InstallPriv (Ptr<Node> node) const
 
 Ptr<Application> DhcpServerHelper::InstallPriv (Ptr<Node> node) const
 {
-  Ptr<Application> app = m_factory.Create<DhcpServer> ();
+  Ptr<DhcpServer> app = m_factory.Create<DhcpServer> ();
+  for (std::vector<Pool>::const_iterator it = m_pools.begin (); it != m_pools.end (); it++)
+    {
+      app->AddPool (it->poolAddress, it->poolMask, it->minAddress, it->maxAddress, it->gateway);
+    }
+  node->AddApplication (app);
+
+  return app;
+}
+
+DhcpRelayHelper::DhcpRelayHelper (Ipv4Address serv_addr)
+{
+  m_factory.SetTypeId (DhcpRelay::GetTypeId ());
+  m_servers.push_back (serv_addr);
+}
+
+void DhcpRelayHelper::AddServer (Ipv4Address serv_addr)
+{
+  m_servers.push_back (serv_addr);
+}
+
+void DhcpRelayHelper::SetAttribute (
+  std::string name,
+  const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer DhcpRelayHelper::Install (Ptr<Node> node) const
+{
+  return ApplicationContainer (InstallPriv (node));
+}
+
+Ptr<Application> DhcpRelayHelper::InstallPriv (Ptr<Node> node) const
+{
+  Ptr<DhcpRelay> app = m_factory.Create<DhcpRelay> ();
+  for (std::vector<Ipv4Address>::const_iterator it = m_servers.begin (); it != m_servers.end (); it++)
+    {
+      app->AddServer (*it);
+    }
   node->AddApplication (app);
 
   return app;
@@ -29,6 +29,7 @@
 #include "ns3/node-container.h"
 #include "ns3/object-factory.h"
 #include "ns3/ipv4-address.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -98,6 +99,17 @@ public:
    */
   void SetAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * \brief Add another address pool to the servers
+   * \param pool_addr The address of the pool
+   * \param pool_mask The mask of the pool
+   * \param min_addr The lower bound of the address pool
+   * \param max_addr The upper bound of the address pool
+   * \param gateway The default router advertised to the clients, not advertised if 0.0.0.0
+   */
+  void AddPool (Ipv4Address pool_addr, Ipv4Mask pool_mask, Ipv4Address min_addr, Ipv4Address max_addr,
+                Ipv4Address gateway = Ipv4Address::GetAny ());
+
   /**
    * \brief Function to install DHCP server on a node
    * \param node The node on which DHCP server application has to be installed
@@ -112,7 +124,67 @@ private:
    * \return The pointer to the installed DHCP server
    */
   Ptr<Application> InstallPriv (Ptr<Node> node) const;
+
+  /**
+   * \brief An address pool added with AddPool
+   */
+  struct Pool
+  {
+    Ipv4Address poolAddress;           //!< The address of the pool
+    Ipv4Mask poolMask;                 //!< The mask of the pool
+    Ipv4Address minAddress;            //!< The lower bound of the address pool
+    Ipv4Address maxAddress;            //!< The upper bound of the address pool
+    Ipv4Address gateway;               //!< The default router of the pool
+  };
+
+  ObjectFactory m_factory;             //!< The subset of ns3::object for setting attributes
+  std::vector<Pool> m_pools;           //!< The pools added to the servers
+};
+
+/**
+ * \ingroup dhcp
+ *
+ * \class DhcpRelayHelper
+ * \brief The helper class used to configure and install the relay application on nodes
+ */
+class DhcpRelayHelper
+{
+public:
+  /**
+   * \brief Constructor of relay helper
+   * \param serv_addr The IP address of the DHCP server the requests are relayed to
+   */
+  DhcpRelayHelper (Ipv4Address serv_addr);
+
+  /**
+   * \brief Function to add another DHCP server the requests are relayed to
+   * \param serv_addr The IP address of the DHCP server
+   */
+  void AddServer (Ipv4Address serv_addr);
+
+  /**
+   * \brief Function to set DHCP relay attributes
+   * \param name Name of the attribute
+   * \param value Value to be set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * \brief Function to install DHCP relay on a node
+   * \param node The node on which DHCP relay application has to be installed
+   * \return The application container with DHCP relay installed
+   */
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+private:
+  /**
+   * \brief Function to install DHCP relay on a node
+   * \param node The node on which DHCP relay application has to be installed
+   * \return The pointer to the installed DHCP relay
+   */
+  Ptr<Application> InstallPriv (Ptr<Node> node) const;
   ObjectFactory m_factory;             //!< The subset of ns3::object for setting attributes
+  std::vector<Ipv4Address> m_servers;  //!< The DHCP servers the requests are relayed to
 };
 
 } // namespace ns3
@@ -27,6 +27,7 @@
 #include <ns3/ipv4.h>
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/inet-socket-address.h"
@@ -41,6 +42,7 @@
 #include "dhcp-header.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
+#include "ns3/trace-source-accessor.h"
 #include <list>
 
 namespace ns3 {
@@ -74,11 +76,27 @@ DhcpClient::GetTypeId (void)
                    "The possible value of transaction numbers ",
                    StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=1000000.0]"),
                    MakePointerAccessor (&DhcpClient::m_ran),
-                   MakePointerChecker<RandomVariableStream> ());
+                   MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("InitReboot",
+                   "Request the address of the last lease, if still valid, when the link comes back up",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DhcpClient::m_initReboot),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RapidCommit",
+                   "Ask the servers for a two-message exchange (RFC 4039)",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DhcpClient::m_rapidCommit),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("NewLease",
+                     "A new address has been leased to the client",
+                     MakeTraceSourceAccessor (&DhcpClient::m_newLease),
+                     "ns3::DhcpClient::NewLeaseTracedCallback");
   return tid;
 }
 
-DhcpClient::DhcpClient () : m_server (Ipv4Address::GetAny ())
+DhcpClient::DhcpClient () : m_server (Ipv4Address::GetAny ()),
+                             m_gateway (Ipv4Address::GetAny ()),
+                             m_cachedAddress (Ipv4Address::GetAny ())
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_socket = 0;
@@ -88,6 +106,7 @@ DhcpClient::DhcpClient () : m_server (Ipv4Address::GetAny ())
   m_rebindEvent = EventId ();
   m_nextOfferEvent = EventId ();
   m_timeout = EventId ();
+  m_collectEvent = EventId ();
 }
 
 DhcpClient::~DhcpClient ()
@@ -146,6 +165,8 @@ DhcpClient::StopApplication ()
   Simulator::Remove (m_rebindEvent);
   Simulator::Remove (m_refreshEvent);
   Simulator::Remove (m_timeout);
+  Simulator::Remove (m_nextOfferEvent);
+  Simulator::Remove (m_collectEvent);
   Ptr<Ipv4> ipv4 = GetNode ()->GetObject<Ipv4> ();
   int32_t ifIndex = ipv4->GetInterfaceForAddress (m_myAddress);
   ipv4->RemoveAddress (ifIndex, 0);
@@ -160,12 +181,27 @@ void DhcpClient::LinkStateHandler (void)
     {
       NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "LINK UP!!!! at " << Simulator::Now ().GetSeconds ());
       m_socket->SetRecvCallback (MakeCallback (&DhcpClient::NetHandler, this));
-      Boot ();
+      if (m_initReboot && m_cachedAddress != Ipv4Address::GetAny () && m_leaseExpiry > Simulator::Now ())
+        {
+          InitReboot ();
+        }
+      else
+        {
+          Boot ();
+        }
     }
   else
     {
       NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "LINK DOWN!!!! at " << Simulator::Now ().GetSeconds ()); //reinitialization
       Simulator::Remove (m_refreshEvent); //stop refresh timer!!!!
+      Simulator::Remove (m_rebindEvent);
+      Simulator::Remove (m_timeout);
+      Simulator::Remove (m_discoverEvent);
+      Simulator::Remove (m_nextOfferEvent);
+      Simulator::Remove (m_collectEvent);
+      m_offerList.clear ();
+      // the lease is remembered in m_cachedAddress, to ask for it again when the link comes back
+      m_myAddress = Ipv4Address ("0.0.0.0");
       m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());  //stop receiving on this socket !!!
 
       Ptr<Ipv4> ipv4MN = GetNode ()->GetObject<Ipv4> ();
@@ -192,10 +228,18 @@ void DhcpClient::NetHandler (Ptr<Socket> socket)
     {
       return;
     }
+  std::vector<uint8_t> rapidCommit;
   if (m_state == WAIT_OFFER && header.GetType () == DhcpHeader::DHCPOFFER)
     {
       OfferHandler (header);
     }
+  if (m_state == WAIT_OFFER && header.GetType () == DhcpHeader::DHCPACK && header.GetOption (DhcpHeader::OP_RAPIDCOMMIT, rapidCommit))
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Trace RX: DHCP ACK with rapid commit");
+      Simulator::Remove (m_discoverEvent);
+      Simulator::Remove (m_collectEvent);
+      AcceptAck (header,from);
+    }
   if (m_state == WAIT_ACK && header.GetType () == DhcpHeader::DHCPACK)
     {
       Simulator::Remove (m_nextOfferEvent);
@@ -219,6 +263,10 @@ void DhcpClient::Boot (void)
   header.SetType (DhcpHeader::DHCPDISCOVER);
   header.SetTime ();
   header.SetChaddr48 (Mac48Address::ConvertFrom (GetNode ()->GetDevice (device)->GetAddress ()));
+  if (m_rapidCommit)
+    {
+      header.SetOption (DhcpHeader::OP_RAPIDCOMMIT, std::vector<uint8_t> ());
+    }
   packet->AddHeader (header);
 
   if ((m_socket->SendTo (packet, 0, InetSocketAddress (Ipv4Address ("255.255.255.255"), DHCP_PEER_PORT))) >= 0)
@@ -234,6 +282,34 @@ void DhcpClient::Boot (void)
   m_discoverEvent = Simulator::Schedule (m_rtrs, &DhcpClient::Boot, this);
 }
 
+void DhcpClient::InitReboot (void)
+{
+  DhcpHeader header;
+  Ptr<Packet> packet;
+  packet = Create<Packet> ();
+  header.ResetOpt ();
+  m_tran = (uint32_t) (m_ran->GetValue ());
+  header.SetTran (m_tran);
+  header.SetType (DhcpHeader::DHCPREQ);
+  header.SetTime ();
+  header.SetReq (m_cachedAddress);
+  header.SetChaddr48 (Mac48Address::ConvertFrom (GetNode ()->GetDevice (device)->GetAddress ()));
+  packet->AddHeader (header);
+  m_offeredAddress = m_cachedAddress;
+
+  if ((m_socket->SendTo (packet, 0, InetSocketAddress (Ipv4Address ("255.255.255.255"), DHCP_PEER_PORT))) >= 0)
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "] Trace TX: DHCP REQUEST for cached address " << m_cachedAddress);
+    }
+  else
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Error while sending DHCP REQUEST for cached address " << m_cachedAddress);
+    }
+  m_state = WAIT_ACK;
+  // no answer: the address may belong to another subnet, start from scratch
+  m_nextOfferEvent = Simulator::Schedule (m_rtrs, &DhcpClient::Boot, this);
+}
+
 void DhcpClient::OfferHandler (DhcpHeader header)
 {
   m_offerList.push_back (header);
@@ -241,7 +317,7 @@ void DhcpClient::OfferHandler (DhcpHeader header)
     {
       Simulator::Remove (m_discoverEvent);
       m_offered = true;
-      Simulator::Schedule (m_collect, &DhcpClient::Select, this);
+      m_collectEvent = Simulator::Schedule (m_collect, &DhcpClient::Select, this);
     }
 }
 
@@ -250,16 +326,28 @@ void DhcpClient::Select (void)
   if (m_offerList.empty ())
     {
       Boot ();
+      return;
     }
   DhcpHeader header = m_offerList.front ();
   m_offerList.pop_front ();
+  ReadLease (header);
+  Request ();
+}
+
+void DhcpClient::ReadLease (const DhcpHeader &header)
+{
   m_lease = Time (Seconds (header.GetLease ()));
   m_renew = Time (Seconds (header.GetRenew ()));
   m_rebind = Time (Seconds (header.GetRebind ()));
   m_offeredAddress = header.GetYiaddr ();
   m_myMask = Ipv4Mask (header.GetMask ());
   m_server = header.GetDhcps ();
-  Request ();
+  m_gateway = Ipv4Address::GetAny ();
+  std::vector<uint8_t> router;
+  if (header.GetOption (DhcpHeader::OP_ROUTE, router))
+    {
+      m_gateway = Ipv4Address::Deserialize (&router[0]);
+    }
 }
 
 void DhcpClient::Request (void)
@@ -311,6 +399,10 @@ void DhcpClient::AcceptAck (DhcpHeader header, Address from)
   Simulator::Remove (m_refreshEvent);
   Simulator::Remove (m_timeout);
   NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Trace TX: DHCP ACK RECEIVED");
+  if (header.HasOpt (DhcpHeader::OP_LEASE))
+    {
+      ReadLease (header);
+    }
   Ptr<Ipv4> ipv4 = GetNode ()->GetObject<Ipv4> ();
   int32_t ifIndex = ipv4->GetInterfaceForAddress (m_myAddress);
   ipv4->RemoveAddress (ifIndex, 0);
@@ -320,15 +412,28 @@ void DhcpClient::AcceptAck (DhcpHeader header, Address from)
   NS_LOG_INFO ("here");
   InetSocketAddress remote = InetSocketAddress (InetSocketAddress::ConvertFrom (from).GetIpv4 (), DHCP_PEER_PORT);
   m_socket->Connect (remote);
+  if (m_myAddress != m_offeredAddress)
+    {
+      m_newLease (m_offeredAddress);
+    }
   m_myAddress = m_offeredAddress;
   Ipv4StaticRoutingHelper ipv4RoutingHelper;
   Ptr<Ipv4StaticRouting> staticRouting = ipv4RoutingHelper.GetStaticRouting (ipv4);
-  staticRouting->SetDefaultRoute (InetSocketAddress::ConvertFrom (from).GetIpv4 (), ifIndex, 0);
+  if (m_gateway != Ipv4Address::GetAny ())
+    {
+      staticRouting->SetDefaultRoute (m_gateway, ifIndex, 0);
+    }
+  else
+    {
+      staticRouting->SetDefaultRoute (InetSocketAddress::ConvertFrom (from).GetIpv4 (), ifIndex, 0);
+    }
 
   m_remoteAddress = InetSocketAddress::ConvertFrom (from).GetIpv4 ();
   NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Current DHCP Server is =" << m_remoteAddress);
 
   m_offerList.clear ();
+  m_cachedAddress = m_myAddress;
+  m_leaseExpiry = Simulator::Now () + m_lease;
   m_refreshEvent = Simulator::Schedule (m_renew, &DhcpClient::Request, this);
   m_rebindEvent = Simulator::Schedule (m_rebind, &DhcpClient::Request, this);
   m_timeout =  Simulator::Schedule (m_lease, &DhcpClient::Boot, this);
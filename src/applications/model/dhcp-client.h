@@ -29,6 +29,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
 #include "dhcp-header.h"
 #include <list>
 
@@ -42,6 +43,13 @@ class Packet;
  *
  * \class DhcpClient
  * \brief Implements the functionality of a DHCP client
+ *
+ * When the link comes back up while the last lease is still valid, the
+ * client asks for that address again with a REQUEST (INIT-REBOOT state of
+ * RFC 2131) instead of a full DISCOVER/OFFER/REQUEST/ACK exchange, and
+ * falls back to DISCOVER if no server answers. The DISCOVER messages
+ * carry the Rapid Commit option (RFC 4039), so that a server supporting it
+ * can answer directly with an ACK, without the offer collection wait.
  */
 class DhcpClient : public Application
 {
@@ -58,6 +66,13 @@ public:
    */
   DhcpClient ();
 
+  /**
+   * TracedCallback signature for a new lease.
+   *
+   * \param [in] address The address leased to the client.
+   */
+  typedef void (* NewLeaseTracedCallback)(const Ipv4Address & address);
+
   /**
    * \brief Destructor
    */
@@ -118,6 +133,12 @@ private:
    */
   void Boot (void);
 
+  /*
+   * \brief Sends DHCP REQUEST for the address of the last lease and changes
+   *        the client state to WAIT_ACK
+   */
+  void InitReboot (void);
+
   /*
    * \brief Stores DHCP offers in m_offerList
    * \param header Header of the DHCP OFFER message
@@ -129,6 +150,12 @@ private:
    */
   void Select (void);
 
+  /*
+   * \brief Stores the address and the lease parameters of an OFFER or ACK
+   * \param header Header of the DHCP message
+   */
+  void ReadLease (const DhcpHeader &header);
+
   /*
    * \brief Sends the DHCP REQUEST message and changes the client state to WAIT_ACK
    */
@@ -150,15 +177,21 @@ private:
   Ipv4Address m_myAddress;               //!< Address assigned to the client
   Ipv4Mask m_myMask;                     //!< Mask of the address assigned
   Ipv4Address m_server;                  //!< Address of the DHCP server
+  Ipv4Address m_gateway;                 //!< Default router given by the DHCP server, if any
   EventId m_requestEvent;                //!< Address refresh event
   EventId m_discoverEvent;               //!< Message retransmission event
   EventId m_refreshEvent;                //!< Message refresh event
   EventId m_rebindEvent;                 //!< Message rebind event
   EventId m_nextOfferEvent;              //!< Message next offer event
   EventId m_timeout;                     //!< The timeout period
+  EventId m_collectEvent;                //!< End of the offer collection event
   Time m_lease;                          //!< Store the lease time of address
   Time m_renew;                          //!< Store the renew time of address
   Time m_rebind;                         //!< Store the rebind time of address
+  Time m_leaseExpiry;                    //!< Expiry time of the current lease
+  Ipv4Address m_cachedAddress;           //!< Address of the lease held when the link went down
+  bool m_initReboot;                     //!< Ask for the cached address again when the link comes back
+  bool m_rapidCommit;                    //!< Ask for a two-message exchange in DISCOVER
   Time m_nextoffer;                      //!< Time to try the next offer (if request gets no reply)
   Ptr<RandomVariableStream> m_ran;       //!< Uniform random variable for transaction ID
   Time m_rtrs;                           //!< Defining the time for retransmission
@@ -166,6 +199,7 @@ private:
   bool m_offered;                        //!< Specify if the client has got any offer
   std::list<DhcpHeader> m_offerList;     //!< Stores all the offers given to the client
   uint32_t m_tran;                       //!< Stores the current transaction number to be used
+  TracedCallback<const Ipv4Address&> m_newLease; //!< Trace of the addresses newly leased to the client
 };
 
 } // namespace ns3
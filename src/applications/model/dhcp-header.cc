@@ -33,8 +33,93 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("DhcpHeader");
 NS_OBJECT_ENSURE_REGISTERED (DhcpHeader);
 
+const uint8_t DhcpHeader::MAGIC_COOKIE[4] = { 99, 130, 83, 99 };
+
+/**
+ * \brief Length constraints of a known DHCP option
+ */
+struct DhcpOptionInfo
+{
+  uint8_t code;       //!< Option code
+  uint8_t minLen;     //!< Minimum length of the value
+  uint8_t maxLen;     //!< Maximum length of the value
+  uint8_t unit;       //!< The length of the value is a multiple of unit
+  bool typed;         //!< True if the option has a dedicated accessor in DhcpHeader
+};
+
+/**
+ * \brief Registry of the known DHCP options, which are checked on reception
+ */
+static const DhcpOptionInfo g_dhcpOptions[] = {
+  { DhcpHeader::OP_MASK, 4, 4, 1, true },
+  { DhcpHeader::OP_ROUTE, 4, 252, 4, false },
+  { DhcpHeader::OP_DNS, 4, 252, 4, false },
+  { DhcpHeader::OP_ADDREQ, 4, 4, 1, true },
+  { DhcpHeader::OP_LEASE, 4, 4, 1, true },
+  { DhcpHeader::OP_OVERLOAD, 1, 1, 1, true },
+  { DhcpHeader::OP_MSGTYPE, 1, 1, 1, true },
+  { DhcpHeader::OP_SERVID, 4, 4, 1, true },
+  { DhcpHeader::OP_PARAMREQ, 1, 255, 1, false },
+  { DhcpHeader::OP_RENEW, 4, 4, 1, true },
+  { DhcpHeader::OP_REBIND, 4, 4, 1, true },
+  { DhcpHeader::OP_CLIENTID, 2, 255, 1, false },
+  { DhcpHeader::OP_RAPIDCOMMIT, 0, 0, 1, false },
+};
+
+/**
+ * \brief Find a known DHCP option
+ * \param code The option code
+ * \return the description of the option, or 0 if the option is unknown
+ */
+static const DhcpOptionInfo *
+LookupOption (uint8_t code)
+{
+  static const DhcpOptionInfo *index[256];
+  static bool built = false;
+  if (!built)
+    {
+      for (uint32_t i = 0; i < 256; i++)
+        {
+          index[i] = 0;
+        }
+      for (uint32_t i = 0; i < sizeof (g_dhcpOptions) / sizeof (g_dhcpOptions[0]); i++)
+        {
+          index[g_dhcpOptions[i].code] = &g_dhcpOptions[i];
+        }
+      built = true;
+    }
+  return index[code];
+}
+
+/**
+ * \brief Check the length of a received option
+ * \param code The option code
+ * \param len The length of the option value
+ * \return false if the option is known and its length is invalid
+ */
+static bool
+CheckOptionLength (uint8_t code, uint8_t len)
+{
+  const DhcpOptionInfo *info = LookupOption (code);
+  return info == 0 || (len >= info->minLen && len <= info->maxLen && len % info->unit == 0);
+}
+
+/**
+ * \brief Check whether an option has a dedicated accessor in DhcpHeader
+ * \param code The option code
+ * \return true if the option is decoded in its own field
+ */
+static bool
+IsTypedOption (uint8_t code)
+{
+  const DhcpOptionInfo *info = LookupOption (code);
+  return info != 0 && info->typed;
+}
+
 DhcpHeader::DhcpHeader ()
 {
+  m_op = 0;
+  m_bootp = 1;
   m_hType = 1;
   m_hLen = 6;
   m_xid = 0;
@@ -48,35 +133,38 @@ DhcpHeader::DhcpHeader ()
   m_giAddr = addr;
   m_dhcps = addr;
   m_req = addr;
-  m_len = 240;
+  m_mask = 0;
+  m_lease = 0;
+  m_renew = 0;
+  m_rebind = 0;
+  m_len = 241;
+  m_opt = 0;
+  m_overload = 0;
+}
 
-  uint32_t i;
+DhcpHeader::~DhcpHeader ()
+{
+}
 
-  for (i = 0; i < 10; i++)
-    {
-      m_hwpad[i] = 0;
-    }
-  for (i = 0; i < 64; i++)
-    {
-      m_sname[i] = 0;
-    }
-  for (i = 0; i < 128; i++)
+bool DhcpHeader::HasOpt (uint8_t option) const
+{
+  // only the options with a dedicated accessor, all below 64, are in the mask
+  return option < 64 && ((m_opt >> option) & 1);
+}
+
+void DhcpHeader::AddOpt (uint8_t option, uint32_t len)
+{
+  NS_ASSERT (option < 64);
+  if (!HasOpt (option))
     {
-      m_file[i] = 0;
+      m_len += len;
+      m_opt |= (uint64_t)1 << option;
     }
-  m_magic_cookie[0] = 99;
-  m_magic_cookie[1] = 130;
-  m_magic_cookie[2] = 83;
-  m_magic_cookie[3] = 99;
 }
 
 void DhcpHeader::SetType (uint8_t type)
 {
-  if (m_opt[OP_MSGTYPE] == false)
-    {
-      m_len += 3;
-      m_opt[OP_MSGTYPE] = true;
-    }
+  AddOpt (OP_MSGTYPE, 3);
   m_op = type;
   m_bootp = (m_op == 0||m_op == 2) ? 1 : 2;
 }
@@ -113,7 +201,7 @@ void DhcpHeader::SetChaddr48 (Mac48Address addr)
   m_chAddr48 = addr;
 }
 
-Mac48Address DhcpHeader::GetChaddr48 (void)
+Mac48Address DhcpHeader::GetChaddr48 (void) const
 {
   NS_ASSERT_MSG (m_hLen == 6, "MAC address is not 48 bit long");
   return m_chAddr48;
@@ -124,7 +212,7 @@ void DhcpHeader::SetChaddr64 (Mac64Address addr)
   m_hLen = 8;
   m_chAddr64 = addr;
 }
-Mac64Address DhcpHeader::GetChaddr64 (void)
+Mac64Address DhcpHeader::GetChaddr64 (void) const
 {
   NS_ASSERT_MSG (m_hLen == 8, "MAC address is not 64 bit long");
   return m_chAddr64;
@@ -140,13 +228,29 @@ Ipv4Address DhcpHeader::GetYiaddr (void) const
   return m_yiAddr;
 }
 
+void DhcpHeader::SetGiaddr (Ipv4Address addr)
+{
+  m_giAddr = addr;
+}
+
+Ipv4Address DhcpHeader::GetGiaddr (void) const
+{
+  return m_giAddr;
+}
+
+void DhcpHeader::SetHops (uint8_t hops)
+{
+  m_hops = hops;
+}
+
+uint8_t DhcpHeader::GetHops (void) const
+{
+  return m_hops;
+}
+
 void DhcpHeader::SetDhcps (Ipv4Address addr)
 {
-  if (m_opt[OP_SERVID] == false)
-    {
-      m_len += 6;
-      m_opt[OP_SERVID] = true;
-    }
+  AddOpt (OP_SERVID, 6);
   m_dhcps = addr;
 }
 
@@ -157,11 +261,7 @@ Ipv4Address DhcpHeader::GetDhcps (void) const
 
 void DhcpHeader::SetReq (Ipv4Address addr)
 {
-  if (m_opt[OP_ADDREQ] == false)
-    {
-      m_len += 6;
-      m_opt[OP_ADDREQ] = true;
-    }
+  AddOpt (OP_ADDREQ, 6);
   m_req = addr;
 }
 
@@ -172,11 +272,7 @@ Ipv4Address DhcpHeader::GetReq (void) const
 
 void DhcpHeader::SetMask (uint32_t addr)
 {
-  if (m_opt[OP_MASK] == false)
-    {
-      m_len += 6;
-      m_opt[OP_MASK] = true;
-    }
+  AddOpt (OP_MASK, 6);
   m_mask = addr;
 }
 
@@ -187,11 +283,7 @@ uint32_t DhcpHeader::GetMask (void) const
 
 void DhcpHeader::SetLease (uint32_t time)
 {
-  if (m_opt[OP_LEASE] == false)
-    {
-      m_len += 6;
-      m_opt[OP_LEASE] = true;
-    }
+  AddOpt (OP_LEASE, 6);
   m_lease = time;
 }
 
@@ -202,11 +294,7 @@ uint32_t DhcpHeader::GetLease (void) const
 
 void DhcpHeader::SetRenew (uint32_t time)
 {
-  if (m_opt[OP_RENEW] == false)
-    {
-      m_len += 6;
-      m_opt[OP_RENEW] = true;
-    }
+  AddOpt (OP_RENEW, 6);
   m_renew = time;
 }
 
@@ -217,11 +305,7 @@ uint32_t DhcpHeader::GetRenew (void) const
 
 void DhcpHeader::SetRebind (uint32_t time)
 {
-  if (m_opt[OP_REBIND] == false)
-    {
-      m_len += 6;
-      m_opt[OP_REBIND] = true;
-    }
+  AddOpt (OP_REBIND, 6);
   m_rebind = time;
 }
 
@@ -230,14 +314,57 @@ uint32_t DhcpHeader::GetRebind (void) const
   return m_rebind;
 }
 
-void DhcpHeader::ResetOpt ()
+void DhcpHeader::SetOption (uint8_t code, const std::vector<uint8_t> &value)
 {
-  m_len = 241;
-  int i;
-  for (i = 0; i < OP_END; i++)
+  NS_ASSERT_MSG (value.size () <= 255, "Option too long");
+  NS_ASSERT_MSG (code != OP_PAD && code != OP_END && code != OP_OVERLOAD, "Reserved option " << (uint32_t) code);
+  NS_ASSERT_MSG (!IsTypedOption (code), "Option " << (uint32_t) code << " has a dedicated accessor");
+  m_options.push_back (code);
+  m_options.push_back (value.size ());
+  m_options.insert (m_options.end (), value.begin (), value.end ());
+  m_len += 2 + value.size ();
+}
+
+bool DhcpHeader::GetOption (uint8_t code, std::vector<uint8_t> &value) const
+{
+  uint32_t i = 0;
+  while (i + 1 < m_options.size ())
     {
-      m_opt[i] = false;
+      uint8_t len = m_options[i + 1];
+      if (m_options[i] == code)
+        {
+          value.assign (m_options.begin () + i + 2, m_options.begin () + i + 2 + len);
+          return true;
+        }
+      i += 2 + len;
     }
+  return false;
+}
+
+void DhcpHeader::AddOptions (const std::vector<uint8_t> &options)
+{
+  m_options.insert (m_options.end (), options.begin (), options.end ());
+  m_len += options.size ();
+}
+
+void DhcpHeader::SerializeOptions (std::vector<uint8_t> &options) const
+{
+  // the options are 241 bytes less than the header, minus the message type
+  uint32_t size = m_len - 241 - (HasOpt (OP_MSGTYPE) ? 3 : 0);
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator i = buffer.Begin ();
+  WriteOptions (i);
+  uint32_t offset = options.size ();
+  options.resize (offset + size);
+  buffer.CopyData (&options[offset], size);
+}
+
+void DhcpHeader::ResetOpt ()
+{
+  m_len = 241;
+  m_opt = 0;
+  m_options.clear ();
 }
 
 uint32_t DhcpHeader::GetSerializedSize (void) const
@@ -283,58 +410,69 @@ DhcpHeader::Serialize (Buffer::Iterator start) const
   if (m_hLen == 6)
     {
       WriteTo (i, m_chAddr48);
-      i.Write (m_hwpad,10);
+      i.WriteU8 (0, 10);
     }
   else
     {
       WriteTo (i,m_chAddr64);
+      i.WriteU8 (0, 8);
     }
-  i.Write (m_sname,64);
-  i.Write (m_file,128);
-  i.Write (m_magic_cookie,4);
-  if (m_opt[OP_MSGTYPE])
+  // sname and file are not used
+  i.WriteU8 (0, 192);
+  i.Write (MAGIC_COOKIE, 4);
+  if (HasOpt (OP_MSGTYPE))
     {
       i.WriteU8 (OP_MSGTYPE);
       i.WriteU8 (1);
       i.WriteU8 ((m_op + 1));
     }
-  if (m_opt[OP_ADDREQ])
+  WriteOptions (i);
+  i.WriteU8 (OP_END);
+}
+
+void
+DhcpHeader::WriteOptions (Buffer::Iterator &i) const
+{
+  if (HasOpt (OP_ADDREQ))
     {
       i.WriteU8 (OP_ADDREQ);
       i.WriteU8 (4);
       WriteTo (i, m_req);
     }
-  if (m_opt[OP_SERVID])
+  if (HasOpt (OP_SERVID))
     {
       i.WriteU8 (OP_SERVID);
       i.WriteU8 (4);
       WriteTo (i, m_dhcps);
     }
-  if (m_opt[OP_MASK])
+  if (HasOpt (OP_MASK))
     {
       i.WriteU8 (OP_MASK);
       i.WriteU8 (4);
       i.WriteHtonU32 (m_mask);
     }
-  if (m_opt[OP_LEASE])
+  if (HasOpt (OP_LEASE))
     {
       i.WriteU8 (OP_LEASE);
       i.WriteU8 (4);
       i.WriteHtonU32 (m_lease);
     }
-  if (m_opt[OP_RENEW])
+  if (HasOpt (OP_RENEW))
     {
       i.WriteU8 (OP_RENEW);
       i.WriteU8 (4);
       i.WriteHtonU32 (m_renew);
     }
-  if (m_opt[OP_REBIND])
+  if (HasOpt (OP_REBIND))
     {
       i.WriteU8 (OP_REBIND);
       i.WriteU8 (4);
       i.WriteHtonU32 (m_rebind);
     }
-  i.WriteU8 (OP_END);
+  if (!m_options.empty ())
+    {
+      i.Write (&m_options[0], m_options.size ());
+    }
 }
 
 uint32_t DhcpHeader::Deserialize (Buffer::Iterator start)
@@ -360,141 +498,117 @@ uint32_t DhcpHeader::Deserialize (Buffer::Iterator start)
   if (m_hLen == 6)
     {
       ReadFrom (i, m_chAddr48);
-      i.Read (m_hwpad, 10);
+      i.Next (10);
     }
   else
     {
       ReadFrom (i, m_chAddr64);
+      i.Next (8);
     }
-  i.Read (m_sname, 64);
-  i.Read (m_file,128);
-  i.Read (m_magic_cookie,4);
-  if ( m_magic_cookie[0] != 99 || m_magic_cookie[1] != 130 || m_magic_cookie[2] != 83 || m_magic_cookie[3] != 99)
+  // sname and file are only read if they are overloaded with options
+  Buffer::Iterator sname = i;
+  i.Next (64);
+  Buffer::Iterator file = i;
+  i.Next (128);
+  if (i.ReadU8 () != MAGIC_COOKIE[0] || i.ReadU8 () != MAGIC_COOKIE[1] || i.ReadU8 () != MAGIC_COOKIE[2] || i.ReadU8 () != MAGIC_COOKIE[3])
     {
       NS_LOG_WARN ("Malformed Packet");
       return 0;
     }
+  ResetOpt ();
+  m_overload = 0;
   len = 240;
-  uint8_t option;
-  bool loop = true;
-  do
+  bool end = false;
+  if (!DecodeOptions (i, clen - 240, len, end) || !end)
+    {
+      NS_LOG_WARN ("Malformed Packet");
+      return 0;
+    }
+  uint32_t unused;
+  bool unusedEnd;
+  if ((m_overload & 1) && !DecodeOptions (file, 128, unused, unusedEnd))
+    {
+      NS_LOG_WARN ("Malformed Packet");
+      return 0;
+    }
+  if ((m_overload & 2) && !DecodeOptions (sname, 64, unused, unusedEnd))
+    {
+      NS_LOG_WARN ("Malformed Packet");
+      return 0;
+    }
+  return len;
+}
+
+bool
+DhcpHeader::DecodeOptions (Buffer::Iterator &i, uint32_t size, uint32_t &len, bool &end)
+{
+  uint32_t read = 0;
+  end = false;
+  while (read < size)
     {
-      if (len + 1 <= clen)
+      uint8_t option = i.ReadU8 ();
+      read++;
+      if (option == OP_PAD)
+        {
+          continue;
+        }
+      if (option == OP_END)
         {
-          option = i.ReadU8 ();
-          len += 1;
+          end = true;
+          break;
+        }
+      if (read + 1 > size)
+        {
+          return false;
         }
-      else
+      uint8_t optLen = i.ReadU8 ();
+      read++;
+      if (read + optLen > size || !CheckOptionLength (option, optLen))
         {
-          NS_LOG_WARN ("Malformed Packet");
-          return 0;
+          return false;
         }
+      read += optLen;
       switch (option)
         {
         case OP_MASK:
-          if (len + 5 < clen)
-            {
-              i.ReadU8 ();
-              m_mask = i.ReadNtohU32 ();
-              len += 5;
-            }
-          else
-            {
-              NS_LOG_WARN ("Malformed Packet");
-              return 0;
-            }
+          m_mask = i.ReadNtohU32 ();
           break;
         case OP_MSGTYPE:
-          if (len + 2 < clen)
-            {
-              i.ReadU8 ();
-              m_op = (i.ReadU8 () - 1);
-              len += 2;
-            }
-          else
-            {
-              NS_LOG_WARN ("Malformed Packet");
-              return 0;
-            }
+          m_op = (i.ReadU8 () - 1);
           break;
         case OP_SERVID:
-          if (len + 5 < clen)
-            {
-              i.ReadU8 ();
-              ReadFrom (i, m_dhcps);
-              len += 5;
-            }
-          else
-            {
-              NS_LOG_WARN ("Malformed Packet");
-              return 0;
-            }
+          ReadFrom (i, m_dhcps);
           break;
         case OP_ADDREQ:
-          if (len + 5 < clen)
-            {
-              i.ReadU8 ();
-              ReadFrom (i, m_req);
-              len += 5;
-            }
-          else
-            {
-              NS_LOG_WARN ("Malformed Packet");
-              return 0;
-            }
+          ReadFrom (i, m_req);
           break;
         case OP_LEASE:
-          if (len + 5 < clen)
-            {
-              i.ReadU8 ();
-              m_lease = i.ReadNtohU32 ();
-              len += 5;
-            }
-          else
-            {
-              NS_LOG_WARN ("Malformed Packet");
-              return 0;
-            }
+          m_lease = i.ReadNtohU32 ();
           break;
         case OP_RENEW:
-          if (len + 5 < clen)
-            {
-              i.ReadU8 ();
-              m_renew = i.ReadNtohU32 ();
-              len += 5;
-            }
-          else
-            {
-              NS_LOG_WARN ("Malformed Packet");
-              return 0;
-            }
+          m_renew = i.ReadNtohU32 ();
           break;
         case OP_REBIND:
-          if (len + 5 < clen)
-            {
-              i.ReadU8 ();
-              m_rebind = i.ReadNtohU32 ();
-              len += 5;
-            }
-          else
-            {
-              NS_LOG_WARN ("Malformed Packet");
-              return 0;
-            }
-          break;
-        case OP_END:
-          loop = false;
+          m_rebind = i.ReadNtohU32 ();
           break;
+        case OP_OVERLOAD:
+          m_overload = i.ReadU8 ();
+          continue;
         default:
-          NS_LOG_WARN ("Malformed Packet");
-          return 0;
+          {
+            uint32_t offset = m_options.size ();
+            m_options.resize (offset + 2 + optLen);
+            m_options[offset] = option;
+            m_options[offset + 1] = optLen;
+            i.Read (&m_options[offset + 2], optLen);
+            m_len += 2 + optLen;
+          }
+          continue;
         }
+      AddOpt (option, 2 + optLen);
     }
-  while (loop);
-
-  m_len = len;
-  return m_len;
+  len += read;
+  return true;
 }
 
 } // namespace ns3
-
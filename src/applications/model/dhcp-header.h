@@ -27,6 +27,7 @@
 #include "ns3/header.h"
 #include <ns3/mac48-address.h>
 #include <ns3/mac64-address.h>
+#include <vector>
 
 namespace ns3 {
 /**
@@ -36,7 +37,11 @@ namespace ns3 {
  * \brief BOOTP header with DHCP messages supports the following options:
  *        Subnet Mask (1), Address Request (50), Refresh Lease Time (51),
  *        DHCP Message Type (53), DHCP Server ID (54), Renew Time (58),
- *        Rebind Time (59) and End (255) of BOOTP
+ *        Rebind Time (59) and End (255) of BOOTP. Any other option, e.g.
+ *        Router (3), DNS (6), Parameter Request List (55), Client ID (61)
+ *        or Rapid Commit (80), is carried as raw bytes, see SetOption and GetOption. Options
+ *        stored in the sname and file fields (Option Overload, 52) are
+ *        decoded as well.
 
   \verbatim
     0                   1                   2                   3
@@ -72,6 +77,8 @@ namespace ns3 {
    +---------------------------------------------------------------+
   \endverbatim
 
+ * The sname and file fields are not stored: they are written as zeros and
+ * skipped on reception. Only the options present are serialized.
  */
 class DhcpHeader : public Header
 {
@@ -94,13 +101,20 @@ public:
 
   enum options
   {
+    OP_PAD = 0,         //!< BOOTP Option 0: Pad
     OP_MASK = 1,        //!< BOOTP Option 1: Address Mask
+    OP_ROUTE = 3,       //!< BOOTP Option 3: Router
+    OP_DNS = 6,         //!< BOOTP Option 6: Domain Name Server
     OP_ADDREQ = 50,     //!< BOOTP Option 50: Requested Address
     OP_LEASE = 51,      //!< BOOTP Option 51: Address Lease Time
+    OP_OVERLOAD = 52,   //!< BOOTP Option 52: Option Overload
     OP_MSGTYPE = 53,    //!< BOOTP Option 53: DHCP Message Type
     OP_SERVID = 54,     //!< BOOTP Option 54: Server Identifier
+    OP_PARAMREQ = 55,   //!< BOOTP Option 55: Parameter Request List
     OP_RENEW = 58,      //!< BOOTP Option 58: Address Renewal Time
     OP_REBIND = 59,     //!< BOOTP Option 59: Address Rebind Time
+    OP_CLIENTID = 61,   //!< BOOTP Option 61: Client Identifier
+    OP_RAPIDCOMMIT = 80, //!< BOOTP Option 80: Rapid Commit (RFC 4039)
     OP_END = 255        //!< BOOTP Option 255: END
   };
 
@@ -159,7 +173,7 @@ public:
    * \brief Get the Mac48Address of the client
    * \return Mac48Address of the client
    */
-  Mac48Address GetChaddr48 (void);
+  Mac48Address GetChaddr48 (void) const;
 
   /**
    * \brief Set the Mac64Address of the device
@@ -171,7 +185,7 @@ public:
    * \brief Get the Mac64Address of the client
    * \return Mac64Address of the client
    */
-  Mac64Address GetChaddr64 (void);
+  Mac64Address GetChaddr64 (void) const;
 
   /**
    * \brief Set the IPv4Address of the client
@@ -185,6 +199,30 @@ public:
    */
   Ipv4Address GetYiaddr (void) const;
 
+  /**
+   * \brief Set the IPv4Address of the relay agent
+   * \param addr Ipv4Address of the relay agent
+   */
+  void SetGiaddr (Ipv4Address addr);
+
+  /**
+   * \brief Get the IPv4Address of the relay agent
+   * \return Ipv4Address of the relay agent, 0.0.0.0 if not relayed
+   */
+  Ipv4Address GetGiaddr (void) const;
+
+  /**
+   * \brief Set the number of relay agents the message went through
+   * \param hops The number of hops
+   */
+  void SetHops (uint8_t hops);
+
+  /**
+   * \brief Get the number of relay agents the message went through
+   * \return The number of hops
+   */
+  uint8_t GetHops (void) const;
+
   /**
    * \brief Set the DHCP server information
    * \param addr IPv4Address of the server
@@ -257,11 +295,51 @@ public:
    */
   uint32_t GetRebind (void) const;
 
+  /**
+   * \brief Set an option which has no dedicated accessor
+   * \param code The option code
+   * \param value The option value, at most 255 bytes
+   */
+  void SetOption (uint8_t code, const std::vector<uint8_t> &value);
+
+  /**
+   * \brief Get an option which has no dedicated accessor
+   * \param code The option code
+   * \param value The option value
+   * \return true if the option is present
+   */
+  bool GetOption (uint8_t code, std::vector<uint8_t> &value) const;
+
+  /**
+   * \brief Append already encoded options to the header
+   *
+   * This is meant for the options which are the same in many messages:
+   * they are encoded once, e.g. with SerializeOptions, and copied as they
+   * are into each message. The accessors of these options do not see them.
+   *
+   * \param options The encoded options, without End option
+   */
+  void AddOptions (const std::vector<uint8_t> &options);
+
+  /**
+   * \brief Encode the options of the header, except Message Type and End
+   * \param options The buffer the encoded options are appended to
+   */
+  void SerializeOptions (std::vector<uint8_t> &options) const;
+
   /**
    * \brief Reset the BOOTP options
    */
   void ResetOpt ();
 
+  /**
+   * \brief Check whether an option with a dedicated accessor is present
+   * \param option The option code
+   * \return true if the option is present, false for the options without
+   *         dedicated accessor
+   */
+  bool HasOpt (uint8_t option) const;
+
 private:
   virtual TypeId GetInstanceTypeId (void) const;
   virtual void Print (std::ostream &os) const;
@@ -269,6 +347,31 @@ private:
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
 
+  /**
+   * \brief Mark an option as present, accounting for its length once
+   * \param option The option code
+   * \param len The length of the option, including code and length fields
+   */
+  void AddOpt (uint8_t option, uint32_t len);
+
+  /**
+   * \brief Write the options, except Message Type and End
+   * \param i The iterator where the options are written
+   */
+  void WriteOptions (Buffer::Iterator &i) const;
+
+  /**
+   * \brief Decode the options of a field in a single pass
+   * \param i The iterator at the first option, moved past the options read
+   * \param size The size of the field
+   * \param len The number of bytes read
+   * \param end Set to true if the End option was found
+   * \return false if the options are malformed
+   */
+  bool DecodeOptions (Buffer::Iterator &i, uint32_t size, uint32_t &len, bool &end);
+
+  static const uint8_t MAGIC_COOKIE[4];  //!< DHCP Magic Cookie
+
   uint8_t m_op;                          //!< The DHCP Message type
   uint8_t m_bootp;                       //!< The BOOTP Message type
   uint8_t m_hType;                       //!< The hardware type
@@ -287,14 +390,12 @@ private:
   Ipv4Address m_giAddr;                  //!< Relay Agent IP address
   Ipv4Address m_dhcps;                   //!< DHCP server IP address
   Ipv4Address m_req;                     //!< Requested Address
-  uint8_t m_hwpad[10];                   //!< When entered address is 48 bit Mac Address, 10 bits padded
-  uint8_t m_sname[64];                   //!< Server name (Padded for now)
-  uint8_t m_file[128];                   //!< File name (Padded for now)
-  uint8_t m_magic_cookie[4];             //!< DHCP Magic Cookie
   uint32_t m_lease;                      //!< The lease time of the address
   uint32_t m_renew;                      //!< The renewal time for the client
   uint32_t m_rebind;                     //!< The rebinding time for the client
-  bool m_opt[255];                       //!< BOOTP option list
+  uint64_t m_opt;                        //!< BOOTP options present, one bit per option code
+  std::vector<uint8_t> m_options;        //!< Encoded options without dedicated accessor
+  uint8_t m_overload;                    //!< Option Overload value of a received header
 };
 
 } // namespace ns3
@@ -0,0 +1,527 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "dhcp-lease-table.h"
+
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DhcpLeaseTable");
+
+/**
+ * \brief Write an integer to a snapshot, in network byte order
+ * \param os The output stream
+ * \param value The value
+ * \param size The number of bytes to write
+ */
+static void
+WriteSnapshot (std::ostream &os, uint64_t value, uint32_t size)
+{
+  for (uint32_t i = size; i > 0; i--)
+    {
+      os.put (static_cast<char> ((value >> (8 * (i - 1))) & 0xff));
+    }
+}
+
+/**
+ * \brief Read an integer written by WriteSnapshot
+ * \param is The input stream
+ * \param size The number of bytes to read
+ * \return the value
+ */
+static uint64_t
+ReadSnapshot (std::istream &is, uint32_t size)
+{
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      value = (value << 8) | static_cast<uint8_t> (is.get ());
+    }
+  return value;
+}
+
+/**
+ * \brief Get the number of bytes left in a snapshot
+ * \param is The input stream
+ * \return the number of bytes until the end of the stream, or the largest
+ *         value if the stream cannot seek
+ */
+static uint64_t
+RemainingSnapshot (std::istream &is)
+{
+  std::streampos current = is.tellg ();
+  if (current == std::streampos (-1))
+    {
+      return std::numeric_limits<uint64_t>::max ();
+    }
+  is.seekg (0, std::ios::end);
+  std::streampos end = is.tellg ();
+  is.seekg (current);
+  if (end == std::streampos (-1) || !is)
+    {
+      return std::numeric_limits<uint64_t>::max ();
+    }
+  return end - current;
+}
+
+/// Size of a binding in a snapshot: offset, chaddr, expiry and leased flag
+static const uint32_t SNAPSHOT_BINDING_SIZE = 4 + 6 + 8 + 1;
+
+size_t
+DhcpLeaseTable::Mac48AddressHash::operator() (const Mac48Address &addr) const
+{
+  uint8_t buf[6];
+  addr.CopyTo (buf);
+  size_t hash = 0;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      hash = hash * 31 + buf[i];
+    }
+  return hash;
+}
+
+DhcpLeaseTable::DhcpLeaseTable ()
+  : m_firstFree (0),
+    m_share (0),
+    m_nShares (1),
+    m_nLeased (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DhcpLeaseTable::~DhcpLeaseTable ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DhcpLeaseTable::Initialize (uint32_t size, uint32_t firstFree)
+{
+  NS_LOG_FUNCTION (this << size << firstFree);
+  Clear ();
+  Lease lease;
+  lease.bound = false;
+  lease.leased = false;
+  lease.queued = false;
+  m_leases.resize (size, lease);
+  m_firstFree = firstFree;
+  for (uint32_t offset = firstFree; offset < size; offset++)
+    {
+      PushFree (offset);
+    }
+}
+
+void
+DhcpLeaseTable::SetShare (uint32_t share, uint32_t nShares)
+{
+  NS_LOG_FUNCTION (this << share << nShares);
+  NS_ASSERT (share < nShares);
+  m_share = share;
+  m_nShares = nShares;
+  m_free.clear ();
+  for (uint32_t offset = 0; offset < m_leases.size (); offset++)
+    {
+      m_leases[offset].queued = false;
+    }
+  // the previously used addresses go after the never used ones, as they
+  // would have in the free list
+  for (uint32_t offset = m_firstFree; offset < m_leases.size (); offset++)
+    {
+      if (!m_leases[offset].bound)
+        {
+          PushFree (offset);
+        }
+    }
+  for (uint32_t offset = m_firstFree; offset < m_leases.size (); offset++)
+    {
+      if (m_leases[offset].bound && !m_leases[offset].leased)
+        {
+          PushFree (offset);
+        }
+    }
+}
+
+void
+DhcpLeaseTable::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_leases.clear ();
+  m_macIndex.clear ();
+  m_free.clear ();
+  m_expiries = ExpiryHeap ();
+  m_nLeased = 0;
+}
+
+uint32_t
+DhcpLeaseTable::GetSize (void) const
+{
+  return m_leases.size ();
+}
+
+uint32_t
+DhcpLeaseTable::GetNLeased (void) const
+{
+  return m_nLeased;
+}
+
+bool
+DhcpLeaseTable::LookupByMac (Mac48Address chaddr, uint32_t &offset) const
+{
+  MacIndex::const_iterator it = m_macIndex.find (chaddr);
+  if (it == m_macIndex.end ())
+    {
+      return false;
+    }
+  offset = it->second;
+  return true;
+}
+
+bool
+DhcpLeaseTable::IsBound (uint32_t offset) const
+{
+  return offset < m_leases.size () && m_leases[offset].bound;
+}
+
+bool
+DhcpLeaseTable::IsLeased (uint32_t offset) const
+{
+  return IsBound (offset) && m_leases[offset].leased;
+}
+
+Mac48Address
+DhcpLeaseTable::GetClient (uint32_t offset) const
+{
+  NS_ASSERT (IsBound (offset));
+  return m_leases[offset].chaddr;
+}
+
+Mac48Address
+DhcpLeaseTable::GetLastClient (uint32_t offset) const
+{
+  NS_ASSERT (offset < m_leases.size ());
+  // Release keeps the address of the client in the record
+  return m_leases[offset].chaddr;
+}
+
+bool
+DhcpLeaseTable::IsInShare (uint32_t offset) const
+{
+  return offset % m_nShares == m_share;
+}
+
+Time
+DhcpLeaseTable::GetExpiry (uint32_t offset) const
+{
+  NS_ASSERT (IsBound (offset));
+  return m_leases[offset].expiry;
+}
+
+bool
+DhcpLeaseTable::AllocateFree (uint32_t &offset)
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_free.empty ())
+    {
+      uint32_t candidate = m_free.front ();
+      m_free.pop_front ();
+      m_leases[candidate].queued = false;
+      // skip the addresses which were leased again since they were queued
+      if (!IsLeased (candidate))
+        {
+          offset = candidate;
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+DhcpLeaseTable::Bind (Mac48Address chaddr, uint32_t offset, Time expiry)
+{
+  NS_LOG_FUNCTION (this << chaddr << offset << expiry);
+  NS_ASSERT (offset < m_leases.size ());
+
+  uint32_t previous;
+  if (LookupByMac (chaddr, previous) && previous != offset)
+    {
+      Release (previous);
+    }
+  Lease &entry = m_leases[offset];
+  if (entry.bound)
+    {
+      if (entry.leased)
+        {
+          m_nLeased--;
+        }
+      if (entry.chaddr != chaddr)
+        {
+          m_macIndex.erase (entry.chaddr);
+        }
+    }
+  entry.chaddr = chaddr;
+  entry.bound = true;
+  entry.leased = false;
+  m_macIndex[chaddr] = offset;
+  StartLease (offset, expiry);
+}
+
+void
+DhcpLeaseTable::Extend (uint32_t offset, Time lease)
+{
+  NS_LOG_FUNCTION (this << offset << lease);
+  NS_ASSERT (IsBound (offset));
+  Lease &entry = m_leases[offset];
+  if (!entry.leased)
+    {
+      StartLease (offset, Simulator::Now () + lease);
+    }
+  else if (entry.expiry != Time::Max ())
+    {
+      StartLease (offset, (Time::Max () - entry.expiry > lease) ? entry.expiry + lease : Time::Max ());
+    }
+}
+
+void
+DhcpLeaseTable::Release (uint32_t offset)
+{
+  NS_LOG_FUNCTION (this << offset);
+  if (!IsBound (offset))
+    {
+      return;
+    }
+  Lease &entry = m_leases[offset];
+  if (entry.leased)
+    {
+      m_nLeased--;
+    }
+  m_macIndex.erase (entry.chaddr);
+  entry.bound = false;
+  entry.leased = false;
+  PushFree (offset);
+}
+
+bool
+DhcpLeaseTable::GetNextExpiry (Time &expiry)
+{
+  PurgeExpiries ();
+  if (m_expiries.empty ())
+    {
+      return false;
+    }
+  expiry = m_expiries.top ().first;
+  return true;
+}
+
+uint32_t
+DhcpLeaseTable::Expire (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+  uint32_t expired = 0;
+  PurgeExpiries ();
+  while (!m_expiries.empty () && m_expiries.top ().first <= now)
+    {
+      uint32_t offset = m_expiries.top ().second;
+      m_expiries.pop ();
+      NS_LOG_INFO ("Lease of offset " << offset << " expired");
+      m_leases[offset].leased = false;
+      m_nLeased--;
+      PushFree (offset);
+      expired++;
+      PurgeExpiries ();
+    }
+  return expired;
+}
+
+void
+DhcpLeaseTable::Serialize (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nBound = 0;
+  for (std::vector<Lease>::const_iterator it = m_leases.begin (); it != m_leases.end (); it++)
+    {
+      if (it->bound)
+        {
+          nBound++;
+        }
+    }
+  WriteSnapshot (os, m_leases.size (), 4);
+  WriteSnapshot (os, m_firstFree, 4);
+  WriteSnapshot (os, nBound, 4);
+  for (uint32_t offset = 0; offset < m_leases.size (); offset++)
+    {
+      const Lease &entry = m_leases[offset];
+      if (!entry.bound)
+        {
+          continue;
+        }
+      uint8_t mac[6];
+      entry.chaddr.CopyTo (mac);
+      WriteSnapshot (os, offset, 4);
+      os.write (reinterpret_cast<const char *> (mac), 6);
+      WriteSnapshot (os, entry.expiry.GetTimeStep (), 8);
+      os.put (entry.leased ? 1 : 0);
+    }
+  WriteSnapshot (os, m_free.size (), 4);
+  for (std::deque<uint32_t>::const_iterator it = m_free.begin (); it != m_free.end (); it++)
+    {
+      WriteSnapshot (os, *it, 4);
+    }
+}
+
+bool
+DhcpLeaseTable::Deserialize (std::istream &is, Time shift, uint32_t poolSize)
+{
+  NS_LOG_FUNCTION (this << shift << poolSize);
+  Clear ();
+  uint32_t size = ReadSnapshot (is, 4);
+  uint32_t firstFree = ReadSnapshot (is, 4);
+  uint32_t nBound = ReadSnapshot (is, 4);
+  // check the counts before allocating anything, so that a corrupt or
+  // truncated snapshot is rejected rather than sizing a huge table
+  if (!is || size != poolSize || firstFree > size || nBound > size
+      || RemainingSnapshot (is) < uint64_t (nBound) * SNAPSHOT_BINDING_SIZE + 4)
+    {
+      NS_LOG_WARN ("Invalid lease table snapshot");
+      return false;
+    }
+  Lease lease;
+  lease.bound = false;
+  lease.leased = false;
+  lease.queued = false;
+  m_leases.resize (size, lease);
+  m_firstFree = firstFree;
+  for (uint32_t i = 0; i < nBound; i++)
+    {
+      uint32_t offset = ReadSnapshot (is, 4);
+      uint8_t mac[6];
+      is.read (reinterpret_cast<char *> (mac), 6);
+      Time expiry = TimeStep (ReadSnapshot (is, 8));
+      bool leased = is.get () != 0;
+      if (!is || offset >= size)
+        {
+          Clear ();
+          return false;
+        }
+      Lease &entry = m_leases[offset];
+      entry.chaddr.CopyFrom (mac);
+      entry.bound = true;
+      m_macIndex[entry.chaddr] = offset;
+      if (expiry != Time::Max ())
+        {
+          expiry += shift;
+        }
+      if (leased)
+        {
+          StartLease (offset, expiry);
+        }
+      else
+        {
+          entry.expiry = expiry;
+        }
+    }
+  uint32_t nFree = ReadSnapshot (is, 4);
+  if (!is || nFree > size || RemainingSnapshot (is) < uint64_t (nFree) * 4)
+    {
+      NS_LOG_WARN ("Invalid lease table snapshot");
+      Clear ();
+      return false;
+    }
+  for (uint32_t i = 0; i < nFree && is; i++)
+    {
+      uint32_t offset = ReadSnapshot (is, 4);
+      if (offset < size)
+        {
+          PushFree (offset);
+        }
+    }
+  if (!is)
+    {
+      Clear ();
+      return false;
+    }
+  return true;
+}
+
+bool
+DhcpLeaseTable::SkipSnapshot (std::istream &is)
+{
+  NS_LOG_FUNCTION (&is);
+  uint32_t size = ReadSnapshot (is, 4);
+  ReadSnapshot (is, 4);
+  uint32_t nBound = ReadSnapshot (is, 4);
+  if (!is || nBound > size)
+    {
+      return false;
+    }
+  is.ignore (uint64_t (nBound) * SNAPSHOT_BINDING_SIZE);
+  uint32_t nFree = ReadSnapshot (is, 4);
+  if (!is || nFree > size)
+    {
+      return false;
+    }
+  is.ignore (uint64_t (nFree) * 4);
+  return is.good ();
+}
+
+void
+DhcpLeaseTable::StartLease (uint32_t offset, Time expiry)
+{
+  Lease &entry = m_leases[offset];
+  if (!entry.leased)
+    {
+      m_nLeased++;
+    }
+  entry.leased = true;
+  entry.expiry = expiry;
+  if (expiry != Time::Max ())
+    {
+      m_expiries.push (std::make_pair (expiry, offset));
+    }
+}
+
+void
+DhcpLeaseTable::PurgeExpiries (void)
+{
+  while (!m_expiries.empty ())
+    {
+      const Expiry &top = m_expiries.top ();
+      const Lease &entry = m_leases[top.second];
+      if (entry.bound && entry.leased && entry.expiry == top.first)
+        {
+          break;
+        }
+      m_expiries.pop ();
+    }
+}
+
+void
+DhcpLeaseTable::PushFree (uint32_t offset)
+{
+  if (offset < m_firstFree || offset % m_nShares != m_share || m_leases[offset].queued)
+    {
+      return;
+    }
+  m_leases[offset].queued = true;
+  m_free.push_back (offset);
+}
+
+} // namespace ns3
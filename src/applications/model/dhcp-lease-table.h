@@ -0,0 +1,312 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DHCP_LEASE_TABLE_H
+#define DHCP_LEASE_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <functional>
+#include <iostream>
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/sgi-hashmap.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup dhcp
+ *
+ * \class DhcpLeaseTable
+ * \brief The lease database of a DHCP server
+ *
+ * Each address of the pool is identified by its offset from the first
+ * address of the pool. The table keeps one record per offset, an index
+ * from the client Mac48Address to its offset and a FIFO list of the free
+ * offsets, so that looking up a client, looking up an address and
+ * allocating a new address are all done in (amortized) constant time,
+ * whatever the size of the pool.
+ *
+ * Every lease carries its absolute expiry time, and the pending expiries
+ * are kept in a min-heap, so that the owner of the table only has to act
+ * when the earliest lease actually expires (see GetNextExpiry and Expire).
+ * Renewing a lease only pushes its new expiry on the heap; the outdated
+ * entry is discarded when it reaches the top.
+ *
+ * An expired lease frees its address for another client, but the binding
+ * with the client is remembered until that happens, so that a returning
+ * client gets back its previous address if possible. Expired addresses are
+ * appended to the end of the free list, hence the least recently used
+ * addresses are handed out first.
+ *
+ * A pool can be shared by several servers (see SetShare): each one then
+ * allocates only its own share of the free addresses, so that they never
+ * hand out the same address, while the bindings made by the others are
+ * still recorded in every table.
+ *
+ * The table can be written to a compact binary snapshot and read back,
+ * bindings, expiries and free list order included (see Serialize and
+ * Deserialize).
+ */
+class DhcpLeaseTable
+{
+public:
+
+  DhcpLeaseTable ();
+  ~DhcpLeaseTable ();
+
+  /**
+   * \brief Reset the table for a pool of addresses
+   * \param size The number of addresses in the pool
+   * \param firstFree The first offset that can be allocated by AllocateFree
+   */
+  void Initialize (uint32_t size, uint32_t firstFree);
+
+  /**
+   * \brief Restrict the addresses allocated by AllocateFree to a share of the pool
+   *
+   * The offsets allocated are those equal to share modulo nShares. The
+   * free list is rebuilt, so that the table can take over the addresses of
+   * the other shares (nShares set to 1) or give them back.
+   *
+   * \param share The share of this table, less than nShares
+   * \param nShares The number of shares of the pool
+   */
+  void SetShare (uint32_t share, uint32_t nShares);
+
+  /**
+   * \brief Remove all the leases of the table
+   */
+  void Clear (void);
+
+  /**
+   * \brief Get the number of addresses of the pool
+   * \return the size of the pool
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \brief Get the number of addresses currently leased
+   * \return the number of addresses with a lease that did not expire
+   */
+  uint32_t GetNLeased (void) const;
+
+  /**
+   * \brief Find the offset bound to a client
+   * \param chaddr The Mac48Address of the client
+   * \param offset The offset of the address bound to the client
+   * \return true if the client is bound to an address
+   */
+  bool LookupByMac (Mac48Address chaddr, uint32_t &offset) const;
+
+  /**
+   * \brief Check whether an address is bound to a client
+   * \param offset The offset of the address
+   * \return true if the address is bound, even if its lease expired
+   */
+  bool IsBound (uint32_t offset) const;
+
+  /**
+   * \brief Check whether an address is leased
+   * \param offset The offset of the address
+   * \return true if the address is bound and its lease did not expire
+   */
+  bool IsLeased (uint32_t offset) const;
+
+  /**
+   * \brief Get the client bound to an address
+   * \param offset The offset of the address, which must be bound
+   * \return the Mac48Address of the client
+   */
+  Mac48Address GetClient (uint32_t offset) const;
+
+  /**
+   * \brief Get the client an address is bound to, or was last bound to
+   * \param offset The offset of the address
+   * \return the Mac48Address of the client, 00:00:00:00:00:00 if the
+   *         address was never bound
+   */
+  Mac48Address GetLastClient (uint32_t offset) const;
+
+  /**
+   * \brief Check whether an address is in the share of the pool of this table
+   * \param offset The offset of the address
+   * \return true if the address may be allocated by this table
+   */
+  bool IsInShare (uint32_t offset) const;
+
+  /**
+   * \brief Get the expiry time of the lease of an address
+   * \param offset The offset of the address, which must be bound
+   * \return the absolute expiry time, Time::Max () for an infinite lease
+   */
+  Time GetExpiry (uint32_t offset) const;
+
+  /**
+   * \brief Take the least recently used free address
+   * \param offset The offset of the allocated address
+   * \return true if a free address was found
+   */
+  bool AllocateFree (uint32_t &offset);
+
+  /**
+   * \brief Bind an address to a client
+   *
+   * Any previous binding of the client or of the address is dropped.
+   *
+   * \param chaddr The Mac48Address of the client
+   * \param offset The offset of the address
+   * \param expiry The absolute expiry time of the lease, Time::Max () for
+   *        a lease which never expires
+   */
+  void Bind (Mac48Address chaddr, uint32_t offset, Time expiry);
+
+  /**
+   * \brief Extend the lease of a bound address
+   *
+   * The lease time is added to the current expiry time; a lease which
+   * already expired is restarted from now.
+   *
+   * \param offset The offset of the address, which must be bound
+   * \param lease The lease time to be added
+   */
+  void Extend (uint32_t offset, Time lease);
+
+  /**
+   * \brief Remove the binding of an address and return it to the free list
+   * \param offset The offset of the address
+   */
+  void Release (uint32_t offset);
+
+  /**
+   * \brief Get the earliest expiry time among the running leases
+   * \param expiry The earliest expiry time
+   * \return true if at least one lease can expire
+   */
+  bool GetNextExpiry (Time &expiry);
+
+  /**
+   * \brief Expire the leases whose expiry time is not later than now
+   *
+   * Addresses whose lease expires are returned to the free list.
+   *
+   * \param now The current time
+   * \return the number of leases which expired
+   */
+  uint32_t Expire (Time now);
+
+  /**
+   * \brief Write the table to a binary snapshot
+   *
+   * Only the bound addresses and the free list are written, so the size of
+   * the snapshot depends on the number of clients rather than on the size
+   * of the pool.
+   *
+   * \param os The output stream
+   */
+  void Serialize (std::ostream &os) const;
+
+  /**
+   * \brief Replace the content of the table with a snapshot
+   *
+   * The expiry times are shifted by the given time, so that a snapshot
+   * taken in a previous simulation can be loaded at another simulation
+   * time. Leases which never expire are not shifted.
+   *
+   * The snapshot is checked before the table is resized: a snapshot of a
+   * pool of another size, or whose counts do not fit in the rest of the
+   * stream, is rejected and leaves the table empty.
+   *
+   * \param is The input stream, positioned at the start of a snapshot
+   *        written by Serialize
+   * \param shift The time added to the expiry times
+   * \param poolSize The number of addresses of the pool
+   * \return false if the snapshot could not be read
+   */
+  bool Deserialize (std::istream &is, Time shift, uint32_t poolSize);
+
+  /**
+   * \brief Skip a snapshot without loading it
+   * \param is The input stream, positioned at the start of a snapshot
+   *        written by Serialize
+   * \return false if the snapshot could not be read
+   */
+  static bool SkipSnapshot (std::istream &is);
+
+private:
+  /**
+   * \brief Lease record of an address of the pool
+   */
+  struct Lease
+  {
+    Mac48Address chaddr;   //!< Client to which the address is bound
+    Time expiry;           //!< Absolute expiry time of the lease
+    bool bound;            //!< True if the address is bound to a client
+    bool leased;           //!< True if the lease did not expire
+    bool queued;           //!< True if the offset is in the free list
+  };
+
+  /**
+   * \brief Hash function for Mac48Address
+   */
+  struct Mac48AddressHash
+  {
+    /**
+     * \param addr The Mac48Address to hash
+     * \return the hash of the address
+     */
+    size_t operator() (const Mac48Address &addr) const;
+  };
+
+  /**
+   * \brief Append an offset to the free list, unless it is already there
+   * \param offset The offset of the address
+   */
+  void PushFree (uint32_t offset);
+
+  /**
+   * \brief Start the lease of a bound address
+   * \param offset The offset of the address
+   * \param expiry The absolute expiry time of the lease
+   */
+  void StartLease (uint32_t offset, Time expiry);
+
+  /**
+   * \brief Remove the heap entries which no longer match a running lease
+   */
+  void PurgeExpiries (void);
+
+  typedef sgi::hash_map<Mac48Address, uint32_t, Mac48AddressHash> MacIndex; //!< Client to offset index
+  typedef std::pair<Time, uint32_t> Expiry;                                  //!< Expiry time and offset of a lease
+  typedef std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry> > ExpiryHeap; //!< Min-heap of expiries
+
+  std::vector<Lease> m_leases;       //!< Lease records, indexed by offset
+  MacIndex m_macIndex;               //!< Offset bound to each client
+  std::deque<uint32_t> m_free;       //!< Free offsets, least recently used first
+  ExpiryHeap m_expiries;             //!< Pending expiries, possibly outdated
+  uint32_t m_firstFree;              //!< First offset that can be allocated
+  uint32_t m_share;                  //!< Share of the pool allocated by this table
+  uint32_t m_nShares;                //!< Number of shares of the pool
+  uint32_t m_nLeased;                //!< Number of addresses with a running lease
+};
+
+} // namespace ns3
+
+#endif /* DHCP_LEASE_TABLE_H */
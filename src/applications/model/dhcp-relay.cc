@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/socket-factory.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv4-packet-info-tag.h"
+#include "dhcp-relay.h"
+#include "dhcp-header.h"
+#include <ns3/ipv4.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DhcpRelay");
+NS_OBJECT_ENSURE_REGISTERED (DhcpRelay);
+
+TypeId
+DhcpRelay::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DhcpRelay")
+    .SetParent<Application> ()
+    .AddConstructor<DhcpRelay> ()
+    .AddAttribute ("MaxHops",
+                   "Requests which went through more relay agents are dropped.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&DhcpRelay::m_maxHops),
+                   MakeUintegerChecker<uint32_t> (0, 16))
+  ;
+  return tid;
+}
+
+DhcpRelay::DhcpRelay ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DhcpRelay::~DhcpRelay ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DhcpRelay::AddServer (Ipv4Address server)
+{
+  NS_LOG_FUNCTION (this << server);
+  m_servers.push_back (server);
+}
+
+void
+DhcpRelay::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+  m_clientSockets.clear ();
+  Application::DoDispose ();
+}
+
+void DhcpRelay::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_servers.empty (), "No DHCP server to relay to");
+  if (m_socket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      InetSocketAddress local = InetSocketAddress (Ipv4Address::GetAny (), PORT);
+      m_socket->SetAllowBroadcast (true);
+      m_socket->SetRecvPktInfo (true);
+      m_socket->Bind (local);
+    }
+  m_socket->SetRecvCallback (MakeCallback (&DhcpRelay::NetHandler, this));
+}
+
+void DhcpRelay::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_socket != 0)
+    {
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+}
+
+Ptr<Socket> DhcpRelay::GetClientSocket (uint32_t ifIndex)
+{
+  std::map<uint32_t, Ptr<Socket> >::iterator it = m_clientSockets.find (ifIndex);
+  if (it != m_clientSockets.end ())
+    {
+      return it->second;
+    }
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  Ptr<Socket> socket = Socket::CreateSocket (GetNode (), tid);
+  socket->SetAllowBroadcast (true);
+  socket->Bind ();
+  socket->BindToNetDevice (GetNode ()->GetObject<Ipv4> ()->GetNetDevice (ifIndex));
+  m_clientSockets[ifIndex] = socket;
+  return socket;
+}
+
+void DhcpRelay::NetHandler (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  DhcpHeader header;
+  Address from;
+  Ptr<Packet> packet = m_socket->RecvFrom (from);
+  Ipv4PacketInfoTag tag;
+  int32_t ifIndex = -1;
+  if (packet->RemovePacketTag (tag))
+    {
+      Ptr<Ipv4> ipv4 = GetNode ()->GetObject<Ipv4> ();
+      ifIndex = ipv4->GetInterfaceForDevice (GetNode ()->GetDevice (tag.GetRecvIf ()));
+    }
+  // the packet is sent again by this node
+  packet->RemoveAllPacketTags ();
+  packet->RemoveAllByteTags ();
+  if (packet->RemoveHeader (header) == 0)
+    {
+      return;
+    }
+  switch (header.GetType ())
+    {
+    case DhcpHeader::DHCPDISCOVER:
+    case DhcpHeader::DHCPREQ:
+      ForwardRequest (header, packet, ifIndex);
+      break;
+    case DhcpHeader::DHCPOFFER:
+    case DhcpHeader::DHCPACK:
+    case DhcpHeader::DHCPNACK:
+      ForwardReply (header, packet);
+      break;
+    default:
+      break;
+    }
+}
+
+void DhcpRelay::ForwardRequest (DhcpHeader header, Ptr<Packet> packet, int32_t ifIndex)
+{
+  NS_LOG_FUNCTION (this << ifIndex);
+  if (header.GetHops () >= m_maxHops)
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Too many hops, request dropped");
+      return;
+    }
+  if (header.GetGiaddr () == Ipv4Address::GetAny ())
+    {
+      if (ifIndex < 0)
+        {
+          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Unknown receiving interface, request dropped");
+          return;
+        }
+      header.SetGiaddr (GetNode ()->GetObject<Ipv4> ()->GetAddress (ifIndex, 0).GetLocal ());
+    }
+  header.SetHops (header.GetHops () + 1);
+  packet->AddHeader (header);
+
+  // the same packet is forwarded to every server
+  for (std::vector<Ipv4Address>::const_iterator it = m_servers.begin (); it != m_servers.end (); it++)
+    {
+      if ((m_socket->SendTo (packet->Copy (), 0, InetSocketAddress (*it, PORT))) >= 0)
+        {
+          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Trace TX: DHCP request relayed to " << *it);
+        }
+      else
+        {
+          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Error while relaying DHCP request to " << *it);
+        }
+    }
+}
+
+void DhcpRelay::ForwardReply (const DhcpHeader &header, Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this);
+  int32_t ifIndex = GetNode ()->GetObject<Ipv4> ()->GetInterfaceForAddress (header.GetGiaddr ());
+  if (ifIndex < 0)
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Reply for another relay agent dropped");
+      return;
+    }
+  packet->AddHeader (header);
+  if ((GetClientSocket (ifIndex)->SendTo (packet, 0, InetSocketAddress (Ipv4Address ("255.255.255.255"), CLIENT_PORT))) >= 0)
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Trace TX: DHCP reply relayed on interface " << ifIndex);
+    }
+  else
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Error while relaying DHCP reply on interface " << ifIndex);
+    }
+}
+
+} // Namespace ns3
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DHCP_RELAY_H
+#define DHCP_RELAY_H
+
+#include "ns3/application.h"
+#include "ns3/ptr.h"
+#include "ns3/ipv4-address.h"
+#include "dhcp-header.h"
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup dhcp
+ *
+ * \class DhcpRelay
+ * \brief Implements the functionality of a DHCP relay agent (RFC 1542)
+ *
+ * The relay listens on port 67 of all the interfaces of its node. A
+ * request from a client is stamped with the address of the interface it
+ * was received on (giaddr), so that the servers can choose the pool of
+ * that subnet, and is forwarded by unicast to every configured server. A
+ * reply from a server is broadcast on the interface whose address is the
+ * giaddr of the reply. A single server can thus serve many subnets, each
+ * one with a relay on its router.
+ */
+class DhcpRelay : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor
+   */
+  DhcpRelay ();
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~DhcpRelay ();
+
+  /**
+   * \brief Add a DHCP server the requests are forwarded to
+   * \param server Ipv4Address of the DHCP server
+   */
+  void AddServer (Ipv4Address server);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  static const int PORT = 67;                       //!< Port number of DHCP server and relay
+  static const int CLIENT_PORT = 68;                //!< Port number of DHCP client
+
+  /*
+   * \brief Handles incoming packets from the network
+   * \param socket Socket bound to port 67 of the relay
+   */
+  void NetHandler (Ptr<Socket> socket);
+
+  /*
+   * \brief Forwards a request of a client to the servers
+   * \param header DHCP header of the received message
+   * \param packet The received packet, without DHCP header
+   * \param ifIndex Interface on which the request was received
+   */
+  void ForwardRequest (DhcpHeader header, Ptr<Packet> packet, int32_t ifIndex);
+
+  /*
+   * \brief Forwards a reply of a server to the client
+   * \param header DHCP header of the received message
+   * \param packet The received packet, without DHCP header
+   */
+  void ForwardReply (const DhcpHeader &header, Ptr<Packet> packet);
+
+  /*
+   * \brief Gets the socket used to broadcast replies on an interface
+   * \param ifIndex The interface
+   * \return the socket bound to the device of the interface
+   */
+  Ptr<Socket> GetClientSocket (uint32_t ifIndex);
+
+  /*
+   * \brief Starts the DHCP relay application
+   */
+  virtual void StartApplication (void);
+
+  /*
+   * \brief Stops the DHCP relay application
+   */
+  virtual void StopApplication (void);
+
+  Ptr<Socket> m_socket;                  //!< The socket bound to port 67
+  std::map<uint32_t, Ptr<Socket> > m_clientSockets; //!< Sockets broadcasting replies, by interface
+  std::vector<Ipv4Address> m_servers;    //!< Addresses of the DHCP servers
+  uint32_t m_maxHops;                    //!< Requests which went through more relays are dropped
+};
+
+} // namespace ns3
+
+#endif /* DHCP_RELAY_H */
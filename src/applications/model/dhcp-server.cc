@@ -32,10 +32,16 @@
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/buffer.h"
+#include "ns3/address-utils.h"
+#include "ns3/ipv4-packet-info-tag.h"
 #include "dhcp-server.h"
 #include "dhcp-header.h"
 #include <ns3/ipv4.h>
-#include <map>
+#include <algorithm>
+#include <fstream>
 
 namespace ns3 {
 
@@ -88,14 +94,60 @@ DhcpServer::GetTypeId (void)
                    Ipv4AddressValue (),
                    MakeIpv4AddressAccessor (&DhcpServer::m_server),
                    MakeIpv4AddressChecker ())
+    .AddAttribute ("Gateway",
+                   "Default router advertised to the clients, not advertised if 0.0.0.0.",
+                   Ipv4AddressValue (Ipv4Address::GetAny ()),
+                   MakeIpv4AddressAccessor (&DhcpServer::m_gateway),
+                   MakeIpv4AddressChecker ())
+    .AddAttribute ("LeaseFile",
+                   "File the leases are saved to when the server stops and loaded from when it starts, none if empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&DhcpServer::m_leaseFile),
+                   MakeStringChecker ())
+    .AddAttribute ("RapidCommit",
+                   "Answer a DISCOVER with the Rapid Commit option by an ACK (RFC 4039).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DhcpServer::m_rapidCommit),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FailoverPeer",
+                   "Address of the other server of a failover pair, no failover if 0.0.0.0.",
+                   Ipv4AddressValue (Ipv4Address::GetAny ()),
+                   MakeIpv4AddressAccessor (&DhcpServer::m_failoverPeer),
+                   MakeIpv4AddressChecker ())
+    .AddAttribute ("FailoverPrimary",
+                   "This server is the primary of the failover pair.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DhcpServer::m_failoverPrimary),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FailoverPort",
+                   "Port of the failover messages.",
+                   UintegerValue (647),
+                   MakeUintegerAccessor (&DhcpServer::m_failoverPort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("UpdateInterval",
+                   "Delay during which the binding updates are batched before being sent to the failover peer.",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&DhcpServer::m_updateInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxUpdateBatch",
+                   "Maximum number of binding updates in a failover message.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&DhcpServer::m_maxUpdateBatch),
+                   MakeUintegerChecker<uint32_t> (1, 80))
+    .AddAttribute ("PeerTimeout",
+                   "Silence of the failover peer after which it is considered down.",
+                   TimeValue (Seconds (3)),
+                   MakeTimeAccessor (&DhcpServer::m_peerTimeout),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
 
 DhcpServer::DhcpServer ()
+  : m_resync (false),
+    m_partnerDown (false)
 {
   NS_LOG_FUNCTION (this);
-  m_nextAddressSeq = 1;
 }
 
 DhcpServer::~DhcpServer ()
@@ -107,46 +159,199 @@ void
 DhcpServer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_pools.clear ();
+  m_prefixIndex.clear ();
+  m_failoverSocket = 0;
   Application::DoDispose ();
 }
 
-void DhcpServer::StartApplication (void)
+void
+DhcpServer::AddPool (Ipv4Address poolAddress, Ipv4Mask poolMask, Ipv4Address minAddress,
+                     Ipv4Address maxAddress, Ipv4Address gateway)
+{
+  NS_LOG_FUNCTION (this << poolAddress << poolMask << minAddress << maxAddress << gateway);
+  NS_ASSERT_MSG (minAddress < maxAddress,"Invalid Address range");
+  NS_ASSERT_MSG (poolMask.IsMatch (minAddress, poolAddress) && poolMask.IsMatch (maxAddress, poolAddress),
+                 "Address range out of the pool subnet");
+  NS_ASSERT_MSG (m_socket == 0, "Pools must be added before the server starts");
+  Pool pool;
+  pool.poolAddress = poolAddress.CombineMask (poolMask);
+  pool.poolMask = poolMask;
+  pool.minAddress = minAddress;
+  pool.maxAddress = maxAddress;
+  pool.gateway = gateway;
+  m_pools.push_back (pool);
+}
+
+uint32_t
+DhcpServer::GetNPools (void) const
+{
+  return m_pools.size ();
+}
+
+/// Orders the levels of the prefix index by decreasing mask length
+static bool
+LongerMask (const std::pair<uint32_t, sgi::hash_map<uint32_t, uint32_t> > &a,
+            const std::pair<uint32_t, sgi::hash_map<uint32_t, uint32_t> > &b)
+{
+  return a.first > b.first;
+}
+
+void DhcpServer::IndexPools (void)
 {
   NS_LOG_FUNCTION (this);
+  m_prefixIndex.clear ();
+  for (uint32_t i = 0; i < m_pools.size (); i++)
+    {
+      uint32_t mask = m_pools[i].poolMask.Get ();
+      std::vector<PrefixLevel>::iterator level;
+      for (level = m_prefixIndex.begin (); level != m_prefixIndex.end (); level++)
+        {
+          if (level->first == mask)
+            {
+              break;
+            }
+        }
+      if (level == m_prefixIndex.end ())
+        {
+          m_prefixIndex.push_back (PrefixLevel (mask, PrefixMap ()));
+          level = m_prefixIndex.end () - 1;
+        }
+      bool inserted = level->second.insert (std::make_pair (m_pools[i].poolAddress.Get (), i)).second;
+      NS_ASSERT_MSG (inserted, "Two pools for the subnet " << m_pools[i].poolAddress << m_pools[i].poolMask);
+    }
+  // a contiguous mask is longer if its value is larger
+  std::sort (m_prefixIndex.begin (), m_prefixIndex.end (), LongerMask);
+}
 
-  NS_ASSERT_MSG (m_minAddress < m_maxAddress,"Invalid Address range");
-  m_occurange = 0;
-  if (m_socket == 0)
+int32_t DhcpServer::FindPool (Ipv4Address address) const
+{
+  for (std::vector<PrefixLevel>::const_iterator level = m_prefixIndex.begin (); level != m_prefixIndex.end (); level++)
     {
-      uint32_t addrIndex;
-      int32_t ifIndex;
+      PrefixMap::const_iterator it = level->second.find (address.Get () & level->first);
+      if (it != level->second.end ())
+        {
+          return it->second;
+        }
+    }
+  return -1;
+}
 
-      //add the DHCP local address to the leased addresses list, if it is defined!
+int32_t DhcpServer::FindInterfacePool (Ptr<Packet> packet) const
+{
+  Ipv4PacketInfoTag tag;
+  if (packet->RemovePacketTag (tag))
+    {
       Ptr<Ipv4> ipv4 = GetNode ()->GetObject<Ipv4> ();
-      ifIndex = ipv4->GetInterfaceForPrefix (m_poolAddress, m_poolMask);
+      int32_t ifIndex = ipv4->GetInterfaceForDevice (GetNode ()->GetDevice (tag.GetRecvIf ()));
       if (ifIndex >= 0)
         {
-          for (addrIndex = 0; addrIndex < ipv4->GetNAddresses (ifIndex); addrIndex++)
+          for (uint32_t addrIndex = 0; addrIndex < ipv4->GetNAddresses (ifIndex); addrIndex++)
             {
-              if ((ipv4->GetAddress (ifIndex, addrIndex).GetLocal ().Get () & m_poolMask.Get ()) == m_poolAddress.Get () && ipv4->GetAddress (ifIndex, addrIndex).GetLocal ().Get () >= m_minAddress.Get () && ipv4->GetAddress (ifIndex, addrIndex).GetLocal ().Get () <= m_maxAddress.Get ())
+              int32_t index = FindPool (ipv4->GetAddress (ifIndex, addrIndex).GetLocal ());
+              if (index >= 0)
                 {
-                  uint32_t id = ipv4->GetAddress (ifIndex, addrIndex).GetLocal ().Get () - m_minAddress.Get ();
-                  m_occurange++;
-                  m_leasedAddresses.insert (std::make_pair (std::make_pair (Mac48Address::ConvertFrom (GetNode ()->GetDevice (ifIndex)->GetAddress ()), id), 0xffffffff)); // set infinite GRANTED_LEASED_TIME for my address
-                  break;
+                  return index;
                 }
             }
         }
+    }
+  // a server with a single pool serves every directly attached client
+  return m_pools.size () == 1 ? 0 : -1;
+}
+
+void DhcpServer::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_socket == 0)
+    {
+      // the pool given by the attributes, if any, is the first one
+      if (m_minAddress != m_maxAddress)
+        {
+          AddPool (m_poolAddress, m_poolMask, m_minAddress, m_maxAddress, m_gateway);
+          std::rotate (m_pools.begin (), m_pools.end () - 1, m_pools.end ());
+        }
+      IndexPools ();
 
       TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
       m_socket = Socket::CreateSocket (GetNode (), tid);
       InetSocketAddress local = InetSocketAddress (Ipv4Address::GetAny (), PORT);
       m_socket->SetAllowBroadcast (true);
+      m_socket->SetRecvPktInfo (true);
       m_socket->Bind (local);
+
+      if (m_failoverPeer != Ipv4Address::GetAny ())
+        {
+          m_failoverSocket = Socket::CreateSocket (GetNode (), tid);
+          m_failoverSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_failoverPort));
+        }
+    }
+  NS_ASSERT_MSG (!m_pools.empty (), "No address pool");
+
+  InitializeLeases ();
+  if (!m_leaseFile.empty () && !LoadLeases (m_leaseFile))
+    {
+      NS_LOG_WARN ("[node " << GetNode ()->GetId () << "]  " << "Could not load the leases from " << m_leaseFile);
+      InitializeLeases ();
+    }
+  m_partnerDown = false;
+  UpdateShares ();
+
+  for (std::vector<Pool>::iterator pool = m_pools.begin (); pool != m_pools.end (); pool++)
+    {
+      // encode once the options which are the same in every offer
+      DhcpHeader offerTemplate;
+      offerTemplate.SetDhcps (m_server);
+      offerTemplate.SetMask (pool->poolMask.Get ());
+      offerTemplate.SetLease (m_lease.GetSeconds ());
+      offerTemplate.SetRenew (m_renew.GetSeconds ());
+      offerTemplate.SetRebind (m_rebind.GetSeconds ());
+      if (pool->gateway != Ipv4Address::GetAny ())
+        {
+          std::vector<uint8_t> router (4);
+          pool->gateway.Serialize (&router[0]);
+          offerTemplate.SetOption (DhcpHeader::OP_ROUTE, router);
+        }
+      pool->offerOptions.clear ();
+      offerTemplate.SerializeOptions (pool->offerOptions);
+    }
+
+  //add the DHCP local addresses to the leased addresses lists
+  Ptr<Ipv4> ipv4 = GetNode ()->GetObject<Ipv4> ();
+  for (uint32_t ifIndex = 0; ifIndex < ipv4->GetNInterfaces (); ifIndex++)
+    {
+      for (uint32_t addrIndex = 0; addrIndex < ipv4->GetNAddresses (ifIndex); addrIndex++)
+        {
+          uint32_t local = ipv4->GetAddress (ifIndex, addrIndex).GetLocal ().Get ();
+          int32_t index = FindPool (Ipv4Address (local));
+          if (index >= 0 && local >= m_pools[index].minAddress.Get () && local <= m_pools[index].maxAddress.Get ())
+            {
+              Pool &pool = m_pools[index];
+              uint32_t id = local - pool.minAddress.Get ();
+              pool.leases.Bind (Mac48Address::ConvertFrom (ipv4->GetNetDevice (ifIndex)->GetAddress ()), id, Time::Max ()); // set infinite GRANTED_LEASED_TIME for my address
+              QueueUpdate (pool, id);
+            }
+        }
+    }
+
+  // the loaded leases may have expired while the server was stopped
+  for (std::vector<Pool>::iterator pool = m_pools.begin (); pool != m_pools.end (); pool++)
+    {
+      pool->leases.Expire (Simulator::Now ());
+      ScheduleExpiry (*pool);
     }
 
   m_socket->SetRecvCallback (MakeCallback (&DhcpServer::NetHandler, this));
-  m_expiredEvent = Simulator::Schedule (Seconds (1), &DhcpServer::TimerHandler, this);
+
+  if (m_failoverSocket != 0)
+    {
+      m_failoverSocket->SetRecvCallback (MakeCallback (&DhcpServer::FailoverHandler, this));
+      // the peer is given PeerTimeout to show up
+      m_peerLastSeen = Simulator::Now ();
+      m_resync = true;
+      Heartbeat ();
+    }
 }
 
 void DhcpServer::StopApplication ()
@@ -157,33 +362,365 @@ void DhcpServer::StopApplication ()
     {
       m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
     }
+  if (m_failoverSocket != 0)
+    {
+      m_failoverSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+  Simulator::Remove (m_flushEvent);
+  Simulator::Remove (m_heartbeatEvent);
+  m_updates.clear ();
+
+  if (!m_leaseFile.empty () && !SaveLeases (m_leaseFile))
+    {
+      NS_LOG_WARN ("[node " << GetNode ()->GetId () << "]  " << "Could not save the leases to " << m_leaseFile);
+    }
+
+  for (std::vector<Pool>::iterator pool = m_pools.begin (); pool != m_pools.end (); pool++)
+    {
+      pool->leases.Clear ();
+      Simulator::Remove (pool->expiredEvent);
+    }
+}
+
+void DhcpServer::InitializeLeases (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Pool>::iterator pool = m_pools.begin (); pool != m_pools.end (); pool++)
+    {
+      // the first address of the range is never allocated
+      pool->leases.Initialize (pool->maxAddress.Get () - pool->minAddress.Get () + 1, 1);
+    }
+}
+
+bool DhcpServer::SaveLeases (std::string filename) const
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ofstream os (filename.c_str (), std::ios::binary | std::ios::trunc);
+  if (!os)
+    {
+      return false;
+    }
+  Buffer buffer;
+  buffer.AddAtStart (16);
+  Buffer::Iterator i = buffer.Begin ();
+  i.WriteHtonU32 (SNAPSHOT_MAGIC);
+  i.WriteHtonU64 (Simulator::Now ().GetTimeStep ());
+  i.WriteHtonU32 (m_pools.size ());
+  buffer.CopyData (&os, buffer.GetSize ());
+  for (std::vector<Pool>::const_iterator pool = m_pools.begin (); pool != m_pools.end (); pool++)
+    {
+      uint8_t range[16];
+      pool->poolAddress.Serialize (range);
+      Ipv4Address (pool->poolMask.Get ()).Serialize (range + 4);
+      pool->minAddress.Serialize (range + 8);
+      pool->maxAddress.Serialize (range + 12);
+      os.write (reinterpret_cast<const char *> (range), 16);
+      pool->leases.Serialize (os);
+    }
+  return os.good ();
+}
+
+bool DhcpServer::LoadLeases (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream is (filename.c_str (), std::ios::binary);
+  uint8_t header[16];
+  if (!is.read (reinterpret_cast<char *> (header), 16))
+    {
+      return false;
+    }
+  Buffer buffer;
+  buffer.AddAtStart (16);
+  buffer.Begin ().Write (header, 16);
+  Buffer::Iterator i = buffer.Begin ();
+  if (i.ReadNtohU32 () != SNAPSHOT_MAGIC)
+    {
+      return false;
+    }
+  Time snapshot = TimeStep (i.ReadNtohU64 ());
+  uint32_t nPools = i.ReadNtohU32 ();
+  Time shift = (Simulator::Now () < snapshot) ? Simulator::Now () - snapshot : Seconds (0);
+
+  for (uint32_t n = 0; n < nPools; n++)
+    {
+      uint8_t range[16];
+      if (!is.read (reinterpret_cast<char *> (range), 16))
+        {
+          return false;
+        }
+      Ipv4Address poolAddress = Ipv4Address::Deserialize (range);
+      Ipv4Mask poolMask (Ipv4Address::Deserialize (range + 4).Get ());
+      Ipv4Address minAddress = Ipv4Address::Deserialize (range + 8);
+      Ipv4Address maxAddress = Ipv4Address::Deserialize (range + 12);
+      int32_t index = FindPool (poolAddress);
+      if (index >= 0 && m_pools[index].poolMask == poolMask
+          && m_pools[index].minAddress == minAddress && m_pools[index].maxAddress == maxAddress)
+        {
+          if (!m_pools[index].leases.Deserialize (is, shift, m_pools[index].leases.GetSize ()))
+            {
+              return false;
+            }
+          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << m_pools[index].leases.GetNLeased () << " leases loaded in pool " << poolAddress);
+        }
+      else
+        {
+          if (!DhcpLeaseTable::SkipSnapshot (is))
+            {
+              return false;
+            }
+          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Leases of unknown pool " << poolAddress << poolMask << " skipped");
+        }
+    }
+  return true;
+}
 
-  m_leasedAddresses.clear ();
-  Simulator::Remove (m_expiredEvent);
+void DhcpServer::TimerHandler (uint32_t index)
+{
+  // Release the addresses whose lease expired
+  Pool &pool = m_pools[index];
+  uint32_t expired = pool.leases.Expire (Simulator::Now ());
+  if (expired > 0)
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << expired << " address leased state expired in pool " << pool.poolAddress);
+    }
+  ScheduleExpiry (pool);
 }
 
-void DhcpServer::TimerHandler ()
+void DhcpServer::ScheduleExpiry (Pool &pool)
 {
-  // Set up timeout events and release of unsolicited addresses from the list
-  uint32_t a = 1;
-  std::map<std::pair<Mac48Address, uint32_t>, uint32_t>::iterator i;
-  for (i = m_leasedAddresses.begin (); i != m_leasedAddresses.end (); i++, a++)
+  Time expiry;
+  if (!pool.leases.GetNextExpiry (expiry))
+    {
+      return;
+    }
+  if (pool.expiredEvent.IsRunning ())
     {
-      // update the address state
-      if (i->second == 1)
+      if (TimeStep (pool.expiredEvent.GetTs ()) <= expiry)
+        {
+          return;
+        }
+      Simulator::Remove (pool.expiredEvent);
+    }
+  pool.expiredEvent = Simulator::Schedule (expiry - Simulator::Now (), &DhcpServer::TimerHandler, this, &pool - &m_pools[0]);
+}
+
+/**
+ * \brief Hash bucket of a client in a failover pair (RFC 3074)
+ * \param chaddr The hardware address of the client
+ * \return the bucket, from 0 to 255
+ */
+static uint8_t
+ClientBucket (Mac48Address chaddr)
+{
+  uint8_t buf[6];
+  chaddr.CopyTo (buf);
+  // FNV-1a, folded to 8 bits
+  uint32_t hash = 2166136261U;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      hash = (hash ^ buf[i]) * 16777619U;
+    }
+  return (hash ^ (hash >> 8) ^ (hash >> 16) ^ (hash >> 24)) & 0xff;
+}
+
+bool DhcpServer::IsOwnClient (Mac48Address chaddr) const
+{
+  if (m_failoverSocket == 0 || m_partnerDown)
+    {
+      return true;
+    }
+  // the primary serves the lower half of the buckets
+  return (ClientBucket (chaddr) < 128) == m_failoverPrimary;
+}
+
+void DhcpServer::UpdateShares (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Pool>::iterator pool = m_pools.begin (); pool != m_pools.end (); pool++)
+    {
+      if (m_failoverSocket == 0 || m_partnerDown)
+        {
+          pool->leases.SetShare (0, 1);
+        }
+      else
+        {
+          pool->leases.SetShare (m_failoverPrimary ? 0 : 1, 2);
+        }
+    }
+}
+
+void DhcpServer::QueueUpdate (const Pool &pool, uint32_t offset)
+{
+  if (m_failoverSocket == 0)
+    {
+      return;
+    }
+  m_updates.insert (std::make_pair (&pool - &m_pools[0], offset));
+  if (!m_flushEvent.IsRunning ())
+    {
+      m_flushEvent = Simulator::Schedule (m_updateInterval, &DhcpServer::FlushUpdates, this);
+    }
+}
+
+void DhcpServer::QueueAllUpdates (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Pool>::const_iterator pool = m_pools.begin (); pool != m_pools.end (); pool++)
+    {
+      for (uint32_t offset = 0; offset < pool->leases.GetSize (); offset++)
+        {
+          if (pool->leases.IsBound (offset))
+            {
+              QueueUpdate (*pool, offset);
+            }
+        }
+    }
+}
+
+void DhcpServer::FlushUpdates (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Remove (m_flushEvent);
+  do
+    {
+      uint32_t nUpdates = std::min<uint32_t> (m_updates.size (), m_maxUpdateBatch);
+      std::vector<std::pair<uint32_t, uint32_t> > sent;
+      sent.reserve (nUpdates);
+      Buffer buffer;
+      buffer.AddAtStart (FAILOVER_HEADER_SIZE + nUpdates * FAILOVER_UPDATE_SIZE);
+      Buffer::Iterator i = buffer.Begin ();
+      i.WriteHtonU32 (FAILOVER_MAGIC);
+      i.WriteU8 (m_resync ? FAILOVER_RESYNC : 0);
+      i.WriteHtonU16 (nUpdates);
+      for (uint32_t n = 0; n < nUpdates; n++)
+        {
+          // the bindings are read when sent, so that an address bound several
+          // times within the interval is sent once, with its last binding
+          const Pool &pool = m_pools[m_updates.begin ()->first];
+          uint32_t offset = m_updates.begin ()->second;
+          sent.push_back (*m_updates.begin ());
+          m_updates.erase (m_updates.begin ());
+          // a released address is sent with its last client, which the peer
+          // checks before releasing it too
+          Mac48Address chaddr = pool.leases.GetLastClient (offset);
+          Time expiry = Simulator::Now ();
+          if (pool.leases.IsBound (offset))
+            {
+              expiry = pool.leases.GetExpiry (offset);
+            }
+          i.WriteHtonU32 (pool.minAddress.Get () + offset);
+          WriteTo (i, chaddr);
+          i.WriteHtonU64 (expiry.GetTimeStep ());
+        }
+      Ptr<Packet> packet = Create<Packet> (buffer.PeekData (), buffer.GetSize ());
+      if (m_failoverSocket->SendTo (packet, 0, InetSocketAddress (m_failoverPeer, m_failoverPort)) >= 0)
+        {
+          m_resync = false;
+          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Trace TX: " << nUpdates << " binding updates to failover peer");
+        }
+      else
+        {
+          // keep the updates for the next flush, so that the peer does not
+          // miss them
+          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Error while sending binding updates to failover peer");
+          m_updates.insert (sent.begin (), sent.end ());
+          m_flushEvent = Simulator::Schedule (m_updateInterval, &DhcpServer::FlushUpdates, this);
+          break;
+        }
+    }
+  while (!m_updates.empty ());
+}
+
+void DhcpServer::Heartbeat (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_partnerDown && Simulator::Now () - m_peerLastSeen >= m_peerTimeout)
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Failover peer " << m_failoverPeer << " down, serving all the clients");
+      m_partnerDown = true;
+      UpdateShares ();
+    }
+  FlushUpdates ();
+  m_heartbeatEvent = Simulator::Schedule (m_peerTimeout / 3, &DhcpServer::Heartbeat, this);
+}
+
+void DhcpServer::FailoverHandler (Ptr<Socket> socket)
+{
+  Address from;
+  Ptr<Packet> packet;
+  while ((packet = m_failoverSocket->RecvFrom (from)))
+    {
+      if (InetSocketAddress::ConvertFrom (from).GetIpv4 () != m_failoverPeer
+          || packet->GetSize () < FAILOVER_HEADER_SIZE)
+        {
+          continue;
+        }
+      std::vector<uint8_t> data (packet->GetSize ());
+      packet->CopyData (&data[0], data.size ());
+      Buffer buffer;
+      buffer.AddAtStart (data.size ());
+      buffer.Begin ().Write (&data[0], data.size ());
+      Buffer::Iterator i = buffer.Begin ();
+      if (i.ReadNtohU32 () != FAILOVER_MAGIC)
+        {
+          continue;
+        }
+      uint8_t flags = i.ReadU8 ();
+      uint32_t nUpdates = i.ReadNtohU16 ();
+      if (packet->GetSize () < FAILOVER_HEADER_SIZE + nUpdates * FAILOVER_UPDATE_SIZE)
         {
-          i->second = 0;
-          m_occurange--;
-          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Address removed!" << a);
-          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Address leased state expired!");
           continue;
         }
-      if (i->second != 0xffffffff || i->second != 0)
+
+      m_peerLastSeen = Simulator::Now ();
+      if (m_partnerDown)
+        {
+          // the peer missed the bindings made meanwhile
+          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Failover peer " << m_failoverPeer << " back");
+          m_partnerDown = false;
+          UpdateShares ();
+          QueueAllUpdates ();
+        }
+      else if (flags & FAILOVER_RESYNC)
         {
-          i->second--;
+          QueueAllUpdates ();
         }
+
+      for (uint32_t n = 0; n < nUpdates; n++)
+        {
+          Ipv4Address address (i.ReadNtohU32 ());
+          Mac48Address chaddr;
+          ReadFrom (i, chaddr);
+          Time expiry = TimeStep (i.ReadNtohU64 ());
+          int32_t index = FindPool (address);
+          if (index < 0 || address.Get () < m_pools[index].minAddress.Get () || address.Get () > m_pools[index].maxAddress.Get ())
+            {
+              continue;
+            }
+          Pool &pool = m_pools[index];
+          uint32_t offset = address.Get () - pool.minAddress.Get ();
+          if (expiry > Simulator::Now ())
+            {
+              pool.leases.Bind (chaddr, offset, expiry);
+              ScheduleExpiry (pool);
+            }
+          else if (pool.leases.IsBound (offset) && pool.leases.GetClient (offset) == chaddr)
+            {
+              pool.leases.Release (offset);
+            }
+        }
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Trace RX: " << nUpdates << " binding updates from failover peer");
     }
-  m_expiredEvent = Simulator::Schedule (Seconds (1), &DhcpServer::TimerHandler, this);
+}
+
+int DhcpServer::SendReply (Ptr<Packet> packet, Ipv4Address giaddr, Ipv4Address to, uint16_t port)
+{
+  if (giaddr != Ipv4Address::GetAny ())
+    {
+      // the relay agent is listening on the server port
+      return m_socket->SendTo (packet, 0, InetSocketAddress (giaddr, PORT));
+    }
+  return m_socket->SendTo (packet, 0, InetSocketAddress (to, port));
 }
 
 void DhcpServer::NetHandler (Ptr<Socket> socket)
@@ -196,108 +733,102 @@ void DhcpServer::NetHandler (Ptr<Socket> socket)
     {
       return;
     }
+  int32_t index;
+  if (header.GetGiaddr () != Ipv4Address::GetAny ())
+    {
+      index = FindPool (header.GetGiaddr ());
+    }
+  else
+    {
+      index = FindInterfacePool (packet);
+    }
+  if (index < 0)
+    {
+      // from a subnet which is not served by any pool
+      return;
+    }
+  Pool &pool = m_pools[index];
+  // a renewing client, which sends its request from its own address, is
+  // answered by the server it asks, whatever its hash bucket
+  if ((header.GetType () == DhcpHeader::DHCPDISCOVER || header.GetType () == DhcpHeader::DHCPREQ)
+      && (InetSocketAddress::ConvertFrom (from).GetIpv4 () == Ipv4Address::GetAny ()
+          || InetSocketAddress::ConvertFrom (from).GetIpv4 () != header.GetReq ())
+      && !IsOwnClient (header.GetChaddr48 ()))
+    {
+      NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Client " << header.GetChaddr48 () << " left to the failover peer");
+      return;
+    }
   if (header.GetType () == DhcpHeader::DHCPDISCOVER)
     {
-      SendOffer (header,from);
+      SendOffer (pool, header, from);
     }
-  if (header.GetType () == DhcpHeader::DHCPREQ && (header.GetReq ()).Get () >= m_minAddress.Get () && (header.GetReq ()).Get () <= m_maxAddress.Get ())
+  if (header.GetType () == DhcpHeader::DHCPREQ && (header.GetReq ()).Get () >= pool.minAddress.Get () && (header.GetReq ()).Get () <= pool.maxAddress.Get ())
     {
-      SendAck (header,from);
+      SendAck (pool, header, from);
     }
 }
 
-void DhcpServer::SendOffer (DhcpHeader header, Address from)
+void DhcpServer::SendOffer (Pool &pool, const DhcpHeader &header, Address from)
 {
   DhcpHeader new_header;
   Ipv4Address address;
   Mac48Address source;
   uint32_t tran;
   uint32_t addr;
+  uint32_t found_addr = 0;
   Ptr<Packet> packet = 0;
   source = header.GetChaddr48 ();
   NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Trace RX: DHCP DISCOVER from: " << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " source port: " <<  InetSocketAddress::ConvertFrom (from).GetPort ());
   tran = header.GetTran ();
-  bool found = false;
-  uint32_t found_addr;
-  std::map<std::pair<Mac48Address, uint32_t>, uint32_t>::iterator i;
-  for (i = m_leasedAddresses.begin (); i != m_leasedAddresses.end (); i++)
-    {
-      if (i->first.first == source)
-        {
-          found_addr = i->first.second;
-          found = true;
-          m_leasedAddresses.erase (i--);
-          break;
-        }
-    }
+  bool found = pool.leases.LookupByMac (source, found_addr);
   if (!found)
     {
-      if ((header.GetReq ()).Get () >= m_minAddress.Get () && (header.GetReq ()).Get () <= m_maxAddress.Get ())
+      if ((header.GetReq ()).Get () >= pool.minAddress.Get () && (header.GetReq ()).Get () <= pool.maxAddress.Get ())
         {
-          for (i = m_leasedAddresses.begin (); i != m_leasedAddresses.end (); i++)
-            {
-              if (i->first.second == (header.GetReq ()).Get () - m_minAddress.Get ())
-                {
-                  break;
-                }
-            }
-          if (i == m_leasedAddresses.end ())
+          // the failover peer may offer the addresses of its own share
+          uint32_t req = (header.GetReq ()).Get () - pool.minAddress.Get ();
+          if (!pool.leases.IsBound (req) && pool.leases.IsInShare (req))
             {
-              found_addr = (header.GetReq ()).Get () - m_minAddress.Get ();
+              found_addr = req;
               found = true;
             }
         }
     }
-  if (found == false)
+  if (!found)
     {
-      // find a new address to be leased
-      if (m_occurange <= m_maxAddress.Get () - m_minAddress.Get ())
-        {
-          for (i = m_leasedAddresses.begin (); i != m_leasedAddresses.end (); i++)
-            {
-              // check whether the address is occupied
-              if (i->first.second == m_nextAddressSeq && i->second != 0)
-                {
-                  m_nextAddressSeq = m_nextAddressSeq % (m_maxAddress.Get () - m_minAddress.Get ()) + 1;
-                  i = m_leasedAddresses.begin ();
-                }
-              if (i->first.second == m_nextAddressSeq && i->second == 0)
-                {
-                  m_leasedAddresses.erase (i--);
-                }
-            }
-          if (i == m_leasedAddresses.end ())
-            {
-              found_addr = m_nextAddressSeq;
-              m_nextAddressSeq = m_nextAddressSeq % (m_maxAddress.Get () - m_minAddress.Get ()) + 1;
-              found = true;
-            }
-        }
+      // take the least recently used address which is not leased
+      found = pool.leases.AllocateFree (found_addr);
     }
   if (found)
     {
-      addr = m_minAddress.Get () + found_addr;
-      m_occurange++;
-      m_leasedAddresses.insert (std::make_pair (std::make_pair (source, found_addr), m_lease.GetSeconds ()));
+      addr = pool.minAddress.Get () + found_addr;
+      pool.leases.Bind (source, found_addr, Simulator::Now () + m_lease);
+      ScheduleExpiry (pool);
+      QueueUpdate (pool, found_addr);
       address.Set (addr);
 
+      // with rapid commit the offered address is leased at once
+      std::vector<uint8_t> rapidCommit;
+      bool rapid = m_rapidCommit && header.GetOption (DhcpHeader::OP_RAPIDCOMMIT, rapidCommit);
+
       packet = Create<Packet> ();
       new_header.ResetOpt ();
-      new_header.SetType (DhcpHeader::DHCPOFFER);
+      new_header.SetType (rapid ? DhcpHeader::DHCPACK : DhcpHeader::DHCPOFFER);
       new_header.SetChaddr48 (source);
       new_header.SetYiaddr (address);
-      new_header.SetDhcps (m_server);
-      new_header.SetMask (m_poolMask.Get ());
+      new_header.SetGiaddr (header.GetGiaddr ());
       new_header.SetTran (tran);
-      new_header.SetLease (m_lease.GetSeconds ());
-      new_header.SetRenew (m_renew.GetSeconds ());
-      new_header.SetRebind (m_rebind.GetSeconds ());
+      new_header.AddOptions (pool.offerOptions);
+      if (rapid)
+        {
+          new_header.SetOption (DhcpHeader::OP_RAPIDCOMMIT, rapidCommit);
+        }
       new_header.SetTime ();
       packet->AddHeader (new_header);
 
-      if ((m_socket->SendTo (packet, 0, InetSocketAddress (Ipv4Address ("255.255.255.255"), InetSocketAddress::ConvertFrom (from).GetPort ()))) >= 0)
+      if (SendReply (packet, header.GetGiaddr (), Ipv4Address ("255.255.255.255"), InetSocketAddress::ConvertFrom (from).GetPort ()) >= 0)
         {
-          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Trace TX: DHCP OFFER");
+          NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "Trace TX: " << (rapid ? "DHCP ACK (rapid commit)" : "DHCP OFFER"));
         }
       else
         {
@@ -306,7 +837,7 @@ void DhcpServer::SendOffer (DhcpHeader header, Address from)
     }
 }
 
-void DhcpServer::SendAck (DhcpHeader header, Address from)
+void DhcpServer::SendAck (Pool &pool, const DhcpHeader &header, Address from)
 {
   DhcpHeader new_header;
   Mac48Address source;
@@ -322,52 +853,41 @@ void DhcpServer::SendAck (DhcpHeader header, Address from)
 
   source = header.GetChaddr48 ();
   tran = header.GetTran ();
-  std::map<std::pair<Mac48Address, uint32_t>, uint32_t>::iterator i;
-  for (i = m_leasedAddresses.begin (); i != m_leasedAddresses.end (); i++)
+  uint32_t offset = addr - pool.minAddress.Get ();
+  // the address must be bound to this client, e.g. a client in INIT-REBOOT
+  // state may ask for an address which was given to another one since
+  if (pool.leases.IsBound (offset) && pool.leases.GetClient (offset) == source)
     {
       // update the lease time of this address
-      if ((m_minAddress.Get () + i->first.second) == addr)
-        {
-          (i->second) += m_lease.GetSeconds ();
-          packet = Create<Packet> ();
-          new_header.ResetOpt ();
-          new_header.SetType (DhcpHeader::DHCPACK);
-          new_header.SetChaddr48 (source);
-          new_header.SetYiaddr (address);
-          new_header.SetTran (tran);
-          new_header.SetTime ();
-          packet->AddHeader (new_header);
-          m_peer = InetSocketAddress::ConvertFrom (from).GetIpv4 ();
-          if (m_peer != address)
-            {
-              m_socket->SendTo (packet, 0, InetSocketAddress (Ipv4Address ("255.255.255.255"), InetSocketAddress::ConvertFrom (from).GetPort ()));
-            }
-          else
-            {
-              m_socket->SendTo (packet, 0, InetSocketAddress (m_peer, InetSocketAddress::ConvertFrom (from).GetPort ()));
-            }
-          break;
-        }
+      pool.leases.Extend (offset, m_lease);
+      ScheduleExpiry (pool);
+      QueueUpdate (pool, offset);
+      packet = Create<Packet> ();
+      new_header.ResetOpt ();
+      new_header.SetType (DhcpHeader::DHCPACK);
+      new_header.SetChaddr48 (source);
+      new_header.SetYiaddr (address);
+      new_header.SetGiaddr (header.GetGiaddr ());
+      new_header.SetTran (tran);
+      new_header.AddOptions (pool.offerOptions);
+      new_header.SetTime ();
+      packet->AddHeader (new_header);
+      m_peer = InetSocketAddress::ConvertFrom (from).GetIpv4 ();
+      SendReply (packet, header.GetGiaddr (), (m_peer != address) ? Ipv4Address ("255.255.255.255") : m_peer, InetSocketAddress::ConvertFrom (from).GetPort ());
     }
-  if (i == m_leasedAddresses.end ())
+  else
     {
       packet = Create<Packet> ();
       new_header.ResetOpt ();
       new_header.SetType (DhcpHeader::DHCPNACK);
       new_header.SetChaddr48 (source);
       new_header.SetYiaddr (address);
+      new_header.SetGiaddr (header.GetGiaddr ());
       new_header.SetTran (tran);
       new_header.SetTime ();
       packet->AddHeader (new_header);
       m_peer = InetSocketAddress::ConvertFrom (from).GetIpv4 ();
-      if (m_peer != address)
-        {
-          m_socket->SendTo (packet, 0, InetSocketAddress (Ipv4Address ("255.255.255.255"), InetSocketAddress::ConvertFrom (from).GetPort ()));
-        }
-      else
-        {
-          m_socket->SendTo (packet, 0, InetSocketAddress (m_peer, InetSocketAddress::ConvertFrom (from).GetPort ()));
-        }
+      SendReply (packet, header.GetGiaddr (), (m_peer != address) ? Ipv4Address ("255.255.255.255") : m_peer, InetSocketAddress::ConvertFrom (from).GetPort ());
       NS_LOG_INFO ("[node " << GetNode ()->GetId () << "]  " << "This IP addr does not exists or released!");
     }
 }
@@ -30,7 +30,11 @@
 #include "ns3/address.h"
 #include <ns3/traced-value.h>
 #include "dhcp-header.h"
-#include <map>
+#include "dhcp-lease-table.h"
+#include "ns3/sgi-hashmap.h"
+#include <vector>
+#include <string>
+#include <set>
 
 namespace ns3 {
 
@@ -42,6 +46,38 @@ class Packet;
  *
  * \class DhcpServer
  * \brief Implements the functionality of a DHCP server
+ *
+ * The server holds one or more address pools: the one given by its
+ * attributes, if any, and the ones added with AddPool. The pool of a
+ * relayed request is the one whose subnet contains the giaddr of the
+ * request; the pool of a request from a directly attached client is the
+ * one whose subnet contains an address of the receiving interface. The
+ * pools are indexed by prefix, so that selecting the pool costs a few hash
+ * lookups (one per distinct pool mask) whatever the number of pools.
+ *
+ * If the RapidCommit attribute is set, a DISCOVER with the Rapid Commit
+ * option (RFC 4039) is answered directly with an ACK.
+ *
+ * If the LeaseFile attribute is set, the leases of all the pools are saved
+ * to that file when the server stops, and loaded back when it starts, so
+ * that the clients keep their leases across a restart of the server.
+ *
+ * Two servers with the same pools can run as a failover pair, each one
+ * having the other as FailoverPeer and only one of them being
+ * FailoverPrimary. The clients are split between the servers by a hash of
+ * their hardware address (RFC 3074), a server ignoring the DISCOVER and
+ * REQUEST of the clients of its peer, and each server allocates only half
+ * of the addresses of a pool (even offsets for the primary, odd ones for
+ * the secondary), so that they never offer the same address. Every
+ * binding made by a server is sent to its peer as an incremental update,
+ * the updates made within UpdateInterval being batched in one message; a
+ * message without update is sent as heartbeat when there is nothing to
+ * replicate. A server which does not hear from its peer for PeerTimeout
+ * goes to partner-down state and serves all the clients from the whole
+ * pools, until the peer is back. A (re)started server asks its peer for
+ * all its bindings. This is a simplified model of the ISC failover
+ * protocol: there is no lease time negotiation (MCLT) and no conflict
+ * resolution beyond "the last update wins".
  */
 class DhcpServer : public Application
 {
@@ -62,11 +98,102 @@ public:
    */
   virtual ~DhcpServer ();
 
+  /**
+   * \brief Add an address pool to the server
+   *
+   * Must be called before the application starts. The first address of
+   * the range is never leased.
+   *
+   * \param poolAddress The network address of the pool
+   * \param poolMask The network mask of the pool
+   * \param minAddress The first address of the pool
+   * \param maxAddress The last address of the pool
+   * \param gateway Default router advertised to the clients, not advertised if 0.0.0.0
+   */
+  void AddPool (Ipv4Address poolAddress, Ipv4Mask poolMask, Ipv4Address minAddress,
+                Ipv4Address maxAddress, Ipv4Address gateway = Ipv4Address::GetAny ());
+
+  /**
+   * \brief Get the number of address pools of the server
+   * \return the number of pools
+   */
+  uint32_t GetNPools (void) const;
+
+  /**
+   * \brief Write the leases of all the pools to a snapshot file
+   *
+   * The snapshot can be loaded by a server with the same pools through
+   * the LeaseFile attribute.
+   *
+   * \param filename The name of the file
+   * \return false if the file could not be written
+   */
+  bool SaveLeases (std::string filename) const;
+
 protected:
   virtual void DoDispose (void);
 
 private:
   static const int PORT = 67;                       //!< Port number of DHCP server
+  static const uint32_t SNAPSHOT_MAGIC = 0x444c5331; //!< First bytes of a lease snapshot ("DLS1")
+  static const uint32_t FAILOVER_MAGIC = 0x44465531; //!< First bytes of a failover message ("DFU1")
+  static const uint8_t FAILOVER_RESYNC = 0x01;       //!< Flag of a failover message asking for all the bindings
+  static const uint32_t FAILOVER_HEADER_SIZE = 7;    //!< Size of the header of a failover message
+  static const uint32_t FAILOVER_UPDATE_SIZE = 18;   //!< Size of a binding update in a failover message
+
+  /**
+   * \brief An address pool and its leases
+   */
+  struct Pool
+  {
+    Ipv4Address poolAddress;             //!< The network address of the pool
+    Ipv4Mask poolMask;                   //!< The network mask of the pool
+    Ipv4Address minAddress;              //!< The first address in the pool
+    Ipv4Address maxAddress;              //!< The last address in the pool
+    Ipv4Address gateway;                 //!< Default router advertised to the clients
+    DhcpLeaseTable leases;               //!< Leases of the pool, indexed by offset from minAddress
+    std::vector<uint8_t> offerOptions;   //!< Encoded options common to all the offers of the pool
+    EventId expiredEvent;                //!< The Event to trigger TimerHandler at the next lease expiry
+  };
+
+  typedef sgi::hash_map<uint32_t, uint32_t> PrefixMap;      //!< Network address to pool index
+  typedef std::pair<uint32_t, PrefixMap> PrefixLevel;       //!< Network mask and the pools with that mask
+
+  /*
+   * \brief Resets the lease tables of all the pools
+   */
+  void InitializeLeases (void);
+
+  /*
+   * \brief Loads the leases of the pools from a snapshot file
+   *
+   * The pools of the snapshot which the server does not have are skipped.
+   * If the snapshot was taken later than the current simulation time, as
+   * in a previous simulation, the expiry times are moved back accordingly.
+   *
+   * \param filename The name of the file
+   * \return false if the file could not be read
+   */
+  bool LoadLeases (std::string filename);
+
+  /*
+   * \brief Builds the prefix index of the pools
+   */
+  void IndexPools (void);
+
+  /*
+   * \brief Finds the pool whose subnet contains an address
+   * \param address The address
+   * \return the index of the pool, -1 if none
+   */
+  int32_t FindPool (Ipv4Address address) const;
+
+  /*
+   * \brief Finds the pool of a request which was not relayed
+   * \param packet The received packet
+   * \return the index of the pool, -1 if none
+   */
+  int32_t FindInterfacePool (Ptr<Packet> packet) const;
 
   /*
    * \brief Handles incoming packets from the network
@@ -76,22 +203,84 @@ private:
 
   /*
    * \brief Sends DHCP offer after receiving DHCP Discover
+   * \param pool The pool of the client
    * \param header DHCP header of the received message
    * \param from Address of the DHCP client
    */
-  void SendOffer (DhcpHeader header, Address from);
+  void SendOffer (Pool &pool, const DhcpHeader &header, Address from);
 
   /*
    * \brief Sends DHCP ACK (or NACK) after receiving Request
+   * \param pool The pool of the client
    * \param header DHCP header of the received message
    * \param from Address of the DHCP client
    */
-  void SendAck (DhcpHeader header, Address from);
+  void SendAck (Pool &pool, const DhcpHeader &header, Address from);
+
+  /*
+   * \brief Sends a reply to a client, through its relay agent if any
+   * \param packet The packet to be sent
+   * \param giaddr Address of the relay agent of the client, 0.0.0.0 if none
+   * \param to Address of the client if not relayed
+   * \param port Port of the client if not relayed
+   * \return the value returned by Socket::SendTo
+   */
+  int SendReply (Ptr<Packet> packet, Ipv4Address giaddr, Ipv4Address to, uint16_t port);
+
+  /*
+   * \brief Releases the addresses of a pool whose lease expired
+   * \param index The index of the pool
+   */
+  void TimerHandler (uint32_t index);
+
+  /*
+   * \brief Schedules TimerHandler at the earliest lease expiry of a pool, if needed
+   * \param pool The pool
+   */
+  void ScheduleExpiry (Pool &pool);
+
+  /*
+   * \brief Checks whether a client is served by this server of a failover pair
+   * \param chaddr The hardware address of the client
+   * \return true if the client is in the hash buckets of this server, or if the peer is down
+   */
+  bool IsOwnClient (Mac48Address chaddr) const;
+
+  /*
+   * \brief Sets the share of the addresses allocated by this server in all the pools
+   */
+  void UpdateShares (void);
+
+  /*
+   * \brief Queues the binding of an address for replication to the failover peer
+   * \param pool The pool of the address
+   * \param offset The offset of the address in the pool
+   */
+  void QueueUpdate (const Pool &pool, uint32_t offset);
+
+  /*
+   * \brief Queues all the bindings of all the pools for replication to the failover peer
+   */
+  void QueueAllUpdates (void);
+
+  /*
+   * \brief Sends the queued binding updates to the failover peer
+   *
+   * The updates are sent in messages of at most MaxUpdateBatch updates; a
+   * message without update is sent if none is queued.
+   */
+  void FlushUpdates (void);
+
+  /*
+   * \brief Sends a heartbeat to the failover peer and checks that the peer is alive
+   */
+  void Heartbeat (void);
 
   /*
-   * \brief Modifies the remaining lease time of addresses
+   * \brief Handles the messages of the failover peer
+   * \param socket Socket bound to the failover port
    */
-  void TimerHandler (void);
+  void FailoverHandler (Ptr<Socket> socket);
 
   /*
    * \brief Starts the DHCP Server application
@@ -105,19 +294,33 @@ private:
 
   Ptr<Socket> m_socket;                  //!< The socket bound to port 67
   Address m_local;                       //!< The local address
-  Ipv4Address m_poolAddress;             //!< The network address available to the server
-  Ipv4Address m_minAddress;              //!< The first address in the address pool
-  Ipv4Address m_maxAddress;              //!< The last address in the address pool
-  uint32_t m_occurange;                  //!< Number of occupied address in the pool
-  Ipv4Mask m_poolMask;                   //!< The network mask of the pool
+  Ipv4Address m_poolAddress;             //!< The network address of the pool given by the attributes
+  Ipv4Address m_minAddress;              //!< The first address in the pool given by the attributes
+  Ipv4Address m_maxAddress;              //!< The last address in the pool given by the attributes
+  Ipv4Mask m_poolMask;                   //!< The network mask of the pool given by the attributes
   Ipv4Address m_server;                  //!< Address of DHCP server
+  Ipv4Address m_gateway;                 //!< Default router advertised to the clients of the pool given by the attributes
   Ipv4Address m_peer;                    //!< Address of DHCP client
-  std::map<std::pair<Mac48Address, uint32_t>, uint32_t> m_leasedAddresses; //!< Leased address and their status (cache memory)
-  uint32_t m_nextAddressSeq;             //!< The next address in the sequence which can be alloted
+  std::vector<Pool> m_pools;             //!< The address pools
+  std::vector<PrefixLevel> m_prefixIndex; //!< Pool index, by decreasing mask length
   Time m_lease;                          //!< The granted lease time for an address
   Time m_renew;                          //!< The renewal time for an address
   Time m_rebind;                         //!< The rebinding time for an address
-  EventId m_expiredEvent;                //!< The Event to trigger TimerHandler
+  std::string m_leaseFile;               //!< The file the leases are saved to and loaded from
+  bool m_rapidCommit;                    //!< Answer a DISCOVER with Rapid Commit option by an ACK
+  Ipv4Address m_failoverPeer;            //!< Address of the failover peer, 0.0.0.0 if none
+  bool m_failoverPrimary;                //!< This server is the primary of the failover pair
+  uint16_t m_failoverPort;               //!< Port of the failover messages
+  Time m_updateInterval;                 //!< Delay during which the binding updates are batched
+  uint32_t m_maxUpdateBatch;             //!< Maximum number of binding updates in a message
+  Time m_peerTimeout;                    //!< Silence of the peer after which it is considered down
+  Ptr<Socket> m_failoverSocket;          //!< The socket bound to the failover port
+  std::set<std::pair<uint32_t, uint32_t> > m_updates; //!< Bindings to replicate, by pool index and offset
+  bool m_resync;                         //!< The next message asks the peer for all its bindings
+  bool m_partnerDown;                    //!< The failover peer is considered down
+  Time m_peerLastSeen;                   //!< Time of the last message from the failover peer
+  EventId m_flushEvent;                  //!< The Event to trigger FlushUpdates
+  EventId m_heartbeatEvent;              //!< The Event to trigger Heartbeat
 };
 
 } // namespace ns3
@@ -27,6 +27,9 @@
 #include "ns3/internet-module.h"
 
 #include "ns3/test.h"
+#include <cstdio>
+#include <sstream>
+#include <set>
 
 using namespace ns3;
 
@@ -147,6 +150,664 @@ DhcpTestCase1::DoRun (void)
   Simulator::Destroy ();
 }
 
+class DhcpRelayTestCase : public TestCase
+{
+public:
+  DhcpRelayTestCase ();
+  virtual ~DhcpRelayTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DhcpRelayTestCase::DhcpRelayTestCase ()
+  : TestCase ("Dhcp relay test case ")
+{
+}
+
+DhcpRelayTestCase::~DhcpRelayTestCase ()
+{
+}
+
+void
+DhcpRelayTestCase::DoRun (void)
+{
+  /*Set up devices: client -- relay -- server*/
+  NodeContainer nodes;
+  nodes.Create (3);
+  NodeContainer lan1 (nodes.Get (0), nodes.Get (1));
+  NodeContainer lan2 (nodes.Get (1), nodes.Get (2));
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("5Mbps"));
+  csma.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer dev_lan1 = csma.Install (lan1);
+  NetDeviceContainer dev_lan2 = csma.Install (lan2);
+
+  InternetStackHelper tcpip;
+  tcpip.Install (nodes);
+
+  Ptr<Ipv4> ipv4Client = nodes.Get (0)->GetObject<Ipv4> ();
+  uint32_t ifIndex = ipv4Client->AddInterface (dev_lan1.Get (0));
+  ipv4Client->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("0.0.0.0"), Ipv4Mask ("/0")));
+  ipv4Client->SetUp (ifIndex);
+
+  Ptr<Ipv4> ipv4Relay = nodes.Get (1)->GetObject<Ipv4> ();
+  uint32_t ifIndexRelay = ipv4Relay->AddInterface (dev_lan1.Get (1));
+  ipv4Relay->AddAddress (ifIndexRelay, Ipv4InterfaceAddress (Ipv4Address ("10.1.1.1"), Ipv4Mask ("/0"))); // need to remove this workaround
+  ipv4Relay->AddAddress (ifIndexRelay, Ipv4InterfaceAddress (Ipv4Address ("10.1.1.1"), Ipv4Mask ("/24")));
+  ipv4Relay->SetForwarding (ifIndexRelay, true);
+  ipv4Relay->SetUp (ifIndexRelay);
+  ifIndexRelay = ipv4Relay->AddInterface (dev_lan2.Get (0));
+  ipv4Relay->AddAddress (ifIndexRelay, Ipv4InterfaceAddress (Ipv4Address ("10.1.2.1"), Ipv4Mask ("/24")));
+  ipv4Relay->SetForwarding (ifIndexRelay, true);
+  ipv4Relay->SetUp (ifIndexRelay);
+
+  Ptr<Ipv4> ipv4Server = nodes.Get (2)->GetObject<Ipv4> ();
+  uint32_t ifIndexServer = ipv4Server->AddInterface (dev_lan2.Get (1));
+  ipv4Server->AddAddress (ifIndexServer, Ipv4InterfaceAddress (Ipv4Address ("10.1.2.2"), Ipv4Mask ("/24")));
+  ipv4Server->SetUp (ifIndexServer);
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  ipv4RoutingHelper.GetStaticRouting (ipv4Server)->SetDefaultRoute (Ipv4Address ("10.1.2.1"), ifIndexServer);
+
+  DhcpServerHelper dhcp_server (Ipv4Address ("10.1.1.0"), Ipv4Mask ("/24"), Ipv4Address ("10.1.2.2"), Ipv4Address ("10.1.1.10"), Ipv4Address ("10.1.1.100"));
+  ApplicationContainer ap_dhcp_server = dhcp_server.Install (nodes.Get (2));
+  ap_dhcp_server.Start (Seconds (1.0));
+  ap_dhcp_server.Stop (Seconds (50.0));
+
+  DhcpRelayHelper dhcp_relay (Ipv4Address ("10.1.2.2"));
+  ApplicationContainer ap_dhcp_relay = dhcp_relay.Install (nodes.Get (1));
+  ap_dhcp_relay.Start (Seconds (1.0));
+  ap_dhcp_relay.Stop (Seconds (50.0));
+
+  DhcpClientHelper dhcp_client (0);
+  ApplicationContainer ap_dhcp_client = dhcp_client.Install (nodes.Get (0));
+  ap_dhcp_client.Start (Seconds (2.0));
+  ap_dhcp_client.Stop (Seconds (50.0));
+
+  Simulator::Stop (Seconds (40.0));
+
+  Simulator::Run ();
+
+  Ipv4Address address = ipv4Client->GetAddress (ifIndex, 0).GetLocal ();
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address ("10.1.1.11"), address, address);
+
+  Simulator::Destroy ();
+}
+
+class DhcpMultiPoolTestCase : public TestCase
+{
+public:
+  DhcpMultiPoolTestCase ();
+  virtual ~DhcpMultiPoolTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DhcpMultiPoolTestCase::DhcpMultiPoolTestCase ()
+  : TestCase ("Dhcp multiple pools test case ")
+{
+}
+
+DhcpMultiPoolTestCase::~DhcpMultiPoolTestCase ()
+{
+}
+
+void
+DhcpMultiPoolTestCase::DoRun (void)
+{
+  /*Set up devices: client1 -- server -- client2*/
+  NodeContainer nodes;
+  nodes.Create (3);
+  NodeContainer lan1 (nodes.Get (0), nodes.Get (1));
+  NodeContainer lan2 (nodes.Get (2), nodes.Get (1));
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("5Mbps"));
+  csma.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer dev_lan1 = csma.Install (lan1);
+  NetDeviceContainer dev_lan2 = csma.Install (lan2);
+
+  InternetStackHelper tcpip;
+  tcpip.Install (nodes);
+
+  Ptr<Ipv4> ipv4Client1 = nodes.Get (0)->GetObject<Ipv4> ();
+  uint32_t ifIndex1 = ipv4Client1->AddInterface (dev_lan1.Get (0));
+  ipv4Client1->AddAddress (ifIndex1, Ipv4InterfaceAddress (Ipv4Address ("0.0.0.0"), Ipv4Mask ("/0")));
+  ipv4Client1->SetUp (ifIndex1);
+
+  Ptr<Ipv4> ipv4Client2 = nodes.Get (2)->GetObject<Ipv4> ();
+  uint32_t ifIndex2 = ipv4Client2->AddInterface (dev_lan2.Get (0));
+  ipv4Client2->AddAddress (ifIndex2, Ipv4InterfaceAddress (Ipv4Address ("0.0.0.0"), Ipv4Mask ("/0")));
+  ipv4Client2->SetUp (ifIndex2);
+
+  Ptr<Ipv4> ipv4Server = nodes.Get (1)->GetObject<Ipv4> ();
+  uint32_t ifIndexServer = ipv4Server->AddInterface (dev_lan1.Get (1));
+  ipv4Server->AddAddress (ifIndexServer, Ipv4InterfaceAddress (Ipv4Address ("10.1.1.1"), Ipv4Mask ("/0"))); // need to remove this workaround
+  ipv4Server->AddAddress (ifIndexServer, Ipv4InterfaceAddress (Ipv4Address ("10.1.1.1"), Ipv4Mask ("/24")));
+  ipv4Server->SetUp (ifIndexServer);
+  ifIndexServer = ipv4Server->AddInterface (dev_lan2.Get (1));
+  ipv4Server->AddAddress (ifIndexServer, Ipv4InterfaceAddress (Ipv4Address ("10.1.2.1"), Ipv4Mask ("/0"))); // need to remove this workaround
+  ipv4Server->AddAddress (ifIndexServer, Ipv4InterfaceAddress (Ipv4Address ("10.1.2.1"), Ipv4Mask ("/24")));
+  ipv4Server->SetUp (ifIndexServer);
+
+  // the /16 pool must not be chosen for 10.1.2.0/24, which is more specific
+  DhcpServerHelper dhcp_server (Ipv4Address ("10.1.1.0"), Ipv4Mask ("/24"), Ipv4Address ("10.1.1.1"), Ipv4Address ("10.1.1.10"), Ipv4Address ("10.1.1.100"));
+  dhcp_server.AddPool (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("10.1.200.10"), Ipv4Address ("10.1.200.100"));
+  dhcp_server.AddPool (Ipv4Address ("10.1.2.0"), Ipv4Mask ("/24"), Ipv4Address ("10.1.2.20"), Ipv4Address ("10.1.2.100"));
+  ApplicationContainer ap_dhcp_server = dhcp_server.Install (nodes.Get (1));
+  ap_dhcp_server.Start (Seconds (1.0));
+  ap_dhcp_server.Stop (Seconds (50.0));
+  NS_TEST_ASSERT_MSG_EQ (DynamicCast<DhcpServer> (ap_dhcp_server.Get (0))->GetNPools (), 2, "Pools added before start");
+
+  DhcpClientHelper dhcp_client (0);
+  ApplicationContainer ap_dhcp_client = dhcp_client.Install (nodes.Get (0));
+  ap_dhcp_client.Add (dhcp_client.Install (nodes.Get (2)));
+  ap_dhcp_client.Start (Seconds (2.0));
+  ap_dhcp_client.Stop (Seconds (50.0));
+
+  Simulator::Stop (Seconds (40.0));
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (DynamicCast<DhcpServer> (ap_dhcp_server.Get (0))->GetNPools (), 3, "Pool of the attributes added at start");
+  Ipv4Address address = ipv4Client1->GetAddress (ifIndex1, 0).GetLocal ();
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address ("10.1.1.11"), address, address);
+  address = ipv4Client2->GetAddress (ifIndex2, 0).GetLocal ();
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address ("10.1.2.21"), address, address);
+
+  Simulator::Destroy ();
+}
+
+class DhcpWarmRestartTestCase : public TestCase
+{
+public:
+  DhcpWarmRestartTestCase ();
+  virtual ~DhcpWarmRestartTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Runs a server with a lease file and some clients
+   * \param leaseFile The lease file of the server
+   * \param first The number of the first client
+   * \param last The number of the last client
+   * \return the address of the last client
+   */
+  Ipv4Address RunClients (std::string leaseFile, uint32_t first, uint32_t last);
+};
+
+DhcpWarmRestartTestCase::DhcpWarmRestartTestCase ()
+  : TestCase ("Dhcp warm restart test case ")
+{
+}
+
+DhcpWarmRestartTestCase::~DhcpWarmRestartTestCase ()
+{
+}
+
+Ipv4Address
+DhcpWarmRestartTestCase::RunClients (std::string leaseFile, uint32_t first, uint32_t last)
+{
+  uint32_t nClients = last - first + 1;
+  NodeContainer nodes;
+  nodes.Create (nClients + 1);
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("5Mbps"));
+  csma.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer devices = csma.Install (nodes);
+
+  InternetStackHelper tcpip;
+  tcpip.Install (nodes);
+
+  Ptr<Ipv4> ipv4Server = nodes.Get (0)->GetObject<Ipv4> ();
+  uint32_t ifIndex = ipv4Server->AddInterface (devices.Get (0));
+  ipv4Server->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("172.30.0.12"), Ipv4Mask ("/0"))); // need to remove this workaround
+  ipv4Server->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("172.30.0.12"), Ipv4Mask ("/24")));
+  ipv4Server->SetUp (ifIndex);
+
+  DhcpServerHelper dhcp_server (Ipv4Address ("172.30.0.0"), Ipv4Mask ("/24"), Ipv4Address ("172.30.0.12"), Ipv4Address ("172.30.0.10"), Ipv4Address ("172.30.0.100"));
+  dhcp_server.SetAttribute ("LeaseFile", StringValue (leaseFile));
+  ApplicationContainer ap_dhcp_server = dhcp_server.Install (nodes.Get (0));
+  ap_dhcp_server.Start (Seconds (1.0));
+  ap_dhcp_server.Stop (Seconds (20.0));
+
+  DhcpClientHelper dhcp_client (0);
+  Ptr<Ipv4> ipv4Client;
+  for (uint32_t i = 1; i <= nClients; i++)
+    {
+      // the clients of both runs must have the same hardware addresses
+      uint8_t mac[6] = { 0, 0, 0, 0, 0x10, 0 };
+      mac[5] = first + i - 1;
+      Mac48Address chaddr;
+      chaddr.CopyFrom (mac);
+      devices.Get (i)->SetAddress (chaddr);
+
+      ipv4Client = nodes.Get (i)->GetObject<Ipv4> ();
+      ifIndex = ipv4Client->AddInterface (devices.Get (i));
+      ipv4Client->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("0.0.0.0"), Ipv4Mask ("/0")));
+      ipv4Client->SetUp (ifIndex);
+
+      ApplicationContainer ap_dhcp_client = dhcp_client.Install (nodes.Get (i));
+      ap_dhcp_client.Start (Seconds (2.0 * i));
+      ap_dhcp_client.Stop (Seconds (30.0));
+    }
+
+  Simulator::Stop (Seconds (25.0));
+
+  Simulator::Run ();
+
+  Ipv4Address address = ipv4Client->GetAddress (ifIndex, 0).GetLocal ();
+
+  Simulator::Destroy ();
+  return address;
+}
+
+void
+DhcpWarmRestartTestCase::DoRun (void)
+{
+  std::string leaseFile = CreateTempDirFilename ("dhcp-leases.bin");
+  std::remove (leaseFile.c_str ());
+
+  // 172.30.0.12 is the address of the server
+  Ipv4Address address = RunClients (leaseFile, 1, 2);
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address ("172.30.0.13"), address, address);
+
+  // the second client alone gets back its address, which would otherwise be 172.30.0.11
+  address = RunClients (leaseFile, 2, 2);
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address ("172.30.0.13"), address, address);
+}
+
+class DhcpRapidCommitTestCase : public TestCase
+{
+public:
+  DhcpRapidCommitTestCase ();
+  virtual ~DhcpRapidCommitTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DhcpRapidCommitTestCase::DhcpRapidCommitTestCase ()
+  : TestCase ("Dhcp rapid commit test case ")
+{
+}
+
+DhcpRapidCommitTestCase::~DhcpRapidCommitTestCase ()
+{
+}
+
+void
+DhcpRapidCommitTestCase::DoRun (void)
+{
+  /*Set up devices: client -- server*/
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("5Mbps"));
+  csma.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer devices = csma.Install (nodes);
+
+  InternetStackHelper tcpip;
+  tcpip.Install (nodes);
+
+  Ptr<Ipv4> ipv4Client = nodes.Get (0)->GetObject<Ipv4> ();
+  uint32_t ifIndex = ipv4Client->AddInterface (devices.Get (0));
+  ipv4Client->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("0.0.0.0"), Ipv4Mask ("/0")));
+  ipv4Client->SetUp (ifIndex);
+
+  Ptr<Ipv4> ipv4Server = nodes.Get (1)->GetObject<Ipv4> ();
+  uint32_t ifIndexServer = ipv4Server->AddInterface (devices.Get (1));
+  ipv4Server->AddAddress (ifIndexServer, Ipv4InterfaceAddress (Ipv4Address ("172.30.0.12"), Ipv4Mask ("/0"))); // need to remove this workaround
+  ipv4Server->AddAddress (ifIndexServer, Ipv4InterfaceAddress (Ipv4Address ("172.30.0.12"), Ipv4Mask ("/24")));
+  ipv4Server->SetUp (ifIndexServer);
+
+  DhcpServerHelper dhcp_server (Ipv4Address ("172.30.0.0"), Ipv4Mask ("/24"), Ipv4Address ("172.30.0.12"), Ipv4Address ("172.30.0.10"), Ipv4Address ("172.30.0.100"));
+  dhcp_server.SetAttribute ("RapidCommit", BooleanValue (true));
+  ApplicationContainer ap_dhcp_server = dhcp_server.Install (nodes.Get (1));
+  ap_dhcp_server.Start (Seconds (1.0));
+  ap_dhcp_server.Stop (Seconds (50.0));
+
+  DhcpClientHelper dhcp_client (0);
+  ApplicationContainer ap_dhcp_client = dhcp_client.Install (nodes.Get (0));
+  ap_dhcp_client.Start (Seconds (2.0));
+  ap_dhcp_client.Stop (Seconds (50.0));
+
+  // without rapid commit the client would still be collecting offers
+  Simulator::Stop (Seconds (3.0));
+
+  Simulator::Run ();
+
+  Ipv4Address address = ipv4Client->GetAddress (ifIndex, 0).GetLocal ();
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address ("172.30.0.11"), address, address);
+
+  Simulator::Destroy ();
+}
+
+class DhcpFailoverTestCase : public TestCase
+{
+public:
+  DhcpFailoverTestCase ();
+  virtual ~DhcpFailoverTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Records the addresses and the servers of the clients
+   * \param clients The client applications
+   */
+  void Record (ApplicationContainer clients);
+
+  std::vector<Ipv4Address> m_addresses; //!< Addresses of the clients
+  std::vector<Ipv4Address> m_servers;   //!< Servers of the clients
+};
+
+DhcpFailoverTestCase::DhcpFailoverTestCase ()
+  : TestCase ("Dhcp failover test case ")
+{
+}
+
+DhcpFailoverTestCase::~DhcpFailoverTestCase ()
+{
+}
+
+void
+DhcpFailoverTestCase::Record (ApplicationContainer clients)
+{
+  m_addresses.clear ();
+  m_servers.clear ();
+  for (uint32_t i = 0; i < clients.GetN (); i++)
+    {
+      Ptr<Ipv4> ipv4 = clients.Get (i)->GetNode ()->GetObject<Ipv4> ();
+      m_addresses.push_back (ipv4->GetAddress (1, 0).GetLocal ());
+      m_servers.push_back (DynamicCast<DhcpClient> (clients.Get (i))->GetDhcpServer ());
+    }
+}
+
+void
+DhcpFailoverTestCase::DoRun (void)
+{
+  /*Set up devices: primary, secondary and clients on one LAN*/
+  uint32_t nClients = 8;
+  NodeContainer nodes;
+  nodes.Create (nClients + 2);
+
+  InternetStackHelper tcpip;
+  tcpip.Install (nodes);
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("5Mbps"));
+  csma.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer devices = csma.Install (nodes);
+
+  const char *serverAddresses[2] = { "172.30.0.12", "172.30.0.13" };
+  ApplicationContainer ap_dhcp_server;
+  for (uint32_t s = 0; s < 2; s++)
+    {
+      Ptr<Ipv4> ipv4Server = nodes.Get (s)->GetObject<Ipv4> ();
+      uint32_t ifIndex = ipv4Server->AddInterface (devices.Get (s));
+      ipv4Server->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (serverAddresses[s]), Ipv4Mask ("/0"))); // need to remove this workaround
+      ipv4Server->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (serverAddresses[s]), Ipv4Mask ("/24")));
+      ipv4Server->SetUp (ifIndex);
+
+      DhcpServerHelper dhcp_server (Ipv4Address ("172.30.0.0"), Ipv4Mask ("/24"), Ipv4Address (serverAddresses[s]), Ipv4Address ("172.30.0.10"), Ipv4Address ("172.30.0.100"));
+      dhcp_server.SetAttribute ("FailoverPeer", Ipv4AddressValue (serverAddresses[1 - s]));
+      dhcp_server.SetAttribute ("FailoverPrimary", BooleanValue (s == 0));
+      ap_dhcp_server.Add (dhcp_server.Install (nodes.Get (s)));
+    }
+  ap_dhcp_server.Start (Seconds (1.0));
+  // the primary fails
+  ap_dhcp_server.Get (0)->SetStopTime (Seconds (10.0));
+  ap_dhcp_server.Get (1)->SetStopTime (Seconds (60.0));
+
+  // the loopback is device 0 of the clients
+  DhcpClientHelper dhcp_client (1);
+  ApplicationContainer ap_dhcp_client;
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      uint8_t mac[6] = { 0, 0, 0, 0, 0x20, 0 };
+      mac[5] = i;
+      Mac48Address chaddr;
+      chaddr.CopyFrom (mac);
+      devices.Get (i + 2)->SetAddress (chaddr);
+
+      Ptr<Ipv4> ipv4Client = nodes.Get (i + 2)->GetObject<Ipv4> ();
+      uint32_t ifIndex = ipv4Client->AddInterface (devices.Get (i + 2));
+      ipv4Client->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("0.0.0.0"), Ipv4Mask ("/0")));
+      ipv4Client->SetUp (ifIndex);
+
+      ApplicationContainer app = dhcp_client.Install (nodes.Get (i + 2));
+      app.Start (Seconds (2.0 + 0.25 * i));
+      app.Stop (Seconds (60.0));
+      ap_dhcp_client.Add (app);
+    }
+
+  Simulator::Schedule (Seconds (9.4), &DhcpFailoverTestCase::Record, this, ap_dhcp_client);
+  Simulator::Stop (Seconds (9.5));
+  Simulator::Run ();
+
+  // both servers served clients, from their own half of the pool
+  std::vector<Ipv4Address> addresses = m_addresses;
+  std::set<Ipv4Address> unique;
+  uint32_t nPrimary = 0;
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      NS_TEST_ASSERT_MSG_NE (addresses[i], Ipv4Address ("0.0.0.0"), "Client " << i << " got no address");
+      unique.insert (addresses[i]);
+      if (m_servers[i] == Ipv4Address ("172.30.0.12"))
+        {
+          nPrimary++;
+          NS_TEST_ASSERT_MSG_EQ ((addresses[i].Get () - 10) % 2, 0, "Odd offset from the primary " << addresses[i]);
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_servers[i], Ipv4Address ("172.30.0.13"), "Unknown server");
+          NS_TEST_ASSERT_MSG_EQ ((addresses[i].Get () - 10) % 2, 1, "Even offset from the secondary " << addresses[i]);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (unique.size (), nClients, "Address leased twice");
+  NS_TEST_ASSERT_MSG_GT (nPrimary, 0, "No client served by the primary");
+  NS_TEST_ASSERT_MSG_LT (nPrimary, nClients, "No client served by the secondary");
+
+  // the clients of the primary get back their address from the secondary
+  // once their lease expires, thanks to the replicated bindings
+  Simulator::Schedule (Seconds (50.0) - Simulator::Now (), &DhcpFailoverTestCase::Record, this, ap_dhcp_client);
+  Simulator::Stop (Seconds (51.0) - Simulator::Now ());
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < nClients; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_addresses[i], addresses[i], "Client " << i << " changed address");
+      NS_TEST_ASSERT_MSG_EQ (m_servers[i], Ipv4Address ("172.30.0.13"), "Client " << i << " not served by the secondary");
+    }
+
+  Simulator::Destroy ();
+}
+
+class DhcpLeaseTableTestCase : public TestCase
+{
+public:
+  DhcpLeaseTableTestCase ();
+  virtual ~DhcpLeaseTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DhcpLeaseTableTestCase::DhcpLeaseTableTestCase ()
+  : TestCase ("Dhcp lease table test case ")
+{
+}
+
+DhcpLeaseTableTestCase::~DhcpLeaseTableTestCase ()
+{
+}
+
+void
+DhcpLeaseTableTestCase::DoRun (void)
+{
+  Mac48Address mac1 ("00:00:00:00:00:01");
+  Mac48Address mac2 ("00:00:00:00:00:02");
+  Mac48Address mac3 ("00:00:00:00:00:03");
+  DhcpLeaseTable table;
+  uint32_t offset;
+
+  table.Initialize (4, 1);
+  table.Bind (mac3, 2, Time::Max ());
+
+  NS_TEST_ASSERT_MSG_EQ (table.AllocateFree (offset), true, "No free address");
+  NS_TEST_ASSERT_MSG_EQ (offset, 1, "Wrong first free address");
+  table.Bind (mac1, offset, Seconds (2));
+  NS_TEST_ASSERT_MSG_EQ (table.AllocateFree (offset), true, "No free address");
+  NS_TEST_ASSERT_MSG_EQ (offset, 3, "Leased address given again");
+  table.Bind (mac2, offset, Seconds (5));
+  NS_TEST_ASSERT_MSG_EQ (table.AllocateFree (offset), false, "Pool should be exhausted");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNLeased (), 3, "Wrong number of leases");
+
+  NS_TEST_ASSERT_MSG_EQ (table.LookupByMac (mac2, offset), true, "Client not found");
+  NS_TEST_ASSERT_MSG_EQ (offset, 3, "Wrong address of the client");
+  NS_TEST_ASSERT_MSG_EQ (table.GetClient (1), mac1, "Wrong client of the address");
+
+  // renewing a lease moves only its own expiry
+  Time expiry;
+  table.Extend (1, Seconds (1));
+  NS_TEST_ASSERT_MSG_EQ (table.GetNextExpiry (expiry), true, "No lease can expire");
+  NS_TEST_ASSERT_MSG_EQ (expiry, Seconds (3), "Wrong next expiry");
+
+  // the lease of mac1 expires, but the client keeps its binding
+  NS_TEST_ASSERT_MSG_EQ (table.Expire (Seconds (2)), 0, "Lease expired too early");
+  NS_TEST_ASSERT_MSG_EQ (table.Expire (Seconds (3)), 1, "Lease should have expired");
+  NS_TEST_ASSERT_MSG_EQ (table.IsLeased (1), false, "Lease should have expired");
+  NS_TEST_ASSERT_MSG_EQ (table.LookupByMac (mac1, offset), true, "Expired client forgotten");
+  NS_TEST_ASSERT_MSG_EQ (table.IsLeased (2), true, "Infinite lease expired");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNextExpiry (expiry), true, "No lease can expire");
+  NS_TEST_ASSERT_MSG_EQ (expiry, Seconds (5), "Wrong next expiry");
+
+  NS_TEST_ASSERT_MSG_EQ (table.AllocateFree (offset), true, "Expired address not freed");
+  NS_TEST_ASSERT_MSG_EQ (offset, 1, "Wrong expired address");
+  table.Bind (mac2, offset, Seconds (5));
+  NS_TEST_ASSERT_MSG_EQ (table.LookupByMac (mac1, offset), false, "Previous binding not dropped");
+  NS_TEST_ASSERT_MSG_EQ (table.IsBound (3), false, "Previous address of the client not released");
+  NS_TEST_ASSERT_MSG_EQ (table.GetLastClient (3), mac2, "Last client of a released address forgotten");
+  NS_TEST_ASSERT_MSG_EQ (table.GetLastClient (0), Mac48Address (), "Client of an address never bound");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNLeased (), 2, "Wrong number of leases");
+
+  // a snapshot keeps the bindings, the free list and the (shifted) expiries
+  std::stringstream snapshot;
+  table.Serialize (snapshot);
+  DhcpLeaseTable copy;
+  std::string data = snapshot.str ();
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (snapshot, Seconds (1), 4), true, "Snapshot not read");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetSize (), 4, "Wrong size of the pool");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetNLeased (), 2, "Wrong number of leases");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetClient (1), mac2, "Wrong client of the address");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetExpiry (1), Seconds (6), "Expiry not shifted");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetExpiry (2), Time::Max (), "Infinite lease shifted");
+  NS_TEST_ASSERT_MSG_EQ (copy.AllocateFree (offset), true, "Free list lost");
+  NS_TEST_ASSERT_MSG_EQ (offset, 3, "Wrong free address");
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (snapshot, Seconds (0), 4), false, "Truncated snapshot read");
+
+  // corrupt snapshots are rejected before the table is sized from them
+  std::stringstream wrongPool (data);
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (wrongPool, Seconds (0), 8), false, "Snapshot of another pool read");
+  std::string huge = data;
+  huge.replace (0, 4, "\x00\x01\x00\x00", 4);
+  huge.replace (8, 4, "\x00\x00\xff\xff", 4);
+  std::stringstream hugeSize (huge);
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (hugeSize, Seconds (0), 0x10000), false, "Bindings beyond the snapshot read");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetSize (), 0, "Table not emptied");
+  std::stringstream truncated (data.substr (0, data.size () - 8));
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (truncated, Seconds (0), 4), false, "Truncated snapshot read");
+  std::stringstream skipped (data + data);
+  NS_TEST_ASSERT_MSG_EQ (DhcpLeaseTable::SkipSnapshot (skipped), true, "Snapshot not skipped");
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (skipped, Seconds (0), 4), true, "Snapshot after a skipped one not read");
+  std::stringstream truncatedSkip (data.substr (0, data.size () - 1));
+  NS_TEST_ASSERT_MSG_EQ (DhcpLeaseTable::SkipSnapshot (truncatedSkip), false, "Truncated snapshot skipped");
+
+  NS_TEST_ASSERT_MSG_EQ (table.Expire (Seconds (10)), 1, "Stale expiry entries not discarded");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNextExpiry (expiry), false, "Only the infinite lease should remain");
+
+  // a table of a failover pair allocates only its share of the pool
+  DhcpLeaseTable shared;
+  shared.Initialize (4, 0);
+  shared.SetShare (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (shared.IsInShare (1), true, "Address of the share excluded");
+  NS_TEST_ASSERT_MSG_EQ (shared.IsInShare (2), false, "Address of the peer included");
+  NS_TEST_ASSERT_MSG_EQ (shared.AllocateFree (offset), true, "No free address");
+  NS_TEST_ASSERT_MSG_EQ (offset, 1, "Address of the peer allocated");
+  shared.SetShare (0, 1);
+  NS_TEST_ASSERT_MSG_EQ (shared.IsInShare (2), true, "Address of the pool excluded");
+}
+
+class DhcpHeaderTestCase : public TestCase
+{
+public:
+  DhcpHeaderTestCase ();
+  virtual ~DhcpHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DhcpHeaderTestCase::DhcpHeaderTestCase ()
+  : TestCase ("Dhcp header options test case ")
+{
+}
+
+DhcpHeaderTestCase::~DhcpHeaderTestCase ()
+{
+}
+
+void
+DhcpHeaderTestCase::DoRun (void)
+{
+  DhcpHeader offerTemplate;
+  offerTemplate.SetDhcps (Ipv4Address ("172.30.0.12"));
+  offerTemplate.SetLease (30);
+  std::vector<uint8_t> router (4);
+  Ipv4Address ("172.30.0.1").Serialize (&router[0]);
+  offerTemplate.SetOption (DhcpHeader::OP_ROUTE, router);
+  std::vector<uint8_t> options;
+  offerTemplate.SerializeOptions (options);
+  NS_TEST_ASSERT_MSG_EQ (options.size (), 18, "Wrong size of the encoded options");
+
+  DhcpHeader header;
+  header.SetType (DhcpHeader::DHCPOFFER);
+  header.SetTran (1234);
+  header.SetChaddr48 (Mac48Address ("00:00:00:00:00:01"));
+  header.SetYiaddr (Ipv4Address ("172.30.0.13"));
+  header.AddOptions (options);
+  std::vector<uint8_t> params;
+  params.push_back (DhcpHeader::OP_MASK);
+  params.push_back (DhcpHeader::OP_ROUTE);
+  header.SetOption (DhcpHeader::OP_PARAMREQ, params);
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 241 + 3 + 18 + 4, "Wrong size of the header");
+
+  DhcpHeader received;
+  NS_TEST_ASSERT_MSG_EQ (packet->RemoveHeader (received), 241 + 3 + 18 + 4, "Header not decoded");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) received.GetType (), (uint32_t) DhcpHeader::DHCPOFFER, "Wrong message type");
+  NS_TEST_ASSERT_MSG_EQ (received.GetTran (), 1234, "Wrong transaction");
+  NS_TEST_ASSERT_MSG_EQ (received.GetDhcps (), Ipv4Address ("172.30.0.12"), "Wrong server identifier");
+  NS_TEST_ASSERT_MSG_EQ (received.GetLease (), 30, "Wrong lease time");
+  NS_TEST_ASSERT_MSG_EQ (received.HasOpt (DhcpHeader::OP_LEASE), true, "Lease time option lost");
+  NS_TEST_ASSERT_MSG_EQ (received.HasOpt (DhcpHeader::OP_RAPIDCOMMIT), false, "Untyped option in the mask");
+  NS_TEST_ASSERT_MSG_EQ (received.HasOpt (DhcpHeader::OP_END), false, "End option in the mask");
+  std::vector<uint8_t> value;
+  NS_TEST_ASSERT_MSG_EQ (received.GetOption (DhcpHeader::OP_ROUTE, value), true, "Router option lost");
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address::Deserialize (&value[0]), Ipv4Address ("172.30.0.1"), "Wrong router");
+  NS_TEST_ASSERT_MSG_EQ (received.GetOption (DhcpHeader::OP_PARAMREQ, value), true, "Parameter request list lost");
+  NS_TEST_ASSERT_MSG_EQ (value.size (), 2, "Wrong parameter request list");
+  NS_TEST_ASSERT_MSG_EQ (received.GetOption (DhcpHeader::OP_DNS, value), false, "Unexpected DNS option");
+}
+
 class DhcpTestSuite : public TestSuite
 {
 public:
@@ -156,6 +817,13 @@ public:
 DhcpTestSuite::DhcpTestSuite ()
   : TestSuite ("dhcp", UNIT)
 {
+  AddTestCase (new DhcpRelayTestCase, TestCase::QUICK);
+  AddTestCase (new DhcpMultiPoolTestCase, TestCase::QUICK);
+  AddTestCase (new DhcpWarmRestartTestCase, TestCase::QUICK);
+  AddTestCase (new DhcpRapidCommitTestCase, TestCase::QUICK);
+  AddTestCase (new DhcpFailoverTestCase, TestCase::QUICK);
+  AddTestCase (new DhcpLeaseTableTestCase, TestCase::QUICK);
+  AddTestCase (new DhcpHeaderTestCase, TestCase::QUICK);
   AddTestCase (new DhcpTestCase1, TestCase::QUICK);
 }
 
@@ -26,6 +26,7 @@
 #include "pointer.h"
 #include "log.h"
 
+#include <map>
 #include <sstream>
 
 /**
@@ -38,6 +39,175 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Config");
 
+/**
+ * The attributes and trace sources of a TypeId and of its parents,
+ * gathered once to resolve Config paths and to set or connect their
+ * last element.
+ */
+class TypeTable
+{
+public:
+  /** An attribute pointing to an object or to a container of objects. */
+  struct ObjectAttribute
+  {
+    /** The attribute name. */
+    std::string name;
+    /** The attribute accessor. */
+    Ptr<const AttributeAccessor> accessor;
+    /** The accessor of a container attribute, else 0. */
+    const ObjectPtrContainerAccessor *container;
+  };
+  /** An attribute, as needed to set it. */
+  struct Attribute
+  {
+    /** AttributeFlags value. */
+    uint32_t flags;
+    /** Accessor object. */
+    Ptr<const AttributeAccessor> accessor;
+    /** Checker object. */
+    Ptr<const AttributeChecker> checker;
+  };
+
+  /**
+   * Get the table of a TypeId, building it the first time.
+   *
+   * \param [in] tid The TypeId.
+   * \returns The table.
+   */
+  static const TypeTable &Get (TypeId tid);
+
+  /**
+   * Get the object and container attributes, with those of the TypeId
+   * before those of its parents, as TypeId::GetAttribute lists them.
+   *
+   * \returns The attributes.
+   */
+  const std::vector<struct ObjectAttribute> &GetObjectAttributes (void) const;
+  /**
+   * Find an attribute by name.
+   *
+   * \param [in] name The attribute name.
+   * \returns The attribute, or 0 if not found.
+   */
+  const struct Attribute *LookupAttribute (std::string name) const;
+  /**
+   * Find a trace source by name.
+   *
+   * \param [in] name The trace source name.
+   * \returns The trace source accessor, or 0 if not found.
+   */
+  Ptr<const TraceSourceAccessor> LookupTraceSource (std::string name) const;
+
+private:
+  /**
+   * Build the table of a TypeId.
+   *
+   * \param [in] tid The TypeId.
+   */
+  void Build (TypeId tid);
+
+  /** Map type of the attributes by name. */
+  typedef std::map<std::string, struct Attribute> Attributes;
+  /** Map type of the trace sources by name. */
+  typedef std::map<std::string, Ptr<const TraceSourceAccessor> > TraceSources;
+
+  /** The object and container attributes. */
+  std::vector<struct ObjectAttribute> m_objectAttributes;
+  /** The attributes, the first found up the parents for each name. */
+  Attributes m_attributes;
+  /** The trace sources, the first found up the parents for each name. */
+  TraceSources m_traceSources;
+};
+
+const TypeTable &
+TypeTable::Get (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  static std::map<uint16_t, TypeTable> tables;
+  std::map<uint16_t, TypeTable>::iterator i = tables.find (tid.GetUid ());
+  if (i == tables.end ())
+    {
+      i = tables.insert (std::make_pair (tid.GetUid (), TypeTable ())).first;
+      i->second.Build (tid);
+    }
+  return i->second;
+}
+
+void
+TypeTable::Build (TypeId tid)
+{
+  NS_LOG_FUNCTION (this << tid);
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          struct Attribute attribute;
+          attribute.flags = info.flags;
+          attribute.accessor = info.accessor;
+          attribute.checker = info.checker;
+          m_attributes.insert (std::make_pair (info.name, attribute));
+
+          // the objects can only be reached through a getter
+          if (!(info.flags & TypeId::ATTR_GET) || !info.accessor->HasGetter ())
+            {
+              continue;
+            }
+          struct ObjectAttribute object;
+          object.name = info.name;
+          object.accessor = info.accessor;
+          object.container = 0;
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              m_objectAttributes.push_back (object);
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              object.container = dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (info.accessor));
+              NS_ASSERT (object.container != 0);
+              m_objectAttributes.push_back (object);
+            }
+        }
+      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
+        {
+          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
+          m_traceSources.insert (std::make_pair (info.name, info.accessor));
+        }
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+}
+
+const std::vector<struct TypeTable::ObjectAttribute> &
+TypeTable::GetObjectAttributes (void) const
+{
+  return m_objectAttributes;
+}
+
+const struct TypeTable::Attribute *
+TypeTable::LookupAttribute (std::string name) const
+{
+  Attributes::const_iterator i = m_attributes.find (name);
+  if (i == m_attributes.end ())
+    {
+      return 0;
+    }
+  return &i->second;
+}
+
+Ptr<const TraceSourceAccessor>
+TypeTable::LookupTraceSource (std::string name) const
+{
+  TraceSources::const_iterator i = m_traceSources.find (name);
+  if (i == m_traceSources.end ())
+    {
+      return 0;
+    }
+  return i->second;
+}
+
 namespace Config {
 
 MatchContainer::MatchContainer ()
@@ -94,10 +264,32 @@ void
 MatchContainer::Set (std::string name, const AttributeValue &value)
 {
   NS_LOG_FUNCTION (this << name << &value);
+  // the value is checked once for all the objects of a type
+  TypeId tid;
+  const TypeTable::Attribute *attribute = 0;
+  Ptr<AttributeValue> v;
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
       Ptr<Object> object = *tmp;
-      object->SetAttribute (name, value);
+      if (attribute == 0 || object->GetInstanceTypeId () != tid)
+        {
+          tid = object->GetInstanceTypeId ();
+          attribute = TypeTable::Get (tid).LookupAttribute (name);
+          if (attribute == 0)
+            {
+              NS_FATAL_ERROR ("Attribute name="<<name<<" does not exist for this object: tid="<<tid.GetName ());
+            }
+          if (!(attribute->flags & TypeId::ATTR_SET) ||
+              !attribute->accessor->HasSetter ())
+            {
+              NS_FATAL_ERROR ("Attribute name="<<name<<" is not settable for this object: tid="<<tid.GetName ());
+            }
+          v = attribute->checker->CreateValidValue (value);
+        }
+      if (v == 0 || !attribute->accessor->Set (PeekPointer (object), *v))
+        {
+          NS_FATAL_ERROR ("Attribute name="<<name<<" could not be set for this object: tid="<<tid.GetName ());
+        }
     }
 }
 void 
@@ -108,8 +300,13 @@ MatchContainer::Connect (std::string name, const CallbackBase &cb)
   for (uint32_t i = 0; i < m_objects.size (); ++i)
     {
       Ptr<Object> object = m_objects[i];
-      std::string ctx = m_contexts[i] + name;
-      object->TraceConnect (name, ctx, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        TypeTable::Get (object->GetInstanceTypeId ()).LookupTraceSource (name);
+      if (accessor != 0)
+        {
+          std::string ctx = m_contexts[i] + name;
+          accessor->Connect (PeekPointer (object), ctx, cb);
+        }
     }
 }
 void 
@@ -120,7 +317,12 @@ MatchContainer::ConnectWithoutContext (std::string name, const CallbackBase &cb)
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
       Ptr<Object> object = *tmp;
-      object->TraceConnectWithoutContext (name, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        TypeTable::Get (object->GetInstanceTypeId ()).LookupTraceSource (name);
+      if (accessor != 0)
+        {
+          accessor->ConnectWithoutContext (PeekPointer (object), cb);
+        }
     }
 }
 void 
@@ -131,8 +333,13 @@ MatchContainer::Disconnect (std::string name, const CallbackBase &cb)
   for (uint32_t i = 0; i < m_objects.size (); ++i)
     {
       Ptr<Object> object = m_objects[i];
-      std::string ctx = m_contexts[i] + name;
-      object->TraceDisconnect (name, ctx, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        TypeTable::Get (object->GetInstanceTypeId ()).LookupTraceSource (name);
+      if (accessor != 0)
+        {
+          std::string ctx = m_contexts[i] + name;
+          accessor->Disconnect (PeekPointer (object), ctx, cb);
+        }
     }
 }
 void 
@@ -142,117 +349,48 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
       Ptr<Object> object = *tmp;
-      object->TraceDisconnectWithoutContext (name, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        TypeTable::Get (object->GetInstanceTypeId ()).LookupTraceSource (name);
+      if (accessor != 0)
+        {
+          accessor->DisconnectWithoutContext (PeekPointer (object), cb);
+        }
     }
 }
 
-} // namespace Config
-
-
-/** Helper to test if an array entry matches a config path specification. */
-class ArrayMatcher
-{
-public:
-  /**
-   * Construct from a Config path specification.
-   *
-   * \param [in] element The Config path specification.
-   */
-  ArrayMatcher (std::string element);
-  /**
-   * Test if a specific index matches the Config Path.
-   *
-   * \param [in] i The index.
-   * \returns \c true if the index matches the Config Path.
-   */
-  bool Matches (uint32_t i) const;
-private:
-  /**
-   * Convert a string to an \c uint32_t.
-   *
-   * \param [in] str The string.
-   * \param [in] value The location to store the \c uint32_t.
-   * \returns \c true if the string could be converted.
-   */
-  bool StringToUint32 (std::string str, uint32_t *value) const;
-  /** The Config path element. */
-  std::string m_element;
-};
-
-
-ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
-{
-  NS_LOG_FUNCTION (this << element);
-}
 bool
-ArrayMatcher::Matches (uint32_t i) const
+CompiledPath::Item::Matches (uint32_t i) const
 {
   NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  if (anyIndex)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
-  std::string::size_type tmp;
-  tmp = m_element.find ("|");
-  if (tmp != std::string::npos)
-    {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
-    }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
-      dash > leftBracket && dash < rightBracket)
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = indices.begin ();
+       j != indices.end (); ++j)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
-      uint32_t min;
-      uint32_t max;
-      if (StringToUint32 (lowerBound, &min) && 
-          StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+      if (i >= j->first && i <= j->second)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
           return true;
         }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
-        }
-    }
-  uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
-    {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-      return true;
     }
-  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
 
-bool
-ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
+} // namespace Config
+
+
+/**
+ * Convert a string to an \c uint32_t.
+ *
+ * \param [in] str The string.
+ * \param [in] value The location to store the \c uint32_t.
+ * \returns \c true if the string could be converted.
+ */
+static bool
+StringToUint32 (std::string str, uint32_t *value)
 {
-  NS_LOG_FUNCTION (this << str << value);
+  NS_LOG_FUNCTION (str << value);
   std::istringstream iss;
   iss.str (str);
   iss >> (*value);
@@ -266,11 +404,11 @@ class Resolver
 {
 public:
   /**
-   * Construct from a base Config path.
+   * Construct from the elements of a Config path.
    *
-   * \param [in] path The Config path.
+   * \param [in] items The elements of the Config path.
    */
-  Resolver (std::string path);
+  Resolver (const std::vector<struct Config::CompiledPath::Item> &items);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -284,23 +422,23 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] i The index of the next element.
    * \param [in] root The object corresponding to the current positon
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (uint32_t i, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] i The index of the element with the container index.
+   * \param [in] root The object holding the container.
+   * \param [in] attribute The container attribute.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (uint32_t i, Ptr<Object> root,
+                       const struct TypeTable::ObjectAttribute &attribute);
   /**
    * Handle one object found on the path.
    *
@@ -323,46 +461,26 @@ private:
 
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
-  /** The Config path. */
-  std::string m_path;
+  /** The elements of the Config path. */
+  const std::vector<struct Config::CompiledPath::Item> &m_items;
 };
 
-Resolver::Resolver (std::string path)
-  : m_path (path)
+Resolver::Resolver (const std::vector<struct Config::CompiledPath::Item> &items)
+  : m_items (items)
 {
-  NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  NS_LOG_FUNCTION (this << &items);
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
-}
 
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -388,13 +506,11 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t i, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << i << root);
 
-  if (next == std::string::npos)
+  if (i == m_items.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -410,8 +526,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const struct Config::CompiledPath::Item &item = m_items[i];
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -422,11 +537,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.name.compare (0, 5, "Names") == 0)
         {
-          m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          m_workStack.push_back (item.name);
+          DoResolve (i + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -438,12 +552,12 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   // zero, this means to look in the root of the "/Names" name space, otherwise
   // it refers to a name space context (level).
   //
-  Ptr<Object> namedObject = Names::Find<Object> (root, item);
+  Ptr<Object> namedObject = Names::Find<Object> (root, item.name);
   if (namedObject)
     {
-      NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      NS_LOG_DEBUG ("Name system resolved item = " << item.name << " to " << namedObject);
+      m_workStack.push_back (item.name);
+      DoResolve (i + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -459,114 +573,122 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (item.getObject)
     {
-      // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
+      // This is a call to GetObject; the TypeId may have been registered
+      // since the path was compiled
+      std::string tidString = item.name.substr (1, item.name.size () - 1);
       NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      TypeId tid = item.tidFound ? item.tid : TypeId::LookupByName (tidString);
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
           NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
           return;
         }
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      m_workStack.push_back (item.name);
+      DoResolve (i + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
-      // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
+      // this is a normal attribute: only those which hold objects can
+      // be followed, the others are ignored
+      const std::vector<struct TypeTable::ObjectAttribute> &attributes =
+        TypeTable::Get (root->GetInstanceTypeId ()).GetObjectAttributes ();
       bool foundMatch = false;
-      
-      do
+      for (std::vector<struct TypeTable::ObjectAttribute>::const_iterator j = attributes.begin ();
+           j != attributes.end (); ++j)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (j->name != item.name && item.name != "*")
+            {
+              continue;
+            }
+          if (j->container == 0)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<j->name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              j->accessor->Get (PeekPointer (root), ptr);
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item.name<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (j->name);
+              DoResolve (i + 1, object);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<j->name<<" on path="<<GetResolvedPath ());
+              foundMatch = true;
+              m_workStack.push_back (j->name);
+              DoArrayResolve (i + 1, root, *j);
+              m_workStack.pop_back ();
+            }
+        }
       
       if (!foundMatch)
         {
-          NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("Requested item="<<item.name<<" does not exist on path="<<GetResolvedPath ());
           return;
         }
     }
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (uint32_t i, Ptr<Object> root,
+                          const struct TypeTable::ObjectAttribute &attribute)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << i << root << attribute.name);
+  if (i == m_items.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const struct Config::CompiledPath::Item &item = m_items[i];
+
+  if (!item.anyIndex && item.indices.size () == 1
+      && item.indices[0].first == item.indices[0].second)
+    {
+      // a single index, which is usually the position of the object in
+      // the container: check it before getting the whole container
+      uint32_t wanted = item.indices[0].first;
+      uint32_t n;
+      if (!attribute.container->GetItemN (PeekPointer (root), &n))
+        {
+          return;
+        }
+      if (wanted < n)
+        {
+          uint32_t index;
+          Ptr<Object> object = attribute.container->GetItem (PeekPointer (root), wanted, &index);
+          if (index == wanted)
+            {
+              std::ostringstream oss;
+              oss << index;
+              m_workStack.push_back (oss.str ());
+              DoResolve (i + 1, object);
+              m_workStack.pop_back ();
+              return;
+            }
+        }
+    }
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  ObjectPtrContainerValue container;
+  attribute.accessor->Get (PeekPointer (root), container);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
-      if (matcher.Matches ((*it).first))
+      if (item.Matches ((*it).first))
         {
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (i + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -588,6 +710,15 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   Config::MatchContainer LookupMatches (std::string path);
+  /**
+   * Find the objects which match the elements of a compiled path.
+   *
+   * \param [in] items The elements of the path.
+   * \param [in] path The path, for the container.
+   * \returns The matching objects.
+   */
+  Config::MatchContainer LookupMatches (const std::vector<struct Config::CompiledPath::Item> &items,
+                                        std::string path);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -600,15 +731,6 @@ public:
   Ptr<Object> GetRootNamespaceObject (uint32_t i) const;
 
 private:
-  /**
-   * Break a Config path into the leading path and the last leaf token.
-   * \param [in] path The Config path.
-   * \param [in,out] root The leading part of the \p path,
-   *   up to the final slash.
-   * \param [in,out] leaf The trailing part of the \p path.
-   */
-  void ParsePath (std::string path, std::string *root, std::string *leaf) const;
-
   /** Container type to hold the root Config path tokens. */
   typedef std::vector<Ptr<Object> > Roots;
 
@@ -616,76 +738,54 @@ private:
   Roots m_roots;
 };
 
-void 
-ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) const
-{
-  NS_LOG_FUNCTION (this << path << root << leaf);
-
-  std::string::size_type slash = path.find_last_of ("/");
-  NS_ASSERT (slash != std::string::npos);
-  *root = path.substr (0, slash);
-  *leaf = path.substr (slash+1, path.size ()-(slash+1));
-  NS_LOG_FUNCTION (path << *root << *leaf);
-}
-
 void 
 ConfigImpl::Set (std::string path, const AttributeValue &value)
 {
   NS_LOG_FUNCTION (this << path << &value);
-
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  Config::MatchContainer container = LookupMatches (root);
-  container.Set (leaf, value);
+  Config::CompiledPath (path).Set (value);
 }
 void 
 ConfigImpl::ConnectWithoutContext (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  Config::MatchContainer container = LookupMatches (root);
-  container.ConnectWithoutContext (leaf, cb);
+  Config::CompiledPath (path).ConnectWithoutContext (cb);
 }
 void 
 ConfigImpl::DisconnectWithoutContext (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  Config::MatchContainer container = LookupMatches (root);
-  container.DisconnectWithoutContext (leaf, cb);
+  Config::CompiledPath (path).DisconnectWithoutContext (cb);
 }
 void 
 ConfigImpl::Connect (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  Config::MatchContainer container = LookupMatches (root);
-  container.Connect (leaf, cb);
+  Config::CompiledPath (path).Connect (cb);
 }
 void 
 ConfigImpl::Disconnect (std::string path, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << path << &cb);
-
-  std::string root, leaf;
-  ParsePath (path, &root, &leaf);
-  Config::MatchContainer container = LookupMatches (root);
-  container.Disconnect (leaf, cb);
+  Config::CompiledPath (path).Disconnect (cb);
 }
 
 Config::MatchContainer 
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  return Config::CompiledPath (path).LookupMatches ();
+}
+
+Config::MatchContainer 
+ConfigImpl::LookupMatches (const std::vector<struct Config::CompiledPath::Item> &items,
+                           std::string path)
+{
+  NS_LOG_FUNCTION (this << &items << path);
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (const std::vector<struct Config::CompiledPath::Item> &items)
+      : Resolver (items)
     {}
     virtual void DoOne (Ptr<Object> object, std::string path) {
       m_objects.push_back (object);
@@ -693,7 +793,7 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver = LookupMatchesResolver (items);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -746,6 +846,143 @@ ConfigImpl::GetRootNamespaceObject (uint32_t i) const
 
 namespace Config {
 
+CompiledPath::CompiledPath (std::string path)
+  : m_path (path)
+{
+  NS_LOG_FUNCTION (this << path);
+  std::string::size_type slash = path.find_last_of ("/");
+  NS_ASSERT (slash != std::string::npos);
+  m_root = path.substr (0, slash);
+  m_leaf = path.substr (slash+1, path.size ()-(slash+1));
+  m_items = Parse (path);
+  m_rootItems = Parse (m_root);
+}
+
+std::vector<struct CompiledPath::Item>
+CompiledPath::Parse (std::string path)
+{
+  NS_LOG_FUNCTION (path);
+  // ensure that we start and end with a '/'
+  if (path.find ("/") != 0)
+    {
+      path = "/" + path;
+    }
+  if (path.find_last_of ("/") != (path.size () - 1))
+    {
+      path = path + "/";
+    }
+
+  std::vector<struct Item> items;
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = path.find ("/", start)) != std::string::npos)
+    {
+      struct Item item;
+      item.name = path.substr (start, next - start);
+      item.getObject = item.name.find ("$") == 0;
+      item.tidFound = false;
+      if (item.getObject)
+        {
+          item.tidFound = TypeId::LookupByNameFailSafe (item.name.substr (1), &item.tid);
+        }
+      item.anyIndex = false;
+      ParseIndices (item.name, &item);
+      items.push_back (item);
+      start = next + 1;
+    }
+  return items;
+}
+
+void
+CompiledPath::ParseIndices (std::string element, struct Item *item)
+{
+  NS_LOG_FUNCTION (element << item);
+  if (element == "*")
+    {
+      item->anyIndex = true;
+      return;
+    }
+  std::string::size_type tmp;
+  tmp = element.find ("|");
+  if (tmp != std::string::npos)
+    {
+      ParseIndices (element.substr (0, tmp-0), item);
+      ParseIndices (element.substr (tmp+1, element.size () - (tmp + 1)), item);
+      return;
+    }
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
+      dash > leftBracket && dash < rightBracket)
+    {
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
+      uint32_t min;
+      uint32_t max;
+      if (StringToUint32 (lowerBound, &min) &&
+          StringToUint32 (upperBound, &max))
+        {
+          item->indices.push_back (std::make_pair (min, max));
+        }
+      return;
+    }
+  uint32_t value;
+  if (StringToUint32 (element, &value))
+    {
+      item->indices.push_back (std::make_pair (value, value));
+    }
+}
+
+std::string
+CompiledPath::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_path;
+}
+
+MatchContainer
+CompiledPath::LookupMatches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return ConfigImpl::Get ()->LookupMatches (m_items, m_path);
+}
+
+void
+CompiledPath::Set (const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << &value);
+  ConfigImpl::Get ()->LookupMatches (m_rootItems, m_root).Set (m_leaf, value);
+}
+
+void
+CompiledPath::Connect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  ConfigImpl::Get ()->LookupMatches (m_rootItems, m_root).Connect (m_leaf, cb);
+}
+
+void
+CompiledPath::ConnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  ConfigImpl::Get ()->LookupMatches (m_rootItems, m_root).ConnectWithoutContext (m_leaf, cb);
+}
+
+void
+CompiledPath::Disconnect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  ConfigImpl::Get ()->LookupMatches (m_rootItems, m_root).Disconnect (m_leaf, cb);
+}
+
+void
+CompiledPath::DisconnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  ConfigImpl::Get ()->LookupMatches (m_rootItems, m_root).DisconnectWithoutContext (m_leaf, cb);
+}
+
 void Reset (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -21,6 +21,8 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include "type-id.h"
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -258,6 +260,132 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \brief A Config path parsed once, to look up its matches, set
+ * attributes or connect trace sinks repeatedly.
+ *
+ * Config::Set, Config::Connect and the other functions taking a path
+ * parse it on each call.  A CompiledPath splits the path into its
+ * elements, resolves the TypeId of its $ elements and parses its index
+ * lists once; each use then walks the object graph from the root
+ * namespace objects, so that the objects created since the path was
+ * compiled are found.  The walk indexes the containers directly for
+ * the elements which are a single index, such as "/NodeList/12/", and
+ * uses tables of the object and trace source attributes built once per
+ * TypeId.
+ * \code
+ *   Config::CompiledPath path ("/NodeList/" + id + "/DeviceList/0/$ns3::CsmaNetDevice/MacTx");
+ *   path.Connect (MakeCallback (&MacTx));
+ * \endcode
+ */
+class CompiledPath
+{
+public:
+  /**
+   * Construct from a Config path.
+   *
+   * \param [in] path The Config path; the last element names the
+   *             attribute or trace source used by Set, Connect and
+   *             the like.
+   */
+  CompiledPath (std::string path);
+
+  /**
+   * \returns The Config path.
+   */
+  std::string GetPath (void) const;
+
+  /**
+   * \returns A container which contains all the objects which match the
+   *          whole path.
+   * \sa ns3::Config::LookupMatches
+   */
+  MatchContainer LookupMatches (void) const;
+  /**
+   * \param [in] value The value to set to the attribute named by the
+   *             last element of the path.
+   * \sa ns3::Config::Set
+   */
+  void Set (const AttributeValue &value) const;
+  /**
+   * \param [in] cb The sink to connect to the trace source named by the
+   *             last element of the path.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The sink to connect to the trace source named by the
+   *             last element of the path.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The sink to disconnect from the trace source named
+   *             by the last element of the path.
+   * \sa ns3::Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The sink to disconnect from the trace source named
+   *             by the last element of the path.
+   * \sa ns3::Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb) const;
+
+  /** An element of the path, parsed. */
+  struct Item
+  {
+    /** The element, as written in the path. */
+    std::string name;
+    /** \c true if the element is a $TypeId, a call to GetObject. */
+    bool getObject;
+    /** \c true if the TypeId of a $TypeId element is registered. */
+    bool tidFound;
+    /** The TypeId of a $TypeId element. */
+    TypeId tid;
+    /** \c true if the element, as an index, matches all indices. */
+    bool anyIndex;
+    /** The ranges of indices matched by the element, bounds included. */
+    std::vector<std::pair<uint32_t, uint32_t> > indices;
+
+    /**
+     * Test if an index in a container matches the element.
+     *
+     * \param [in] i The index.
+     * \returns \c true if the index matches.
+     */
+    bool Matches (uint32_t i) const;
+  };
+
+private:
+  /**
+   * Split a path into its elements, and parse them.
+   *
+   * \param [in] path The path.
+   * \returns The elements.
+   */
+  static std::vector<struct Item> Parse (std::string path);
+  /**
+   * Parse an element of a path as a list of indices.
+   *
+   * \param [in] element The element, or part of it.
+   * \param [in,out] item The parsed element.
+   */
+  static void ParseIndices (std::string element, struct Item *item);
+
+  /** The Config path. */
+  std::string m_path;
+  /** The path without its last element. */
+  std::string m_root;
+  /** The last element of the path. */
+  std::string m_leaf;
+  /** The elements of the whole path. */
+  std::vector<struct Item> m_items;
+  /** The elements of the path without its last element. */
+  std::vector<struct Item> m_rootItems;
+};
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
@@ -22,13 +22,17 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-batch.h"
 
 #include "ptr.h"
 #include "pointer.h"
 #include "assert.h"
 #include "log.h"
+#include "string.h"
+#include "enum.h"
 
 #include <cmath>
+#include <fstream>
 
 
 /**
@@ -53,6 +57,18 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("ProfileFile",
+                   "The file the profile of the events is written to at "
+                   "Simulator::Destroy, or empty to disable the profiler.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
+    .AddAttribute ("ProfileFormat",
+                   "The format of the profile of the events.",
+                   EnumValue (PROFILE_REPORT),
+                   MakeEnumAccessor (&DefaultSimulatorImpl::m_profileFormat),
+                   MakeEnumChecker (PROFILE_REPORT, "Report",
+                                    PROFILE_FOLDED, "Folded"))
   ;
   return tid;
 }
@@ -70,14 +86,25 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentUid = 0;
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
+  m_eventCount = 0;
   m_unscheduledEvents = 0;
+  m_batchNext = 0;
+  for (uint32_t i = 0; i < RING_SIZE; i++)
+    {
+      m_ring[i].sequence = i;
+    }
+  m_ringEnqueue = 0;
+  m_ringDequeue = 0;
+  m_eventsWithContextOverflow = false;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profiler = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
@@ -86,6 +113,12 @@ DefaultSimulatorImpl::DoDispose (void)
   NS_LOG_FUNCTION (this);
   ProcessEventsWithContext ();
 
+  for (; m_batchNext < m_batch.size (); m_batchNext++)
+    {
+      m_batch[m_batchNext].impl->Unref ();
+    }
+  m_batch.clear ();
+  m_batchNext = 0;
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -108,6 +141,24 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      std::ofstream os (m_profileFile.c_str ());
+      if (!os)
+        {
+          NS_LOG_WARN ("Cannot write the event profile to " << m_profileFile);
+        }
+      else if (m_profileFormat == PROFILE_FOLDED)
+        {
+          m_profiler->ReportFolded (os);
+        }
+      else
+        {
+          m_profiler->Report (os);
+        }
+      delete m_profiler;
+      m_profiler = 0;
+    }
 }
 
 void
@@ -118,6 +169,13 @@ DefaultSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
 
   if (m_events != 0)
     {
+      // the events of the current batch go back to the event list
+      for (; m_batchNext < m_batch.size (); m_batchNext++)
+        {
+          scheduler->Insert (m_batch[m_batchNext]);
+        }
+      m_batch.clear ();
+      m_batchNext = 0;
       while (!m_events->IsEmpty ())
         {
           Scheduler::Event next = m_events->RemoveNext ();
@@ -137,7 +195,16 @@ DefaultSimulatorImpl::GetSystemId (void) const
 void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
-  Scheduler::Event next = m_events->RemoveNext ();
+  if (m_batchNext == m_batch.size ())
+    {
+      // the events scheduled while running the batch come after it, as
+      // their uid is larger, so the batch is run before the event list
+      m_batch.clear ();
+      m_batchNext = 0;
+      m_events->RemoveNextBatch (m_batch);
+    }
+  Scheduler::Event next = m_batch[m_batchNext];
+  m_batchNext++;
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
@@ -146,7 +213,17 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  m_eventCount++;
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      m_profiler->Start (next.impl);
+      next.impl->Invoke ();
+      m_profiler->Stop (m_currentContext);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -155,7 +232,13 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
 bool 
 DefaultSimulatorImpl::IsFinished (void) const
 {
-  return m_events->IsEmpty () || m_stop;
+  return IsEmpty () || m_stop;
+}
+
+bool
+DefaultSimulatorImpl::IsEmpty (void) const
+{
+  return m_batchNext == m_batch.size () && m_events->IsEmpty ();
 }
 
 void
@@ -166,13 +249,43 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
       return;
     }
 
-  // swap queues
+  // clear the flag before looking at the queues: an event published
+  // after this point sets it again and is moved by the next call
+  m_eventsWithContextEmpty = true;
+  __sync_synchronize ();
+
   EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
+  while (true)
+    {
+      struct Slot *slot = &m_ring[m_ringDequeue & (RING_SIZE - 1)];
+      if (slot->sequence != m_ringDequeue + 1)
+        {
+          // empty, or the slot is reserved but not yet written
+          break;
+        }
+      __sync_synchronize ();
+      eventsWithContext.push_back (slot->event);
+      __sync_synchronize ();
+      slot->sequence = m_ringDequeue + RING_SIZE;
+      m_ringDequeue++;
+    }
+  if (m_eventsWithContextOverflow)
+    {
+      if (m_ringDequeue == m_ringEnqueue)
+        {
+          // the overflow list holds the latest events: append them after
+          // those of the ring
+          CriticalSection cs (m_eventsWithContextMutex);
+          eventsWithContext.splice (eventsWithContext.end (), m_eventsWithContext);
+          m_eventsWithContextOverflow = false;
+        }
+      else
+        {
+          // a slot is still being written: its event may precede those
+          // of the list, which are moved by a later call
+          m_eventsWithContextEmpty = false;
+        }
+    }
   while (!eventsWithContext.empty ())
     {
        EventWithContext event = eventsWithContext.front ();
@@ -188,6 +301,49 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
     }
 }
 
+void
+DefaultSimulatorImpl::EnqueueEventWithContext (const struct EventWithContext &ev)
+{
+  if (!m_eventsWithContextOverflow)
+    {
+      uint64_t pos = m_ringEnqueue;
+      while (true)
+        {
+          struct Slot *slot = &m_ring[pos & (RING_SIZE - 1)];
+          int64_t diff = (int64_t)(slot->sequence - pos);
+          if (diff == 0)
+            {
+              uint64_t prev = __sync_val_compare_and_swap (&m_ringEnqueue, pos, pos + 1);
+              if (prev == pos)
+                {
+                  slot->event = ev;
+                  __sync_synchronize ();
+                  slot->sequence = pos + 1;
+                  __sync_synchronize ();
+                  m_eventsWithContextEmpty = false;
+                  return;
+                }
+              pos = prev;
+            }
+          else if (diff < 0)
+            {
+              // the ring is full
+              break;
+            }
+          else
+            {
+              // another producer took the slot
+              pos = m_ringEnqueue;
+            }
+        }
+    }
+  CriticalSection cs (m_eventsWithContextMutex);
+  m_eventsWithContext.push_back (ev);
+  m_eventsWithContextOverflow = true;
+  __sync_synchronize ();
+  m_eventsWithContextEmpty = false;
+}
+
 void
 DefaultSimulatorImpl::Run (void)
 {
@@ -196,15 +352,19 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (!m_profileFile.empty () && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler ();
+    }
 
-  while (!m_events->IsEmpty () && !m_stop) 
+  while (!IsEmpty () && !m_stop) 
     {
       ProcessOneEvent ();
     }
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
-  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+  NS_ASSERT (!IsEmpty () || m_unscheduledEvents == 0);
 }
 
 void 
@@ -269,14 +429,39 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      EnqueueEventWithContext (ev);
     }
 }
 
+void
+DefaultSimulatorImpl::ScheduleBatch (const EventBatch &batch)
+{
+  NS_LOG_FUNCTION (this << &batch);
+
+  if (!SystemThread::Equals (m_main))
+    {
+      // queued one by one in the ring of events from other threads
+      SimulatorImpl::ScheduleBatch (batch);
+      return;
+    }
+  std::vector<Scheduler::Event> events (batch.GetN ());
+  for (uint32_t i = 0; i < batch.GetN (); ++i)
+    {
+      const struct EventBatch::Entry &entry = batch.Get (i);
+      Time tAbsolute = entry.delay + TimeStep (m_currentTs);
+
+      NS_ASSERT (tAbsolute.IsPositive ());
+      NS_ASSERT (tAbsolute >= TimeStep (m_currentTs));
+      events[i].impl = entry.event;
+      events[i].key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+      events[i].key.m_context = entry.context;
+      events[i].key.m_uid = m_uid;
+      m_uid++;
+    }
+  m_unscheduledEvents += events.size ();
+  m_events->InsertBatch (events);
+}
+
 EventId
 DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
 {
@@ -349,7 +534,20 @@ DefaultSimulatorImpl::Remove (const EventId &id)
   event.key.m_ts = id.GetTs ();
   event.key.m_context = id.GetContext ();
   event.key.m_uid = id.GetUid ();
-  m_events->Remove (event);
+  // the event may be in the current batch, already out of the event list
+  std::vector<Scheduler::Event>::iterator i = m_batch.begin () + m_batchNext;
+  while (i != m_batch.end () && i->key.m_uid != event.key.m_uid)
+    {
+      i++;
+    }
+  if (i != m_batch.end ())
+    {
+      m_batch.erase (i);
+    }
+  else
+    {
+      m_events->Remove (event);
+    }
   event.impl->Cancel ();
   // whenever we remove an event from the event list, we have to unref it.
   event.impl->Unref ();
@@ -414,4 +612,10 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
 } // namespace ns3
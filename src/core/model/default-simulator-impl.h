@@ -24,12 +24,15 @@
 #include "simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 #include "system-thread.h"
 #include "ns3/system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <string>
+#include <vector>
 
 /**
  * \file
@@ -43,10 +46,25 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the ProfileFile attribute is set, the wall-clock time and the
+ * number of the events are recorded by an EventProfiler, by event type
+ * and context, and the profile is written to the file at
+ * Simulator::Destroy:
+ * \code
+ *   Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue ("profile.txt"));
+ * \endcode
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
 public:
+  /** The format of the event profile. */
+  enum ProfileFormat
+  {
+    PROFILE_REPORT,     /**< Report sorted by decreasing time. */
+    PROFILE_FOLDED      /**< Folded stacks, the input of the flame graph tools. */
+  };
+
   /**
    *  Register this type.
    *  \return The object TypeId.
@@ -65,6 +83,7 @@ public:
   virtual void Stop (Time const &delay);
   virtual EventId Schedule (Time const &delay, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual void ScheduleBatch (const EventBatch &batch);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
   virtual void Remove (const EventId &id);
@@ -77,12 +96,20 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
 
 private:
   virtual void DoDispose (void);
 
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Check if no event is left to run, neither in the event list nor in
+   * the batch removed from it.
+   *
+   * \returns \c true if no event is left.
+   */
+  bool IsEmpty (void) const;
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
  
@@ -95,16 +122,54 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
-  /** Container type for the events from a different context. */
+  /**
+   * Queue an event from a different thread in the lock-free ring, or in
+   * the overflow list if the ring is full.
+   *
+   * \param [in] ev The event.
+   */
+  void EnqueueEventWithContext (const struct EventWithContext &ev);
+
+  /** Number of slots of the ring, a power of two. */
+  static const uint32_t RING_SIZE = 1024;
+  /** A slot of the ring of events from a different thread. */
+  struct Slot {
+    /**
+     * Sequence number: the enqueue position for which the slot is free,
+     * or that position plus one once the event is written.
+     */
+    volatile uint64_t sequence;
+    /** The event. */
+    struct EventWithContext event;
+  };
+  /**
+   * Bounded ring of events from a different thread, with many producers
+   * and a single consumer, the main thread.  A producer reserves a slot
+   * by advancing m_ringEnqueue with an atomic compare and swap, then
+   * publishes the event by setting the sequence number of the slot.
+   */
+  struct Slot m_ring[RING_SIZE];
+  /** Next enqueue position, shared by the producers. */
+  volatile uint64_t m_ringEnqueue;
+  /** Next dequeue position, only accessed by the main thread. */
+  uint64_t m_ringDequeue;
+
+  /** Container type for the events which did not fit in the ring. */
   typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
+  /** The container of events which did not fit in the ring. */
   EventsWithContext m_eventsWithContext;
+  /**
+   * Flag \c true if events are queued in m_eventsWithContext; the
+   * producers then append to it to keep their events in order.
+   */
+  volatile bool m_eventsWithContextOverflow;
   /**
    * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * primary event queue.  Checked by the main thread after each event,
+   * so that nothing else is done when no event was queued.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
+  volatile bool m_eventsWithContextEmpty;
+  /** Mutex to control access to the overflow list of events with context. */
   SystemMutex m_eventsWithContextMutex;
 
   /** Container type for the events to run at Simulator::Destroy() */
@@ -115,6 +180,13 @@ private:
   bool m_stop;
   /** The event priority queue. */
   Ptr<Scheduler> m_events;
+  /**
+   * The events with the timestamp of the current event, removed
+   * together from the event list, and run in order.
+   */
+  std::vector<Scheduler::Event> m_batch;
+  /** Index in m_batch of the next event to run. */
+  uint32_t m_batchNext;
 
   /** Next event unique id. */
   uint32_t m_uid;
@@ -124,6 +196,8 @@ private:
   uint64_t m_currentTs;
   /** Execution context of the current event. */
   uint32_t m_currentContext;
+  /** The event count. */
+  uint64_t m_eventCount;
   /**
    * Number of events that have been inserted but not yet scheduled,
    *  not counting the Destroy events; this is used for validation
@@ -132,6 +206,13 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** File the event profile is written to, empty to disable the profiler. */
+  std::string m_profileFile;
+  /** Format of the event profile. */
+  enum ProfileFormat m_profileFormat;
+  /** The event profiler, 0 when disabled. */
+  EventProfiler *m_profiler;
 };
 
 } // namespace ns3
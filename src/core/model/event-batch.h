@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_BATCH_H
+#define EVENT_BATCH_H
+
+#include "event-impl.h"
+#include "make-event.h"
+#include "nstime.h"
+#include "non-copyable.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventBatch declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ *
+ * \brief A batch of events, each with its context and delay, to
+ * schedule at once with Simulator::ScheduleBatch.
+ *
+ * A channel which delivers a frame to many receivers at about the same
+ * time adds one event per receiver to a batch, and schedules the batch
+ * with a single insertion in the event list:
+ * \code
+ *   EventBatch batch;
+ *   for (...)
+ *     {
+ *       batch.Add (node->GetId (), delay, &NetDevice::Receive, device, packet->Copy ());
+ *     }
+ *   Simulator::ScheduleBatch (batch);
+ * \endcode
+ *
+ * The batch owns the events until they are scheduled: the events of a
+ * batch destroyed before being scheduled are never run.
+ */
+class EventBatch : private NonCopyable
+{
+public:
+  /** An event of the batch. */
+  struct Entry
+  {
+    uint32_t context;     /**< The context of the event. */
+    Time delay;           /**< The delay until the event expires. */
+    EventImpl *event;     /**< The event. */
+  };
+
+  /** Constructor. */
+  EventBatch ();
+  /** Destructor. */
+  ~EventBatch ();
+
+  /**
+   * Add an event to the batch.
+   *
+   * \param [in] context The context of the event.
+   * \param [in] delay The delay until the event expires.
+   * \param [in] event The event, of which the batch takes ownership.
+   */
+  void Add (uint32_t context, Time const &delay, EventImpl *event);
+  /**
+   * Add an event which calls a member function to the batch.
+   *
+   * \tparam MEM \deduced Class method function signature type.
+   * \tparam OBJ \deduced Class type of the object.
+   * \param [in] context The context of the event.
+   * \param [in] delay The delay until the event expires.
+   * \param [in] mem_ptr Member method pointer to invoke.
+   * \param [in] obj The object on which to invoke the member method.
+   */
+  template <typename MEM, typename OBJ>
+  void Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj);
+  /**
+   * \copybrief Add(uint32_t,Time const&,MEM,OBJ)
+   * \tparam MEM \deduced Class method function signature type.
+   * \tparam OBJ \deduced Class type of the object.
+   * \tparam T1 \deduced Type of first argument.
+   * \param [in] context The context of the event.
+   * \param [in] delay The delay until the event expires.
+   * \param [in] mem_ptr Member method pointer to invoke.
+   * \param [in] obj The object on which to invoke the member method.
+   * \param [in] a1 The first argument to pass to the invoked method.
+   */
+  template <typename MEM, typename OBJ, typename T1>
+  void Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1);
+  /**
+   * \copybrief Add(uint32_t,Time const&,MEM,OBJ)
+   * \tparam MEM \deduced Class method function signature type.
+   * \tparam OBJ \deduced Class type of the object.
+   * \tparam T1 \deduced Type of first argument.
+   * \tparam T2 \deduced Type of second argument.
+   * \param [in] context The context of the event.
+   * \param [in] delay The delay until the event expires.
+   * \param [in] mem_ptr Member method pointer to invoke.
+   * \param [in] obj The object on which to invoke the member method.
+   * \param [in] a1 The first argument to pass to the invoked method.
+   * \param [in] a2 The second argument to pass to the invoked method.
+   */
+  template <typename MEM, typename OBJ, typename T1, typename T2>
+  void Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2);
+  /**
+   * \copybrief Add(uint32_t,Time const&,MEM,OBJ)
+   * \tparam MEM \deduced Class method function signature type.
+   * \tparam OBJ \deduced Class type of the object.
+   * \tparam T1 \deduced Type of first argument.
+   * \tparam T2 \deduced Type of second argument.
+   * \tparam T3 \deduced Type of third argument.
+   * \param [in] context The context of the event.
+   * \param [in] delay The delay until the event expires.
+   * \param [in] mem_ptr Member method pointer to invoke.
+   * \param [in] obj The object on which to invoke the member method.
+   * \param [in] a1 The first argument to pass to the invoked method.
+   * \param [in] a2 The second argument to pass to the invoked method.
+   * \param [in] a3 The third argument to pass to the invoked method.
+   */
+  template <typename MEM, typename OBJ, typename T1, typename T2, typename T3>
+  void Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3);
+
+  /**
+   * Get the number of events in the batch.
+   *
+   * \returns The number of events.
+   */
+  uint32_t GetN (void) const;
+  /**
+   * Get an event of the batch.
+   *
+   * \param [in] i The index of the event, in the order of addition.
+   * \returns The event.
+   */
+  const struct Entry &Get (uint32_t i) const;
+  /**
+   * Empty the batch, without releasing the events, once their
+   * ownership was given to the simulator.
+   */
+  void Release (void);
+
+private:
+  /** The events. */
+  std::vector<struct Entry> m_entries;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename MEM, typename OBJ>
+void
+EventBatch::Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj)
+{
+  Add (context, delay, MakeEvent (mem_ptr, obj));
+}
+
+template <typename MEM, typename OBJ, typename T1>
+void
+EventBatch::Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1)
+{
+  Add (context, delay, MakeEvent (mem_ptr, obj, a1));
+}
+
+template <typename MEM, typename OBJ, typename T1, typename T2>
+void
+EventBatch::Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
+{
+  Add (context, delay, MakeEvent (mem_ptr, obj, a1, a2));
+}
+
+template <typename MEM, typename OBJ, typename T1, typename T2, typename T3>
+void
+EventBatch::Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
+{
+  Add (context, delay, MakeEvent (mem_ptr, obj, a1, a2, a3));
+}
+
+} // namespace ns3
+
+#endif /* EVENT_BATCH_H */
@@ -20,6 +20,8 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include "thread-exit.h"
+#include <new>
 
 /**
  * \file
@@ -31,6 +33,101 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Size granularity of the event pools, in bytes. */
+const std::size_t POOL_GRANULE = 16;
+/** Number of size classes; larger events use the global heap. */
+const uint32_t POOL_CLASSES = 16;
+/** Maximum number of free blocks kept per size class and thread. */
+const uint32_t POOL_MAX_FREE = 4096;
+
+/** A free block of an event pool. */
+struct FreeBlock
+{
+  FreeBlock *next;  /**< Next free block of the same size class. */
+};
+
+#ifdef __GNUC__
+/** The pools are per thread, see ThreadFreeList. */
+#define EVENT_POOL_THREAD __thread
+#else
+/** Without thread local storage, the pools are disabled. */
+#define EVENT_POOL_DISABLED
+#define EVENT_POOL_THREAD
+#endif
+
+/** Free blocks of each size class. */
+EVENT_POOL_THREAD FreeBlock *g_freeBlocks[POOL_CLASSES];
+/** Number of free blocks of each size class. */
+EVENT_POOL_THREAD uint32_t g_nFreeBlocks[POOL_CLASSES];
+#ifndef EVENT_POOL_DISABLED
+/** State of the pools of the thread. */
+EVENT_POOL_THREAD ThreadFreeList g_pools;
+
+/** Free the blocks of the pools of the exiting thread. */
+void
+FreePools (void)
+{
+  for (uint32_t sizeClass = 0; sizeClass < POOL_CLASSES; sizeClass++)
+    {
+      while (g_freeBlocks[sizeClass] != 0)
+        {
+          FreeBlock *block = g_freeBlocks[sizeClass];
+          g_freeBlocks[sizeClass] = block->next;
+          ::operator delete (block);
+        }
+      g_nFreeBlocks[sizeClass] = 0;
+    }
+  g_pools.Destroy ();
+}
+#endif /* EVENT_POOL_DISABLED */
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+#ifndef EVENT_POOL_DISABLED
+  uint32_t sizeClass = (size - 1) / POOL_GRANULE;
+  if (sizeClass < POOL_CLASSES)
+    {
+      FreeBlock *block = g_freeBlocks[sizeClass];
+      if (block != 0)
+        {
+          g_freeBlocks[sizeClass] = block->next;
+          g_nFreeBlocks[sizeClass]--;
+          return block;
+        }
+      // allocate the full block, so that it can hold any event of its class
+      return ::operator new ((sizeClass + 1) * POOL_GRANULE);
+    }
+#endif
+  return ::operator new (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+#ifndef EVENT_POOL_DISABLED
+  uint32_t sizeClass = (size - 1) / POOL_GRANULE;
+  if (sizeClass < POOL_CLASSES && g_nFreeBlocks[sizeClass] < POOL_MAX_FREE
+      && g_pools.Use (&FreePools))
+    {
+      FreeBlock *block = static_cast<FreeBlock *> (p);
+      block->next = g_freeBlocks[sizeClass];
+      g_freeBlocks[sizeClass] = block;
+      g_nFreeBlocks[sizeClass]++;
+      return;
+    }
+#endif
+  ::operator delete (p);
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +163,12 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+const ObjectBase *
+EventImpl::PeekTarget (uintptr_t *function) const
+{
+  NS_LOG_FUNCTION (this << function);
+  *function = 0;
+  return 0;
+}
+
 } // namespace ns3
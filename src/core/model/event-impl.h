@@ -21,6 +21,8 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
+#include <cstring>
 #include "simple-ref-count.h"
 
 /**
@@ -31,6 +33,8 @@
 
 namespace ns3 {
 
+class ObjectBase;
+
 /**
  * \ingroup events
  * \brief A simulation event.
@@ -40,6 +44,11 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * The events, with the arguments they bind, are allocated from per-thread
+ * pools of fixed size blocks (16 bytes granularity, up to 256 bytes),
+ * so that scheduling and running an event does not go through the global
+ * heap once the pools are warm.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -65,6 +74,33 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Get the function called by this event, and the object it is
+   * called on, to tell apart the events of the same C++ type.
+   *
+   * The events made by MakeEvent() know them; other events return 0.
+   *
+   * \param [out] function The address of the function, or the first
+   *              word of the pointer to member function; 0 if unknown.
+   * \returns The object the member function is called on, if it is
+   *          an ObjectBase, else 0.
+   */
+  virtual const ObjectBase *PeekTarget (uintptr_t *function) const;
+
+  /**
+   * Allocate an event from the pool of its size class.
+   *
+   * \param [in] size The size of the event object.
+   * \returns The memory of the event.
+   */
+  static void *operator new (std::size_t size);
+  /**
+   * Return an event to the pool of its size class.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event object.
+   */
+  static void operator delete (void *p, std::size_t size);
 
 protected:
   /**
@@ -75,6 +111,42 @@ protected:
    */
   virtual void Notify (void) = 0;
 
+  /**
+   * Get the first word of a pointer to function or to member function,
+   * for PeekTarget().
+   *
+   * \tparam FN \deduced The type of the pointer.
+   * \param [in] function The pointer.
+   * \returns The first word of the pointer.
+   */
+  template <typename FN>
+  static uintptr_t PeekFunction (FN function)
+  {
+    uintptr_t word = 0;
+    std::memcpy (&word, &function, sizeof (word) < sizeof (function) ? sizeof (word) : sizeof (function));
+    return word;
+  }
+  /**
+   * Get the object a member function is called on, for PeekTarget().
+   *
+   * \param [in] object The object, an ObjectBase.
+   * \returns The object.
+   */
+  static const ObjectBase *PeekObject (const ObjectBase *object)
+  {
+    return object;
+  }
+  /**
+   * Get the object a member function is called on, for PeekTarget().
+   *
+   * \param [in] object The object, not an ObjectBase.
+   * \returns 0.
+   */
+  static const ObjectBase *PeekObject (const void *object)
+  {
+    return 0;
+  }
+
 private:
   bool m_cancel;  /**< Has this event been cancelled. */
 };
@@ -0,0 +1,403 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "object-base.h"
+#include "log.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <cstdlib>
+
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/** Context of the events run outside of any node. */
+const uint32_t NO_CONTEXT = 0xffffffff;
+
+/**
+ * \ingroup simulator
+ * Order the entries by decreasing time.
+ *
+ * \param [in] a The first entry.
+ * \param [in] b The second entry.
+ * \returns \c true if \p a took more time than \p b.
+ */
+template <typename T>
+bool
+MoreTime (const T &a, const T &b)
+{
+  return a.second.ns > b.second.ns;
+}
+
+/**
+ * \ingroup simulator
+ * Get the label of a context.
+ *
+ * \param [in] context The context.
+ * \returns The label.
+ */
+std::string
+GetContextName (uint32_t context)
+{
+  if (context == NO_CONTEXT)
+    {
+      return "no context";
+    }
+  std::ostringstream oss;
+  oss << "node " << context;
+  return oss.str ();
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler ()
+  : m_table (256),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_start.tv_sec = 0;
+  m_start.tv_nsec = 0;
+  m_current.type = 0;
+  m_current.function = 0;
+  m_current.context = 0;
+  m_current.count = 0;
+  m_current.ns = 0;
+  for (std::vector<struct Entry>::iterator i = m_table.begin (); i != m_table.end (); ++i)
+    {
+      i->type = 0;
+    }
+}
+
+struct EventProfiler::Entry *
+EventProfiler::Lookup (const struct Entry &key)
+{
+  uint32_t mask = m_table.size () - 1;
+  uint32_t i = (static_cast<uint32_t> (reinterpret_cast<uintptr_t> (key.type) >> 4)
+                ^ static_cast<uint32_t> (key.function >> 4)
+                ^ (key.tid.GetUid () * 0x85ebca6bU)
+                ^ (key.context * 0x9e3779b1U)) & mask;
+  while (m_table[i].type != 0)
+    {
+      if (m_table[i].type == key.type && m_table[i].function == key.function
+          && m_table[i].tid == key.tid && m_table[i].context == key.context)
+        {
+          return &m_table[i];
+        }
+      i = (i + 1) & mask;
+    }
+  if (2 * (m_size + 1) > m_table.size ())
+    {
+      // keep the table at most half full
+      std::vector<struct Entry> old (2 * m_table.size ());
+      old.swap (m_table);
+      for (std::vector<struct Entry>::iterator j = m_table.begin (); j != m_table.end (); ++j)
+        {
+          j->type = 0;
+        }
+      m_size = 0;
+      for (std::vector<struct Entry>::const_iterator j = old.begin (); j != old.end (); ++j)
+        {
+          if (j->type != 0)
+            {
+              *Lookup (*j) = *j;
+            }
+        }
+      return Lookup (key);
+    }
+  m_size++;
+  m_table[i] = key;
+  m_table[i].count = 0;
+  m_table[i].ns = 0;
+  return &m_table[i];
+}
+
+void
+EventProfiler::GetType (const EventImpl *event, struct Entry *entry)
+{
+  entry->type = &typeid (*event);
+  const ObjectBase *object = event->PeekTarget (&entry->function);
+  entry->tid = object != 0 ? object->GetInstanceTypeId () : TypeId ();
+}
+
+void
+EventProfiler::Start (const EventImpl *event)
+{
+  GetType (event, &m_current);
+  clock_gettime (CLOCK_MONOTONIC, &m_start);
+}
+
+void
+EventProfiler::Stop (uint32_t context)
+{
+  struct timespec end;
+  clock_gettime (CLOCK_MONOTONIC, &end);
+  m_current.context = context;
+  struct Entry *entry = Lookup (m_current);
+  entry->count++;
+  entry->ns += (end.tv_sec - m_start.tv_sec) * 1000000000LL + (end.tv_nsec - m_start.tv_nsec);
+}
+
+uint64_t
+EventProfiler::GetEventCount (void) const
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t count = 0;
+  for (std::vector<struct Entry>::const_iterator i = m_table.begin (); i != m_table.end (); ++i)
+    {
+      if (i->type != 0)
+        {
+          count += i->count;
+        }
+    }
+  return count;
+}
+
+uint64_t
+EventProfiler::GetEventCount (std::string name) const
+{
+  NS_LOG_FUNCTION (this << name);
+  uint64_t count = 0;
+  NamedEntries entries = GetEntries ();
+  for (NamedEntries::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      if (i->first == name)
+        {
+          count += i->second.count;
+        }
+    }
+  return count;
+}
+
+EventProfiler::NamedEntries
+EventProfiler::GetEntries (void) const
+{
+  // the events of several C++ types, such as MakeEvent instances with
+  // different pointers to the same object, may have the same name
+  std::map<std::pair<std::string, uint32_t>, struct Entry> merged;
+  for (std::vector<struct Entry>::const_iterator i = m_table.begin (); i != m_table.end (); ++i)
+    {
+      if (i->type == 0)
+        {
+          continue;
+        }
+      std::pair<std::string, uint32_t> key (GetName (*i), i->context);
+      std::map<std::pair<std::string, uint32_t>, struct Entry>::iterator entry = merged.find (key);
+      if (entry == merged.end ())
+        {
+          merged.insert (std::make_pair (key, *i));
+        }
+      else
+        {
+          entry->second.count += i->count;
+          entry->second.ns += i->ns;
+        }
+    }
+  NamedEntries entries;
+  for (std::map<std::pair<std::string, uint32_t>, struct Entry>::const_iterator i = merged.begin ();
+       i != merged.end (); ++i)
+    {
+      entries.push_back (std::make_pair (i->first.first, i->second));
+    }
+  return entries;
+}
+
+void
+EventProfiler::Report (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  NamedEntries entries = GetEntries ();
+  // sum the contexts of each type
+  std::map<std::string, struct Entry> byType;
+  struct Entry total;
+  total.count = 0;
+  total.ns = 0;
+  for (NamedEntries::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      std::map<std::string, struct Entry>::iterator type = byType.find (i->first);
+      if (type == byType.end ())
+        {
+          type = byType.insert (std::make_pair (i->first, i->second)).first;
+        }
+      else
+        {
+          type->second.count += i->second.count;
+          type->second.ns += i->second.ns;
+        }
+      total.count += i->second.count;
+      total.ns += i->second.ns;
+    }
+  NamedEntries types (byType.begin (), byType.end ());
+  std::stable_sort (types.begin (), types.end (), MoreTime<NamedEntries::value_type>);
+  std::stable_sort (entries.begin (), entries.end (), MoreTime<NamedEntries::value_type>);
+
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << "Events: " << total.count << ", wall-clock time: "
+     << std::fixed << std::setprecision (3) << total.ns / 1e6 << " ms" << std::endl;
+  for (int byContext = 0; byContext < 2; ++byContext)
+    {
+      const NamedEntries &rows = byContext ? entries : types;
+      os << std::endl
+         << std::setw (12) << "Time (ms)" << std::setw (8) << "Share"
+         << std::setw (12) << "Count" << std::setw (12) << "Mean (ns)" << "  "
+         << (byContext ? "Context, event" : "Event") << std::endl;
+      for (NamedEntries::const_iterator i = rows.begin (); i != rows.end (); ++i)
+        {
+          os << std::setw (12) << std::setprecision (3) << i->second.ns / 1e6
+             << std::setw (7) << std::setprecision (1)
+             << (total.ns ? 100.0 * i->second.ns / total.ns : 0.0) << "%"
+             << std::setw (12) << i->second.count
+             << std::setw (12) << std::setprecision (0)
+             << (i->second.count ? double (i->second.ns) / i->second.count : 0.0) << "  ";
+          if (byContext)
+            {
+              os << GetContextName (i->second.context) << ", ";
+            }
+          os << i->first << std::endl;
+        }
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+EventProfiler::ReportFolded (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  NamedEntries entries = GetEntries ();
+  std::stable_sort (entries.begin (), entries.end (), MoreTime<NamedEntries::value_type>);
+  for (NamedEntries::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      os << GetContextName (i->second.context) << ";" << i->first << " " << i->second.ns << std::endl;
+    }
+}
+
+std::string
+EventProfiler::GetName (const EventImpl *event)
+{
+  NS_LOG_FUNCTION (event);
+  struct Entry entry;
+  GetType (event, &entry);
+  return GetName (entry);
+}
+
+std::string
+EventProfiler::GetName (const struct Entry &entry)
+{
+  std::string type = GetTypeName (*entry.type);
+  std::ostringstream oss;
+  oss << type;
+  if (entry.function != 0)
+    {
+#if (__GNUC__ >= 3)
+      // in the Itanium C++ ABI, a pointer to a virtual member function
+      // holds one plus the offset of the function in the virtual table
+      if ((entry.function & 1) != 0 && type.find ("::*") != std::string::npos)
+        {
+          oss << " virtual slot " << (entry.function - 1) / sizeof (void *);
+        }
+      else
+#endif
+        {
+          oss << " at 0x" << std::hex << entry.function << std::dec;
+        }
+    }
+  if (entry.tid != TypeId ())
+    {
+      oss << " on " << entry.tid.GetName ();
+    }
+  return oss.str ();
+}
+
+std::string
+EventProfiler::GetTypeName (const std::type_info &type)
+{
+  NS_LOG_FUNCTION (type.name ());
+  std::string name = type.name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  // the events made by MakeEvent are local classes of its instances: keep
+  // the type of its first parameter, the function called by the event
+  std::string::size_type start = name.find ("MakeEvent");
+  if (start == std::string::npos)
+    {
+      return name;
+    }
+  int depth = 0;
+  for (start += 9; start < name.size (); ++start)
+    {
+      char c = name[start];
+      if (c == '<')
+        {
+          depth++;
+        }
+      else if (c == '>')
+        {
+          depth--;
+        }
+      else if (c == '(' && depth == 0)
+        {
+          break;
+        }
+    }
+  start++;
+  depth = 0;
+  for (std::string::size_type i = start; i < name.size (); ++i)
+    {
+      char c = name[i];
+      if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if ((c == '>' || c == ')') && depth > 0)
+        {
+          depth--;
+        }
+      else if ((c == ',' || c == ')') && depth == 0)
+        {
+          return name.substr (start, i - start);
+        }
+    }
+  return name;
+}
+
+} // namespace ns3
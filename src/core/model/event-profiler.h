@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#include <time.h>
+#include "type-id.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Wall-clock time and count of the events, by event type and
+ * node context.
+ *
+ * The type of an event is the C++ type of its EventImpl, with the
+ * function it calls and the TypeId of the object it calls it on, as
+ * given by EventImpl::PeekTarget.  For the events made by
+ * Simulator::Schedule and MakeEvent, it is named by the type of the
+ * function or member function, its address (or its virtual table slot),
+ * and the TypeId, so that two handlers with the same signature, or the
+ * same handler of two classes, are reported apart.  Recording an event
+ * reads the monotonic clock twice and updates an open addressing hash
+ * table keyed by the type and the context, so that the profiler can be
+ * left enabled on long runs.
+ *
+ * The profile is written either as a report sorted by decreasing time,
+ * by event type and then by event type and context, or in the folded
+ * format of the flame graph tools, one "context;type nanoseconds" line
+ * per entry.
+ */
+class EventProfiler
+{
+public:
+  /** Constructor. */
+  EventProfiler ();
+
+  /**
+   * Start timing an event.
+   *
+   * The type of the event is read now, before the event runs and
+   * maybe destroys the object it is called on.
+   *
+   * \param [in] event The event.
+   */
+  void Start (const EventImpl *event);
+  /**
+   * Stop timing the event, and record it.
+   *
+   * \param [in] context The context of the event.
+   */
+  void Stop (uint32_t context);
+
+  /**
+   * Get the number of events recorded.
+   *
+   * \returns The number of events.
+   */
+  uint64_t GetEventCount (void) const;
+  /**
+   * Get the number of events of a type recorded.
+   *
+   * \param [in] name The name of the type, as in the reports.
+   * \returns The number of events of this type, in all contexts.
+   */
+  uint64_t GetEventCount (std::string name) const;
+
+  /**
+   * Write the profile, sorted by decreasing time.
+   *
+   * \param [in] os The output stream.
+   */
+  void Report (std::ostream &os) const;
+  /**
+   * Write the profile in the folded format of flame graphs.
+   *
+   * \param [in] os The output stream.
+   */
+  void ReportFolded (std::ostream &os) const;
+
+  /**
+   * Get the name of the type of an event.
+   *
+   * \param [in] event The event.
+   * \returns The name of the type of the event, as in the reports.
+   */
+  static std::string GetName (const EventImpl *event);
+
+private:
+  /** The time and count of the events of a type and context. */
+  struct Entry
+  {
+    const std::type_info *type;   /**< The C++ type, 0 if the entry is free. */
+    uintptr_t function;           /**< The function called, 0 if unknown. */
+    TypeId tid;                   /**< The TypeId of the object it is called on. */
+    uint32_t context;             /**< The context. */
+    uint64_t count;               /**< Number of events. */
+    uint64_t ns;                  /**< Wall-clock time, in nanoseconds. */
+  };
+  /** Entries with the name of their type, to write the reports. */
+  typedef std::vector<std::pair<std::string, Entry> > NamedEntries;
+
+  /**
+   * Find the entry of a type and context, creating it if needed.
+   *
+   * \param [in] key The type and context, in an entry.
+   * \returns The entry.
+   */
+  struct Entry *Lookup (const struct Entry &key);
+  /**
+   * Read the type of an event into an entry.
+   *
+   * \param [in] event The event.
+   * \param [out] entry The entry.
+   */
+  static void GetType (const EventImpl *event, struct Entry *entry);
+  /**
+   * Get the name of the type of an entry.
+   *
+   * \param [in] entry The entry.
+   * \returns The name.
+   */
+  static std::string GetName (const struct Entry &entry);
+  /**
+   * Get the name of the C++ type of an event.
+   *
+   * \param [in] type The C++ type of the event.
+   * \returns The type of the function called by the event if it was
+   *          made by MakeEvent, else the name of the type.
+   */
+  static std::string GetTypeName (const std::type_info &type);
+  /**
+   * Get the entries in use, with their name.
+   *
+   * \returns The entries.
+   */
+  NamedEntries GetEntries (void) const;
+
+  /** Start of the current event. */
+  struct timespec m_start;
+  /** Type of the current event. */
+  struct Entry m_current;
+  /** The hash table, with a power of two size. */
+  std::vector<struct Entry> m_table;
+  /** Number of entries in use. */
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
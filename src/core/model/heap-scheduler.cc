@@ -150,10 +150,10 @@ HeapScheduler::IsEmpty (void) const
 }
 
 void
-HeapScheduler::BottomUp (void)
+HeapScheduler::BottomUp (uint32_t start)
 {
-  NS_LOG_FUNCTION (this);
-  uint32_t index = Last ();
+  NS_LOG_FUNCTION (this << start);
+  uint32_t index = start;
   while (!IsRoot (index)
          && IsLessStrictly (index, Parent (index)))
     {
@@ -203,7 +203,36 @@ HeapScheduler::Insert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
   m_heap.push_back (ev);
-  BottomUp ();
+  BottomUp (Last ());
+}
+
+void
+HeapScheduler::InsertBatch (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  uint32_t first = Last () + 1;
+  m_heap.insert (m_heap.end (), events.begin (), events.end ());
+  // sifting up each new event costs up to log2 (n) exchanges, and
+  // rebuilding the whole heap at most 2 n
+  uint32_t depth = 0;
+  for (uint32_t n = Last (); n > 1; n /= 2)
+    {
+      depth++;
+    }
+  if (events.size () * depth > 2 * Last ())
+    {
+      for (uint32_t i = Parent (Last ()); i >= Root (); i--)
+        {
+          TopDown (i);
+        }
+    }
+  else
+    {
+      for (uint32_t i = first; i <= Last (); i++)
+        {
+          BottomUp (i);
+        }
+    }
 }
 
 Scheduler::Event
@@ -236,7 +265,12 @@ HeapScheduler::Remove (const Event &ev)
           NS_ASSERT (m_heap[i].impl == ev.impl);
           Exch (i, Last ());
           m_heap.pop_back ();
-          TopDown (i);
+          // the last event may have to move up as well as down
+          if (i < m_heap.size ())
+            {
+              BottomUp (i);
+              TopDown (i);
+            }
           return;
         }
     }
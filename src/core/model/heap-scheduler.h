@@ -49,6 +49,8 @@ namespace ns3 {
  *    the index of the root is 1.
  *  - It uses a slightly non-standard while loop for top-down heapify
  *    to move one if statement out of the loop.
+ *  - A batch of events which is large relative to the heap is inserted
+ *    by rebuilding the heap bottom-up in linear time.
  */
 class HeapScheduler : public Scheduler
 {
@@ -70,6 +72,7 @@ public:
   virtual Scheduler::Event PeekNext (void) const;
   virtual Scheduler::Event RemoveNext (void);
   virtual void Remove (const Scheduler::Event &ev);
+  virtual void InsertBatch (const std::vector<Scheduler::Event> &events);
 
 private:
   /** Event list type:  vector of Events, managed as a heap. */
@@ -151,8 +154,12 @@ private:
    * \param [in] b The second item.
    */
   inline void Exch (uint32_t a, uint32_t b);
-  /** Percolate a newly inserted Last item to its proper position. */ 
-  void BottomUp (void);
+  /**
+   * Percolate an item up the heap to its proper position.
+   *
+   * \param [in] start Starting entry, the Last one after an insertion.
+   */
+  void BottomUp (uint32_t start);
   /**
    * Percolate a deletion bubble down the heap.
    *
@@ -0,0 +1,294 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+/**
+ * \ingroup scheduler
+ * Order the events of the bottom, the earliest one last.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a is later than \c b
+ */
+static bool
+LaterEvent (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key > b.key;
+}
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung)
+{
+  return rung.start + rung.current * rung.width;
+}
+
+void
+LadderScheduler::SpawnRung (const Bucket &events, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << events.size () << end);
+  NS_ASSERT (!events.empty ());
+  uint64_t min = events.front ().key.m_ts;
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      min = std::min (min, i->key.m_ts);
+    }
+  NS_ASSERT (min < end);
+  // the rung must take every later event up to the end, with about one
+  // event per bucket if they are evenly spread
+  m_rungs.push_back (Rung ());
+  Rung &rung = m_rungs.back ();
+  rung.start = min;
+  rung.width = (end - 1 - min) / events.size () + 1;
+  rung.current = 0;
+  rung.buckets.resize ((end - 1 - min) / rung.width + 1);
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      rung.buckets[(i->key.m_ts - min) / rung.width].push_back (*i);
+    }
+  NS_LOG_LOGIC ("rung " << m_rungs.size () << " start=" << rung.start <<
+                " width=" << rung.width << " buckets=" << rung.buckets.size ());
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev, LaterEvent), ev);
+}
+
+void
+LadderScheduler::TransferTop (void)
+{
+  NS_LOG_FUNCTION (this);
+  Bucket events;
+  events.swap (m_top);
+  if (!m_topRemoved.empty ())
+    {
+      Bucket::iterator end = events.begin ();
+      for (Bucket::iterator i = events.begin (); i != events.end (); ++i)
+        {
+          if (m_topRemoved.find (i->key.m_uid) == m_topRemoved.end ())
+            {
+              *end++ = *i;
+            }
+        }
+      events.erase (end, events.end ());
+      m_topRemoved.clear ();
+    }
+  if (events.empty ())
+    {
+      return;
+    }
+  uint64_t max = 0;
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      max = std::max (max, i->key.m_ts);
+    }
+  SpawnRung (events, max + 1);
+  const Rung &rung = m_rungs.back ();
+  m_topStart = rung.start + rung.buckets.size () * rung.width;
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_bottom.empty ())
+    {
+      if (m_rungs.empty ())
+        {
+          if (m_top.empty ())
+            {
+              return;
+            }
+          TransferTop ();
+          continue;
+        }
+      Rung &rung = m_rungs.back ();
+      while (rung.current < rung.buckets.size () && rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.buckets.size ())
+        {
+          m_rungs.pop_back ();
+          continue;
+        }
+      Bucket events;
+      events.swap (rung.buckets[rung.current]);
+      rung.current++;
+      if (events.size () > THRESHOLD && m_rungs.size () < MAX_RUNGS && rung.width > 1)
+        {
+          // too many events to sort: spread them over a finer rung
+          SpawnRung (events, GetCurrentStart (rung));
+        }
+      else
+        {
+          m_bottom.swap (events);
+          std::sort (m_bottom.begin (), m_bottom.end (), LaterEvent);
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  m_qSize++;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+    }
+  else
+    {
+      std::vector<Rung>::iterator rung;
+      for (rung = m_rungs.begin (); rung != m_rungs.end (); ++rung)
+        {
+          if (ts >= GetCurrentStart (*rung))
+            {
+              rung->buckets[(ts - rung->start) / rung->width].push_back (ev);
+              break;
+            }
+        }
+      if (rung == m_rungs.end ())
+        {
+          InsertBottom (ev);
+          if (m_bottom.size () > THRESHOLD && m_rungs.size () < MAX_RUNGS
+              && m_bottom.front ().key.m_ts > m_bottom.back ().key.m_ts)
+            {
+              Bucket events;
+              events.swap (m_bottom);
+              SpawnRung (events, m_rungs.empty () ? m_topStart : GetCurrentStart (m_rungs.back ()));
+            }
+        }
+    }
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_qSize--;
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  m_qSize--;
+  if (ts >= m_topStart)
+    {
+      // the top is not searched: the event is dropped when it is transferred
+      m_topRemoved.insert (ev.key.m_uid);
+      return;
+    }
+  for (std::vector<Rung>::iterator rung = m_rungs.begin (); rung != m_rungs.end (); ++rung)
+    {
+      if (ts >= GetCurrentStart (*rung))
+        {
+          Bucket &bucket = rung->buckets[(ts - rung->start) / rung->width];
+          for (Bucket::iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              if (i->key.m_uid == ev.key.m_uid)
+                {
+                  *i = bucket.back ();
+                  bucket.pop_back ();
+                  return;
+                }
+            }
+          NS_ASSERT_MSG (false, "Event not found in its bucket");
+        }
+    }
+  Bucket::iterator i = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev, LaterEvent);
+  NS_ASSERT (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid);
+  m_bottom.erase (i);
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+} // namespace ns3
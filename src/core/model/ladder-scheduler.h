@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+#include <set>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and
+ * Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * The events are kept in three tiers:
+ *  - Top: an unsorted vector of the farthest events,
+ *  - Ladder: up to MAX_RUNGS rungs of buckets, each rung spanning one
+ *    bucket of the rung above with a finer bucket width,
+ *  - Bottom: a small sorted vector holding the earliest events.
+ *
+ * An event is appended to the top or to a bucket, or inserted in the
+ * bottom, without sorting. When the bottom is empty, the next non empty
+ * bucket of the lowest rung is moved to it and sorted; a bucket with
+ * more than THRESHOLD events is spread over a new rung instead. The
+ * events are thus sorted only in small batches, close to their time of
+ * execution, which gives an amortized O(1) cost per event whatever
+ * the number of pending events and their time distribution. All the
+ * tiers are stored in contiguous vectors.
+ *
+ * An event removed from the top is only recorded, and dropped when the
+ * top is spread over the ladder.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Maximum number of events sorted at once in the bottom. */
+  static const uint32_t THRESHOLD = 50;
+  /** Maximum number of rungs of the ladder. */
+  static const uint32_t MAX_RUNGS = 8;
+
+  /** A bucket of events, in no particular order. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;                 /**< Time of the start of the first bucket. */
+    uint64_t width;                 /**< Duration of a bucket. */
+    uint32_t current;               /**< Index of the first bucket not yet moved down. */
+    std::vector<Bucket> buckets;    /**< The buckets. */
+  };
+
+  /**
+   * Get the time from which the events go in a rung.
+   *
+   * \param [in] rung The rung.
+   * \returns The time of the start of the current bucket of the rung.
+   */
+  static uint64_t GetCurrentStart (const Rung &rung);
+  /**
+   * Spread events over a new rung at the bottom of the ladder.
+   *
+   * \param [in] events The events, all earlier than \p end.
+   * \param [in] end The time up to which the new rung takes the events,
+   *             the current start of the lowest rung.
+   */
+  void SpawnRung (const Bucket &events, uint64_t end);
+  /**
+   * Insert an event in the sorted bottom.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /**
+   * Move the next events to the bottom, if it is empty.
+   */
+  void Refill (void);
+  /**
+   * Spread the top over the first rung of the ladder.
+   */
+  void TransferTop (void);
+
+  /** The farthest events, not sorted. */
+  Bucket m_top;
+  /** Time from which the events go in the top. */
+  uint64_t m_topStart;
+  /** Uid of the events removed from the top. */
+  std::set<uint32_t> m_topRemoved;
+  /** The rungs, from the coarsest to the finest. */
+  std::vector<Rung> m_rungs;
+  /** The earliest events, sorted by decreasing key. */
+  Bucket m_bottom;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -52,6 +52,11 @@ protected:
     {
       (*m_function)();
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return 0;
+    }
 private:
     F m_function;
   } *ev = new EventFunctionImpl0 (f);
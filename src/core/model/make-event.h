@@ -322,6 +322,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return PeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -352,6 +357,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return PeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -383,6 +393,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return PeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -416,6 +431,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return PeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -451,6 +471,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return PeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -489,6 +514,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return PeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -523,6 +553,11 @@ private:
     {
       (*m_function)(m_a1);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -553,6 +588,11 @@ private:
     {
       (*m_function)(m_a1, m_a2);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -586,6 +626,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -621,6 +666,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -658,6 +708,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const ObjectBase *PeekTarget (uintptr_t *function) const
+    {
+      *function = PeekFunction (m_function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
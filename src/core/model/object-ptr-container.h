@@ -220,6 +220,25 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  /**
+   * Get the number of instances in the container, without building
+   * an ObjectPtrContainerValue.
+   *
+   * \param [in] object The container object.
+   * \param [out] n The number of instances in the container.
+   * \returns true if the value could be obtained successfully.
+   */
+  bool GetItemN (const ObjectBase *object, uint32_t *n) const;
+  /**
+   * Get an instance from the container, by position, without building
+   * an ObjectPtrContainerValue.
+   *
+   * \param [in] object The container object.
+   * \param [in] i The position of the instance, less than GetItemN().
+   * \param [out] index The index of the instance in the container.
+   * \returns The instance.
+   */
+  Ptr<Object> GetItem (const ObjectBase *object, uint32_t i, uint32_t *index) const;
 private:
   /**
    * Get the number of instances in the container.
@@ -99,4 +99,16 @@ uint64_t RngSeedManager::GetNextStreamIndex (void)
   return next;
 }
 
+uint64_t RngSeedManager::PeekNextStreamIndex (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_nextStreamIndex;
+}
+
+void RngSeedManager::SetNextStreamIndex (uint64_t next)
+{
+  NS_LOG_FUNCTION (next);
+  g_nextStreamIndex = next;
+}
+
 } // namespace ns3
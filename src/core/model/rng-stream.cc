@@ -24,6 +24,7 @@
 #include <iostream>
 #include "rng-stream.h"
 #include "fatal-error.h"
+#include "system-mutex.h"
 #include "log.h"
 
 /// \file
@@ -366,7 +367,88 @@ double RngStream::RandU01 ()
   return u;
 }
 
+/**
+ * \ingroup rngimpl
+ * The first and last live streams.
+ */
+static RngStream *g_firstStream = 0;
+/** \copydoc g_firstStream */
+static RngStream *g_lastStream = 0;
+
+/**
+ * \ingroup rngimpl
+ * Get the mutex which protects the list of live streams, which may
+ * be changed by the threads of the multithreaded simulator.
+ *
+ * The mutex is never destroyed, so that the streams destroyed by
+ * static destructors can still unlink themselves.
+ *
+ * \returns The mutex.
+ */
+static SystemMutex &
+GetStreamsMutex (void)
+{
+  static SystemMutex *mutex = new SystemMutex ();
+  return *mutex;
+}
+
 RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
+  : m_stream (stream)
+{
+  Reset (seedNumber, substream);
+  Link ();
+}
+
+RngStream::RngStream(const RngStream& r)
+  : m_stream (r.m_stream)
+{
+  for (int i = 0; i < 6; ++i)
+    {
+      m_currentState[i] = r.m_currentState[i];
+    }
+  Link ();
+}
+
+RngStream::~RngStream ()
+{
+  CriticalSection cs (GetStreamsMutex ());
+  if (m_prev != 0)
+    {
+      m_prev->m_next = m_next;
+    }
+  else
+    {
+      g_firstStream = m_next;
+    }
+  if (m_next != 0)
+    {
+      m_next->m_prev = m_prev;
+    }
+  else
+    {
+      g_lastStream = m_prev;
+    }
+}
+
+void
+RngStream::Link (void)
+{
+  CriticalSection cs (GetStreamsMutex ());
+  m_prev = g_lastStream;
+  m_next = 0;
+  if (g_lastStream != 0)
+    {
+      g_lastStream->m_next = this;
+    }
+  else
+    {
+      g_firstStream = this;
+    }
+  g_lastStream = this;
+}
+
+void
+RngStream::Reset (uint32_t seedNumber, uint64_t substream)
 {
   if (seedNumber >= m1 || seedNumber >= m2 || seedNumber == 0)
     {
@@ -376,18 +458,46 @@ RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
     {
       m_currentState[i] = seedNumber;
     }
-  AdvanceNthBy (stream, 127, m_currentState);
+  AdvanceNthBy (m_stream, 127, m_currentState);
   AdvanceNthBy (substream, 76, m_currentState);
 }
 
-RngStream::RngStream(const RngStream& r)
+uint64_t
+RngStream::GetStream (void) const
+{
+  return m_stream;
+}
+
+void
+RngStream::GetState (uint32_t state[6]) const
 {
   for (int i = 0; i < 6; ++i)
     {
-      m_currentState[i] = r.m_currentState[i];
+      state[i] = static_cast<uint32_t> (m_currentState[i]);
     }
 }
 
+void
+RngStream::SetState (const uint32_t state[6])
+{
+  for (int i = 0; i < 6; ++i)
+    {
+      m_currentState[i] = state[i];
+    }
+}
+
+RngStream *
+RngStream::GetFirst (void)
+{
+  return g_firstStream;
+}
+
+RngStream *
+RngStream::GetNext (void) const
+{
+  return m_next;
+}
+
 void 
 RngStream::AdvanceNthBy (uint64_t nth, int by, double state[6])
 {
@@ -63,6 +63,8 @@ public:
    * \param [in] r The RngStream to copy.
    */
   RngStream (const RngStream & r);
+  /** Destructor. */
+  ~RngStream ();
   /**
    * Generate the next random number for this stream.
    * Uniformly distributed between 0 and 1.
@@ -71,7 +73,64 @@ public:
    */
   double RandU01 (void);
 
+  /**
+   * Restart the stream from the start of a sub-stream.
+   *
+   * \param [in] seed The starting seed.
+   * \param [in] substream The sub-stream number.
+   */
+  void Reset (uint32_t seed, uint64_t substream);
+  /**
+   * Get the stream number.
+   *
+   * \returns The stream number given to the constructor.
+   */
+  uint64_t GetStream (void) const;
+  /**
+   * Get the state of the generator.
+   *
+   * \param [out] state The six components of the state, all integers.
+   */
+  void GetState (uint32_t state[6]) const;
+  /**
+   * Set the state of the generator.
+   *
+   * \param [in] state The six components of the state, as returned
+   *             by GetState.
+   */
+  void SetState (const uint32_t state[6]);
+
+  /**
+   * Get the first live stream.
+   *
+   * All the streams are kept in a list, in the order of their
+   * construction, so that their state can be saved and restored.
+   * Streams may be constructed and destroyed by several threads at
+   * once, but the list must only be walked while no other thread
+   * runs simulation code, e.g. between two runs.
+   *
+   * \returns The oldest stream, or 0 if there is none.
+   */
+  static RngStream *GetFirst (void);
+  /**
+   * Get the next live stream.
+   *
+   * \returns The stream constructed after this one, or 0.
+   */
+  RngStream *GetNext (void) const;
+
 private:
+  /** Append this stream to the list of live streams. */
+  void Link (void);
+  /**
+   * Copy assignment, not implemented: it would break the list of
+   * live streams.
+   *
+   * \param [in] r The RngStream to copy.
+   * \returns The RngStream.
+   */
+  RngStream &operator = (const RngStream &r);
+
   /**
    * Advance \p state of the RNG by leaps and bounds.
    *
@@ -83,6 +142,12 @@ private:
 
   /** The RNG state vector. */
   double m_currentState[6];
+  /** The stream number. */
+  uint64_t m_stream;
+  /** The previous live stream. */
+  RngStream *m_prev;
+  /** The next live stream. */
+  RngStream *m_next;
 };
 
 } // namespace ns3
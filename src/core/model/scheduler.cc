@@ -49,4 +49,27 @@ Scheduler::GetTypeId (void)
   return tid;
 }
 
+void
+Scheduler::InsertBatch (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  for (std::vector<Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      Insert (*i);
+    }
+}
+
+void
+Scheduler::RemoveNextBatch (std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this);
+  Event ev = RemoveNext ();
+  uint64_t ts = ev.key.m_ts;
+  events.push_back (ev);
+  while (!IsEmpty () && PeekNext ().key.m_ts == ts)
+    {
+      events.push_back (RemoveNext ());
+    }
+}
+
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define SCHEDULER_H
 
 #include <stdint.h>
+#include <vector>
 #include "object.h"
 
 /**
@@ -135,6 +136,24 @@ public:
    * \param [in] ev The event to remove
    */
   virtual void Remove (const Event &ev) = 0;
+  /**
+   * Insert several events in the schedule.
+   *
+   * The default implementation inserts the events one by one;
+   * a scheduler can override it to insert them in a single pass.
+   *
+   * \param [in] events The events to store in the event list.
+   */
+  virtual void InsertBatch (const std::vector<Event> &events);
+  /**
+   * Remove all the events with the earliest timestamp.
+   *
+   * This method cannot be invoked if the list is empty.
+   *
+   * \param [out] events The vector the events are appended to,
+   *             in increasing order.
+   */
+  virtual void RemoveNextBatch (std::vector<Event> &events);
 };
 
 /**
@@ -0,0 +1,533 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulation-checkpoint.h"
+#include "rng-stream.h"
+#include "rng-seed-manager.h"
+#include "config.h"
+#include "object.h"
+#include "pointer.h"
+#include "object-ptr-container.h"
+#include "string.h"
+#include "fatal-error.h"
+#include "log.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <map>
+#include <set>
+#include <list>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulationCheckpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulationCheckpoint");
+
+namespace {
+
+/** Magic number at the start of a checkpoint. */
+const char CHECKPOINT_MAGIC[4] = { 'n', 's', '3', 'c' };
+/** Version of the checkpoint format. */
+const uint32_t CHECKPOINT_VERSION = 1;
+
+/** An object of the graph, with its path from a root namespace object. */
+typedef std::pair<std::string, Ptr<Object> > PathObject;
+
+/**
+ * \ingroup simulator
+ * Append an object and the objects it points to, depth first.
+ *
+ * \param [in] object The object.
+ * \param [in] path The path of the object.
+ * \param [in,out] visited The objects already appended.
+ * \param [in,out] objects The objects, in the order of the visit.
+ */
+void
+CollectObjects (Ptr<Object> object, std::string path,
+                std::set<Ptr<Object> > &visited, std::vector<PathObject> &objects)
+{
+  if (!visited.insert (object).second)
+    {
+      return;
+    }
+  objects.push_back (PathObject (path, object));
+  for (TypeId tid = object->GetInstanceTypeId (); tid.HasParent (); tid = tid.GetParent ())
+    {
+      for (uint32_t i = 0; i < tid.GetAttributeN (); ++i)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (!(info.flags & TypeId::ATTR_GET) || !info.accessor->HasGetter ())
+            {
+              continue;
+            }
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              PointerValue ptr;
+              object->GetAttribute (info.name, ptr);
+              Ptr<Object> item = ptr.Get<Object> ();
+              if (item != 0)
+                {
+                  CollectObjects (item, path + "/" + info.name, visited, objects);
+                }
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              ObjectPtrContainerValue container;
+              object->GetAttribute (info.name, container);
+              for (ObjectPtrContainerValue::Iterator it = container.Begin (); it != container.End (); ++it)
+                {
+                  std::ostringstream oss;
+                  oss << path << "/" << info.name << "/" << it->first;
+                  CollectObjects (it->second, oss.str (), visited, objects);
+                }
+            }
+        }
+    }
+  Object::AggregateIterator iter = object->GetAggregateIterator ();
+  while (iter.HasNext ())
+    {
+      Ptr<Object> item = const_cast<Object *> (PeekPointer (iter.Next ()));
+      CollectObjects (item, path + "/$" + item->GetInstanceTypeId ().GetName (), visited, objects);
+    }
+}
+
+/**
+ * \ingroup simulator
+ * Get all the objects reachable from the root namespace objects.
+ *
+ * \returns The objects with their path, in a deterministic order.
+ */
+std::vector<PathObject>
+GetObjects (void)
+{
+  std::set<Ptr<Object> > visited;
+  std::vector<PathObject> objects;
+  for (uint32_t i = 0; i < Config::GetRootNamespaceObjectN (); ++i)
+    {
+      Ptr<Object> root = Config::GetRootNamespaceObject (i);
+      CollectObjects (root, "/$" + root->GetInstanceTypeId ().GetName (), visited, objects);
+    }
+  return objects;
+}
+
+/**
+ * \ingroup simulator
+ * Check if an attribute holds a value which can be saved.
+ *
+ * \param [in] info The attribute.
+ * \returns \c true if the attribute can be read and written, and is
+ *          not an edge of the object graph.
+ */
+bool
+IsSaved (const struct TypeId::AttributeInformation &info)
+{
+  return (info.flags & TypeId::ATTR_GET) && info.accessor->HasGetter ()
+         && (info.flags & TypeId::ATTR_SET) && info.accessor->HasSetter ()
+         && dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) == 0
+         && dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) == 0;
+}
+
+/**
+ * \ingroup simulator
+ * Writer of the checkpoint format.
+ *
+ * The integers are written in base 128, seven bits per byte with the
+ * high bit set on all but the last byte, and the strings are prefixed
+ * by their length.  The names of the types and attributes are written
+ * once, the first time they appear, and then referred to by their index.
+ */
+class CheckpointWriter
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] os The output stream.
+   */
+  CheckpointWriter (std::ostream &os)
+    : m_os (os)
+  {}
+  /**
+   * Write an integer.
+   * \param [in] v The integer.
+   */
+  void WriteU64 (uint64_t v)
+  {
+    while (v >= 0x80)
+      {
+        m_os.put (static_cast<char> ((v & 0x7f) | 0x80));
+        v >>= 7;
+      }
+    m_os.put (static_cast<char> (v));
+  }
+  /**
+   * Write a string.
+   * \param [in] s The string.
+   */
+  void WriteString (const std::string &s)
+  {
+    WriteU64 (s.size ());
+    m_os.write (s.data (), s.size ());
+  }
+  /**
+   * Write a name, by index if already written.
+   * \param [in] s The name.
+   */
+  void WriteName (const std::string &s)
+  {
+    std::map<std::string, uint32_t>::const_iterator i = m_names.find (s);
+    if (i != m_names.end ())
+      {
+        WriteU64 (i->second);
+        return;
+      }
+    uint32_t index = m_names.size ();
+    m_names[s] = index;
+    WriteU64 (index);
+    WriteString (s);
+  }
+private:
+  std::ostream &m_os;                       //!< The output stream.
+  std::map<std::string, uint32_t> m_names;  //!< Index of the names written.
+};
+
+/**
+ * \ingroup simulator
+ * Reader of the checkpoint format.
+ * \see CheckpointWriter
+ */
+class CheckpointReader
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] is The input stream.
+   */
+  CheckpointReader (std::istream &is)
+    : m_is (is)
+  {}
+  /**
+   * Read an integer.
+   * \returns The integer.
+   */
+  uint64_t ReadU64 (void)
+  {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+      {
+        int c = m_is.get ();
+        if (c == EOF)
+          {
+            NS_FATAL_ERROR ("Truncated checkpoint");
+          }
+        v |= static_cast<uint64_t> (c & 0x7f) << shift;
+        if (!(c & 0x80))
+          {
+            return v;
+          }
+      }
+    NS_FATAL_ERROR ("Corrupted checkpoint");
+    return 0;
+  }
+  /**
+   * Read a string.
+   * \returns The string.
+   */
+  std::string ReadString (void)
+  {
+    uint64_t size = ReadU64 ();
+    std::string s (size, '\0');
+    if (size > 0 && !m_is.read (&s[0], size))
+      {
+        NS_FATAL_ERROR ("Truncated checkpoint");
+      }
+    return s;
+  }
+  /**
+   * Read a name.
+   * \returns The name.
+   */
+  std::string ReadName (void)
+  {
+    uint64_t index = ReadU64 ();
+    if (index == m_names.size ())
+      {
+        m_names.push_back (ReadString ());
+      }
+    else if (index > m_names.size ())
+      {
+        NS_FATAL_ERROR ("Corrupted checkpoint");
+      }
+    return m_names[index];
+  }
+private:
+  std::istream &m_is;                  //!< The input stream.
+  std::vector<std::string> m_names;    //!< The names read, by index.
+};
+
+} // unnamed namespace
+
+void
+SimulationCheckpoint::Save (std::ostream &os)
+{
+  NS_LOG_FUNCTION (&os);
+  CheckpointWriter writer (os);
+  os.write (CHECKPOINT_MAGIC, sizeof (CHECKPOINT_MAGIC));
+  writer.WriteU64 (CHECKPOINT_VERSION);
+
+  writer.WriteU64 (RngSeedManager::GetSeed ());
+  writer.WriteU64 (RngSeedManager::GetRun ());
+  writer.WriteU64 (RngSeedManager::PeekNextStreamIndex ());
+  uint64_t nStreams = 0;
+  for (RngStream *stream = RngStream::GetFirst (); stream != 0; stream = stream->GetNext ())
+    {
+      nStreams++;
+    }
+  writer.WriteU64 (nStreams);
+  for (RngStream *stream = RngStream::GetFirst (); stream != 0; stream = stream->GetNext ())
+    {
+      uint32_t state[6];
+      stream->GetState (state);
+      writer.WriteU64 (stream->GetStream ());
+      for (int i = 0; i < 6; ++i)
+        {
+          writer.WriteU64 (state[i]);
+        }
+    }
+
+  std::vector<PathObject> objects = GetObjects ();
+  writer.WriteU64 (objects.size ());
+  for (std::vector<PathObject>::const_iterator i = objects.begin (); i != objects.end (); ++i)
+    {
+      Ptr<Object> object = i->second;
+      writer.WriteString (i->first);
+      writer.WriteName (object->GetInstanceTypeId ().GetName ());
+      std::vector<std::pair<std::string, std::string> > values;
+      for (TypeId tid = object->GetInstanceTypeId (); tid.HasParent (); tid = tid.GetParent ())
+        {
+          for (uint32_t j = 0; j < tid.GetAttributeN (); ++j)
+            {
+              struct TypeId::AttributeInformation info = tid.GetAttribute (j);
+              if (IsSaved (info))
+                {
+                  StringValue value;
+                  object->GetAttribute (info.name, value);
+                  values.push_back (std::make_pair (info.name, value.Get ()));
+                }
+            }
+        }
+      writer.WriteU64 (values.size ());
+      for (uint32_t j = 0; j < values.size (); ++j)
+        {
+          writer.WriteName (values[j].first);
+          writer.WriteString (values[j].second);
+        }
+    }
+  NS_LOG_INFO ("saved " << nStreams << " streams and " << objects.size () << " objects");
+}
+
+void
+SimulationCheckpoint::Save (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+  std::ofstream os (filename.c_str (), std::ios::out | std::ios::binary);
+  if (!os)
+    {
+      NS_FATAL_ERROR ("Cannot open checkpoint file " << filename);
+    }
+  Save (os);
+  os.close ();
+  if (!os)
+    {
+      NS_FATAL_ERROR ("Cannot write checkpoint file " << filename);
+    }
+}
+
+void
+SimulationCheckpoint::Restore (std::istream &is)
+{
+  NS_LOG_FUNCTION (&is);
+  CheckpointReader reader (is);
+  char magic[sizeof (CHECKPOINT_MAGIC)];
+  if (!is.read (magic, sizeof (magic))
+      || std::memcmp (magic, CHECKPOINT_MAGIC, sizeof (magic)) != 0)
+    {
+      NS_FATAL_ERROR ("Not a checkpoint");
+    }
+  uint64_t version = reader.ReadU64 ();
+  if (version != CHECKPOINT_VERSION)
+    {
+      NS_FATAL_ERROR ("Unsupported checkpoint version " << version);
+    }
+
+  RngSeedManager::SetSeed (reader.ReadU64 ());
+  RngSeedManager::SetRun (reader.ReadU64 ());
+  uint64_t nextStreamIndex = reader.ReadU64 ();
+  // states by stream number, in the order of construction
+  std::map<uint64_t, std::list<std::vector<uint32_t> > > states;
+  uint64_t nStreams = reader.ReadU64 ();
+  for (uint64_t i = 0; i < nStreams; ++i)
+    {
+      uint64_t number = reader.ReadU64 ();
+      std::vector<uint32_t> state (6);
+      for (int j = 0; j < 6; ++j)
+        {
+          state[j] = reader.ReadU64 ();
+        }
+      states[number].push_back (state);
+    }
+
+  std::vector<PathObject> objects = GetObjects ();
+  std::map<std::string, Ptr<Object> > byPath (objects.begin (), objects.end ());
+  uint64_t nObjects = reader.ReadU64 ();
+  for (uint64_t i = 0; i < nObjects; ++i)
+    {
+      std::string path = reader.ReadString ();
+      std::string typeName = reader.ReadName ();
+      std::map<std::string, Ptr<Object> >::const_iterator found = byPath.find (path);
+      if (found == byPath.end ())
+        {
+          NS_FATAL_ERROR ("Checkpoint object " << path << " does not exist");
+        }
+      Ptr<Object> object = found->second;
+      if (object->GetInstanceTypeId ().GetName () != typeName)
+        {
+          NS_FATAL_ERROR ("Checkpoint object " << path << " is a " << typeName <<
+                          ", not a " << object->GetInstanceTypeId ().GetName ());
+        }
+      uint64_t nValues = reader.ReadU64 ();
+      for (uint64_t j = 0; j < nValues; ++j)
+        {
+          std::string name = reader.ReadName ();
+          std::string value = reader.ReadString ();
+          StringValue current;
+          object->GetAttribute (name, current);
+          if (current.Get () != value
+              && !object->SetAttributeFailSafe (name, StringValue (value)))
+            {
+              NS_LOG_WARN ("Cannot restore " << path << "/" << name << "=" << value);
+            }
+        }
+    }
+
+  // after the attributes, which may create streams
+  for (RngStream *stream = RngStream::GetFirst (); stream != 0; stream = stream->GetNext ())
+    {
+      std::list<std::vector<uint32_t> > &saved = states[stream->GetStream ()];
+      if (saved.empty ())
+        {
+          NS_LOG_WARN ("No saved state for stream " << stream->GetStream ());
+          continue;
+        }
+      stream->SetState (&saved.front ()[0]);
+      saved.pop_front ();
+    }
+  RngSeedManager::SetNextStreamIndex (nextStreamIndex);
+  NS_LOG_INFO ("restored " << nStreams << " streams and " << nObjects << " objects");
+}
+
+void
+SimulationCheckpoint::Restore (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!is)
+    {
+      NS_FATAL_ERROR ("Cannot open checkpoint file " << filename);
+    }
+  Restore (is);
+}
+
+uint32_t
+SimulationCheckpoint::Branch (uint32_t n, uint32_t parallel)
+{
+  NS_LOG_FUNCTION (n << parallel);
+  NS_ASSERT (parallel > 0);
+  // do not let the branches write the buffered output again
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  std::map<pid_t, uint32_t> running;
+  uint32_t next = 1;
+  while (next <= n || !running.empty ())
+    {
+      if (next <= n && running.size () < parallel)
+        {
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("Cannot fork branch " << next << ": " << std::strerror (errno));
+            }
+          if (pid == 0)
+            {
+              return next;
+            }
+          NS_LOG_LOGIC ("branch " << next << " is process " << pid);
+          running[pid] = next;
+          next++;
+          continue;
+        }
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("Cannot wait for the branches: " << std::strerror (errno));
+        }
+      std::map<pid_t, uint32_t>::iterator i = running.find (pid);
+      if (i == running.end ())
+        {
+          continue;
+        }
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_WARN ("branch " << i->second << " failed");
+        }
+      running.erase (i);
+    }
+  return 0;
+}
+
+void
+SimulationCheckpoint::ResetStreams (uint64_t run)
+{
+  NS_LOG_FUNCTION (run);
+  RngSeedManager::SetRun (run);
+  uint32_t seed = RngSeedManager::GetSeed ();
+  for (RngStream *stream = RngStream::GetFirst (); stream != 0; stream = stream->GetNext ())
+    {
+      stream->Reset (seed, run);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIMULATION_CHECKPOINT_H
+#define SIMULATION_CHECKPOINT_H
+
+#include <stdint.h>
+#include <string>
+#include <iostream>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulationCheckpoint declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Checkpoint a simulation to branch several runs from one state.
+ *
+ * A long simulation often starts with a warm-up, such as the
+ * convergence of the routing protocols or the binding of the DHCP
+ * leases, which a parameter sweep repeats for each of its runs.
+ * Branch() runs the warm-up once: it is called when Simulator::Run
+ * returns at the end of the warm-up, and each branch continues from
+ * there in a child process, a copy of the whole simulation including
+ * the pending events and the object graph.  The branch then sets its
+ * own parameters and random number generator run, and calls
+ * Simulator::Run again.
+ *
+ * \code
+ *   Simulator::Stop (Seconds (3600));
+ *   Simulator::Run ();
+ *   uint32_t branch = SimulationCheckpoint::Branch (100, 8);
+ *   if (branch == 0)
+ *     {
+ *       return 0;  // all the branches are done
+ *     }
+ *   SimulationCheckpoint::ResetStreams (branch);
+ *   Config::Set ("/NodeList/0/...", ...);
+ *   Simulator::Stop (Seconds (7200));
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();
+ * \endcode
+ *
+ * The events are closures bound to the objects of the process and
+ * cannot be written out, so that the whole simulation state only
+ * survives in the branches.  Save() writes the part of the state which
+ * can be rebuilt by another process, in a compact binary format:
+ * the state of each random number stream, and the value of the
+ * attributes of all the objects reachable from the root namespace
+ * objects of Config, such as the NodeList, through the aggregated
+ * objects and the Pointer and ObjectPtrContainer attributes.
+ * Restore() applies it to a process which built the same topology,
+ * for instance to reproduce a branch.
+ */
+class SimulationCheckpoint
+{
+public:
+  /**
+   * Write the random number streams and the attribute values.
+   *
+   * \param [in] os The output stream, opened in binary mode.
+   */
+  static void Save (std::ostream &os);
+  /**
+   * Write the random number streams and the attribute values to a file.
+   *
+   * \param [in] filename The name of the file.
+   */
+  static void Save (std::string filename);
+  /**
+   * Restore the random number streams and the attribute values.
+   *
+   * The objects are matched by their path from the root namespace
+   * objects, and the random number streams by their stream number
+   * and order of construction.  The attributes are only set if their
+   * value differs.
+   *
+   * \param [in] is The input stream, opened in binary mode.
+   */
+  static void Restore (std::istream &is);
+  /**
+   * Restore the random number streams and the attribute values from
+   * a file.
+   *
+   * \param [in] filename The name of the file.
+   */
+  static void Restore (std::string filename);
+  /**
+   * Run branches of the simulation in child processes.
+   *
+   * Must not be called while Simulator::Run is running.  The parent
+   * process waits for the end of all the branches.
+   *
+   * \param [in] n The number of branches.
+   * \param [in] parallel The maximum number of branches run at once.
+   * \returns The index of the branch, from 1 to \p n, in the child
+   *          processes, or 0 in the parent once all the branches exited.
+   */
+  static uint32_t Branch (uint32_t n, uint32_t parallel = 1);
+  /**
+   * Restart all the random number streams from the start of the
+   * sub-stream of a run number.
+   *
+   * The run number of RngSeedManager is set too, for the streams
+   * created later.  A branch calls this with a run number of its own
+   * so that its random numbers are independent of those of the other
+   * branches.
+   *
+   * \param [in] run The run number.
+   */
+  static void ResetStreams (uint64_t run);
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_CHECKPOINT_H */
@@ -18,6 +18,8 @@
  */
 
 #include "simulator-impl.h"
+#include "event-batch.h"
+#include "assert.h"
 #include "log.h"
 
 /**
@@ -42,4 +44,16 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+void
+SimulatorImpl::ScheduleBatch (const EventBatch &batch)
+{
+  NS_LOG_FUNCTION (this << &batch);
+  for (uint32_t i = 0; i < batch.GetN (); ++i)
+    {
+      const struct EventBatch::Entry &entry = batch.Get (i);
+      NS_ASSERT (entry.delay.IsPositive ());
+      ScheduleWithContext (entry.context, entry.delay, entry.event);
+    }
+}
+
 } // namespace ns3
@@ -23,6 +23,7 @@
 #include "scheduler.h"
 #include "map-scheduler.h"
 #include "event-impl.h"
+#include "event-batch.h"
 
 #include "ptr.h"
 #include "string.h"
@@ -251,6 +252,12 @@ Simulator::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *
 {
   return GetImpl ()->ScheduleWithContext (context, delay, impl);
 }
+void
+Simulator::ScheduleBatch (EventBatch &batch)
+{
+  GetImpl ()->ScheduleBatch (batch);
+  batch.Release ();
+}
 EventId
 Simulator::ScheduleDestroy (const Ptr<EventImpl> &ev)
 {
@@ -345,6 +352,12 @@ Simulator::GetContext (void)
   return GetImpl ()->GetContext ();
 }
 
+uint64_t
+Simulator::GetEventCount (void)
+{
+  return GetImpl ()->GetEventCount ();
+}
+
 uint32_t
 Simulator::GetSystemId (void)
 {
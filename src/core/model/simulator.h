@@ -41,6 +41,7 @@ namespace ns3 {
 
 class SimulatorImpl;
 class Scheduler;
+class EventBatch;
 
 /**
  * @ingroup core
@@ -1115,6 +1116,13 @@ public:
    */
   static uint32_t GetContext (void);
 
+  /**
+   * Get the number of events executed so far.
+   *
+   * @return The number of events executed since the start of the simulation
+   */
+  static uint64_t GetEventCount (void);
+
   /**
    * Schedule a future event execution (in the same context).
    *
@@ -1135,6 +1143,18 @@ public:
    */
   static void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
 
+  /**
+   * Schedule a batch of future events, each in its own context,
+   * with a single insertion in the event list.
+   * This method is thread-safe: it can be called from any thread.
+   *
+   * The events of the batch are given to the simulator, and the
+   * batch is left empty.
+   *
+   * @param [in] batch The events to schedule.
+   */
+  static void ScheduleBatch (EventBatch &batch);
+
   /**
    * Schedule an event to run at the end of the simulation, after
    * the Stop() time or condition has been reached.
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "thread-exit.h"
+#include "assert.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <stdint.h>
+#endif
+
+/**
+ * \file
+ * \ingroup thread
+ * ns3::AtThreadExit() and ns3::ThreadFreeList implementations.
+ */
+
+namespace ns3 {
+
+#ifdef HAVE_PTHREAD_H
+
+namespace {
+
+/** Maximum number of functions registered per thread. */
+const uint32_t MAX_HOOKS = 8;
+
+/** Functions registered by the thread. */
+__thread void (*g_hooks[MAX_HOOKS])(void);
+/** Number of functions registered by the thread. */
+__thread uint32_t g_nHooks = 0;
+
+/** Key whose destructor calls the functions of an exiting thread. */
+pthread_key_t g_key;
+/** Creates g_key once. */
+pthread_once_t g_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Call the functions registered by the exiting thread.
+ *
+ * \param [in] value The value of g_key, unused.
+ */
+void
+RunHooks (void *value)
+{
+  // a function may register again, e.g. to empty a cache filled by
+  // another function: pthread then calls this destructor again
+  while (g_nHooks > 0)
+    {
+      g_nHooks--;
+      g_hooks[g_nHooks] ();
+    }
+}
+
+/** Create g_key. */
+void
+CreateKey (void)
+{
+  int error = pthread_key_create (&g_key, &RunHooks);
+  NS_ASSERT_MSG (error == 0, "pthread_key_create failed: " << error);
+}
+
+} // unnamed namespace
+
+void
+AtThreadExit (void (*hook)(void))
+{
+  pthread_once (&g_once, &CreateKey);
+  NS_ASSERT_MSG (g_nHooks < MAX_HOOKS, "Too many thread exit functions");
+  g_hooks[g_nHooks++] = hook;
+  // the destructor of a key is only called for a non-null value
+  pthread_setspecific (g_key, &g_nHooks);
+}
+
+#else /* HAVE_PTHREAD_H */
+
+void
+AtThreadExit (void (*hook)(void))
+{
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+bool
+ThreadFreeList::Register (void (*empty)(void))
+{
+  if (m_state == DESTROYED)
+    {
+      return false;
+    }
+  AtThreadExit (empty);
+  m_state = USED;
+  return true;
+}
+
+} // namespace ns3
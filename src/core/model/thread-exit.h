@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef THREAD_EXIT_H
+#define THREAD_EXIT_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup thread
+ * ns3::AtThreadExit() and ns3::ThreadFreeList declarations.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup thread
+ *
+ * \brief Register a function to call when the calling thread exits.
+ *
+ * This is meant for the per-thread caches of memory blocks, see
+ * ThreadFreeList.  The functions registered by a thread are called in
+ * that thread, in the reverse order of their registration, when it
+ * returns from its start routine or calls pthread_exit.  They are not
+ * called when the process exits.
+ *
+ * Without thread support, this function does nothing.
+ *
+ * \param [in] hook The function to call; a thread may register at
+ *             most eight functions.
+ */
+void AtThreadExit (void (*hook)(void));
+
+/**
+ * \ingroup thread
+ *
+ * \brief The state of a free list of memory blocks owned by a thread.
+ *
+ * The event pools and the free lists of the packet buffers, metadata
+ * and tags are per thread, so that several simulation threads can
+ * create and destroy events and packets at once without locking.  A
+ * thread must then empty its lists itself when it exits, and must not
+ * fill them again afterwards.  This class tracks these steps; it is
+ * declared \c __thread next to the list, and needs no initialization:
+ *
+ * \code
+ *   static __thread ThreadFreeList g_state;
+ *
+ *   void Empty (void)
+ *   {
+ *     // release the blocks of the list of the thread
+ *     g_state.Destroy ();
+ *   }
+ *
+ *   if (g_state.Use (&Empty))
+ *     {
+ *       // put the block in the list of the thread
+ *     }
+ *   else
+ *     {
+ *       // release the block
+ *     }
+ * \endcode
+ *
+ * The lists of the main thread are emptied by static destructors, which
+ * usually call the same function.
+ */
+class ThreadFreeList
+{
+public:
+  /**
+   * Check whether blocks may be put in the list.
+   *
+   * The first call registers \p empty with AtThreadExit().
+   *
+   * \param [in] empty The function which empties the list of the
+   *             calling thread.
+   * \returns \c false once the list was emptied.
+   */
+  bool Use (void (*empty)(void))
+  {
+    return m_state == USED || Register (empty);
+  }
+  /** Record that the list was emptied, and must not be used again. */
+  void Destroy (void)
+  {
+    m_state = DESTROYED;
+  }
+
+private:
+  /** The states of the list. */
+  enum State
+  {
+    UNUSED = 0,  /**< Never used, the initial state. */
+    USED,        /**< Used, and emptied at thread exit. */
+    DESTROYED    /**< Emptied. */
+  };
+  /**
+   * Register the function which empties the list, unless it was
+   * emptied already.
+   *
+   * \param [in] empty The function which empties the list.
+   * \returns \c true if the list may be used.
+   */
+  bool Register (void (*empty)(void));
+
+  /** The State of the list; zero initialized for \c __thread variables. */
+  uint8_t m_state;
+};
+
+} // namespace ns3
+
+#endif /* THREAD_EXIT_H */
@@ -23,7 +23,7 @@
 #include "singleton.h"
 #include "trace-source-accessor.h"
 
-#include <map>
+#include <algorithm>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -51,7 +51,12 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
  * \brief TypeId information manager
  *
  * Information records are stored in a vector.  Name and hash lookup
- * are performed by maps to the vector index.
+ * are performed by open addressing hash tables of indices into the
+ * vector.  Each record also has hash tables of its attributes and
+ * trace sources, including those of its parents, which are updated
+ * when they are added or when the parent changes: looking up an
+ * attribute or a trace source by name is a single probe sequence,
+ * which only reads the tables.
  *
  * \internal
  * <b>Hash Chaining</b>
@@ -256,6 +261,22 @@ public:
    * \returns Detailed information about the requested trace source.
    */
   struct TypeId::TraceSourceInformation GetTraceSource(uint16_t uid, uint32_t i) const;
+  /**
+   * Find an Attribute of a type id or of its parents by name.
+   * \param [in] uid The id.
+   * \param [in] name The Attribute name.
+   * \param [out] info The information about the Attribute, if found.
+   * \returns \c true if the Attribute was found.
+   */
+  bool LookupAttribute (uint16_t uid, const std::string &name,
+                        struct TypeId::AttributeInformation *info) const;
+  /**
+   * Find a TraceSource of a type id or of its parents by name.
+   * \param [in] uid The id.
+   * \param [in] name The TraceSource name.
+   * \returns The TraceSource accessor, or 0 if it was not found.
+   */
+  Ptr<const TraceSourceAccessor> LookupTraceSource (uint16_t uid, const std::string &name) const;
   /**
    * Check if this TypeId should not be listed in documentation.
    * \param [in] uid The id.
@@ -284,6 +305,97 @@ private:
    * \returns The hashed value of \p name.
    */
   static TypeId::hash_t Hasher (const std::string name);
+  /**
+   * Hashing function of the in-memory hash tables.
+   *
+   * Unlike Hasher(), it has no state and can be called from several
+   * threads at once.
+   *
+   * \param [in] name The name of a type id, attribute or trace source.
+   * \returns The hashed value of \p name.
+   */
+  static uint32_t NameHash (const std::string &name);
+  /**
+   * Get the first slot of the probe sequence of a hash.
+   * \param [in] hash The hash.
+   * \param [in] mask The size of the hash table minus one.
+   * \returns The slot.
+   */
+  static uint32_t Slot (uint32_t hash, uint32_t mask);
+
+  /** An entry of a hash table. */
+  struct IndexEntry
+  {
+    /** The hash of the key. */
+    uint32_t hash;
+    /** The type id, 0 if the entry is free. */
+    uint16_t uid;
+    /** The index of the attribute or trace source in \c uid. */
+    uint16_t index;
+  };
+  /**
+   * An open addressing hash table with linear probing.  Its size is zero
+   * or a power of two, and it is kept at most half full.
+   */
+  struct Index
+  {
+    /** The entries. */
+    std::vector<struct IndexEntry> entries;
+    /** The number of entries in use. */
+    uint32_t n;
+    /** Constructor, of an empty table. */
+    Index () : n (0) {}
+  };
+  /** The kind of key of a hash table. */
+  enum IndexKind
+  {
+    BY_NAME,      /**< Type id name. */
+    BY_HASH,      /**< Type id hash. */
+    ATTRIBUTE,    /**< Attribute name. */
+    TRACE_SOURCE  /**< Trace source name. */
+  };
+  /**
+   * Find the entry of a key in a hash table.
+   * \param [in] index The hash table.
+   * \param [in] kind The kind of key of \p index.
+   * \param [in] hash The hash of the key.
+   * \param [in] name The name, unless \p kind is BY_HASH.
+   * \returns The entry, or 0 if the key was not found.
+   */
+  const struct IndexEntry *Find (const struct Index &index, enum IndexKind kind,
+                                 uint32_t hash, const std::string &name) const;
+  /**
+   * Insert an entry in a hash table, unless its key is already there.
+   * \param [in,out] index The hash table.
+   * \param [in] kind The kind of key of \p index.
+   * \param [in] hash The hash of the key.
+   * \param [in] name The name, unless \p kind is BY_HASH.
+   * \param [in] uid The type id.
+   * \param [in] i The index of the attribute or trace source in \p uid.
+   */
+  void Insert (struct Index *index, enum IndexKind kind,
+               uint32_t hash, const std::string &name, uint16_t uid, uint16_t i);
+  /**
+   * Store an entry in the first free slot of its probe sequence.
+   * \param [in,out] entries The hash table, with a free slot.
+   * \param [in] entry The entry.
+   */
+  static void Place (std::vector<struct IndexEntry> *entries, const struct IndexEntry &entry);
+  /**
+   * Rebuild the hash tables of the attributes and trace sources of a
+   * type id and of its children, after its parent changed.
+   * \param [in] uid The id.
+   */
+  void IndexMembers (uint16_t uid);
+  /**
+   * Add a new attribute or trace source to the hash tables of a type
+   * id and of its children.
+   * \param [in] uid The id.
+   * \param [in] kind ATTRIBUTE or TRACE_SOURCE.
+   * \param [in] owner The type id which registered it.
+   * \param [in] i Its index in \p owner.
+   */
+  void IndexMember (uint16_t uid, enum IndexKind kind, uint16_t owner, uint16_t i);
 
   /** The information record about a single type id. */
   struct IidInformation {
@@ -307,6 +419,12 @@ private:
     std::vector<struct TypeId::AttributeInformation> attributes;
     /** The container of TraceSources. */
     std::vector<struct TypeId::TraceSourceInformation> traceSources;
+    /** The type ids of which this one is the parent. */
+    std::vector<uint16_t> children;
+    /** The Attributes of this type id and of its parents, by name. */
+    struct Index attributeIndex;
+    /** The TraceSources of this type id and of its parents, by name. */
+    struct Index traceSourceIndex;
   };
   /** Iterator type. */
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
@@ -321,15 +439,10 @@ private:
   /** The container of all type id records. */
   std::vector<struct IidInformation> m_information;
 
-  /** Type of the by-name index. */
-  typedef std::map<std::string, uint16_t> namemap_t;
   /** The by-name index. */
-  namemap_t m_namemap;
-
-  /** Type of the by-hash index. */
-  typedef std::map<TypeId::hash_t, uint16_t> hashmap_t;
+  struct Index m_namemap;
   /** The by-hash index. */
-  hashmap_t m_hashmap;
+  struct Index m_hashmap;
 
 
   enum {
@@ -351,17 +464,180 @@ IidManager::Hasher (const std::string name)
   static ns3::Hasher hasher ( Create<Hash::Function::Murmur3> () );
   return hasher.clear ().GetHash32 (name);
 }
+
+//static
+uint32_t
+IidManager::NameHash (const std::string &name)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261U;
+  for (std::string::const_iterator i = name.begin (); i != name.end (); ++i)
+    {
+      hash = (hash ^ static_cast<uint8_t> (*i)) * 16777619U;
+    }
+  return hash;
+}
+
+//static
+uint32_t
+IidManager::Slot (uint32_t hash, uint32_t mask)
+{
+  hash *= 0x9e3779b1U;
+  return (hash ^ (hash >> 16)) & mask;
+}
+
+const struct IidManager::IndexEntry *
+IidManager::Find (const struct Index &index, enum IndexKind kind,
+                  uint32_t hash, const std::string &name) const
+{
+  if (index.entries.empty ())
+    {
+      return 0;
+    }
+  uint32_t mask = index.entries.size () - 1;
+  for (uint32_t i = Slot (hash, mask); index.entries[i].uid != 0; i = (i + 1) & mask)
+    {
+      const struct IndexEntry &entry = index.entries[i];
+      if (entry.hash != hash)
+        {
+          continue;
+        }
+      const struct IidInformation &information = m_information[entry.uid - 1];
+      switch (kind)
+        {
+        case BY_NAME:
+          if (information.name == name)
+            {
+              return &entry;
+            }
+          break;
+        case BY_HASH:
+          return &entry;
+        case ATTRIBUTE:
+          if (information.attributes[entry.index].name == name)
+            {
+              return &entry;
+            }
+          break;
+        case TRACE_SOURCE:
+          if (information.traceSources[entry.index].name == name)
+            {
+              return &entry;
+            }
+          break;
+        }
+    }
+  return 0;
+}
+
+//static
+void
+IidManager::Place (std::vector<struct IndexEntry> *entries, const struct IndexEntry &entry)
+{
+  uint32_t mask = entries->size () - 1;
+  uint32_t i = Slot (entry.hash, mask);
+  while ((*entries)[i].uid != 0)
+    {
+      i = (i + 1) & mask;
+    }
+  (*entries)[i] = entry;
+}
+
+void
+IidManager::Insert (struct Index *index, enum IndexKind kind,
+                    uint32_t hash, const std::string &name, uint16_t uid, uint16_t i)
+{
+  if (Find (*index, kind, hash, name) != 0)
+    {
+      return;
+    }
+  if (2 * (index->n + 1) > index->entries.size ())
+    {
+      struct IndexEntry free = { 0, 0, 0 };
+      std::vector<struct IndexEntry> entries (std::max<std::size_t> (8, 2 * index->entries.size ()), free);
+      for (std::vector<struct IndexEntry>::const_iterator j = index->entries.begin ();
+           j != index->entries.end (); ++j)
+        {
+          if (j->uid != 0)
+            {
+              Place (&entries, *j);
+            }
+        }
+      index->entries.swap (entries);
+    }
+  struct IndexEntry entry = { hash, uid, i };
+  Place (&index->entries, entry);
+  index->n++;
+}
+
+void
+IidManager::IndexMembers (uint16_t uid)
+{
+  NS_LOG_FUNCTION (this << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  information->attributeIndex = Index ();
+  information->traceSourceIndex = Index ();
+  // the attributes of the type id shadow those of its parents
+  uint16_t tid = uid;
+  while (true)
+    {
+      const struct IidInformation *ancestor = LookupInformation (tid);
+      for (uint32_t i = 0; i < ancestor->attributes.size (); ++i)
+        {
+          const std::string &name = ancestor->attributes[i].name;
+          Insert (&information->attributeIndex, ATTRIBUTE, NameHash (name), name, tid, i);
+        }
+      for (uint32_t i = 0; i < ancestor->traceSources.size (); ++i)
+        {
+          const std::string &name = ancestor->traceSources[i].name;
+          Insert (&information->traceSourceIndex, TRACE_SOURCE, NameHash (name), name, tid, i);
+        }
+      if (ancestor->parent == 0 || ancestor->parent == tid)
+        {
+          break;
+        }
+      tid = ancestor->parent;
+    }
+  for (std::vector<uint16_t>::const_iterator i = information->children.begin ();
+       i != information->children.end (); ++i)
+    {
+      IndexMembers (*i);
+    }
+}
+
+void
+IidManager::IndexMember (uint16_t uid, enum IndexKind kind, uint16_t owner, uint16_t i)
+{
+  NS_LOG_FUNCTION (this << uid << kind << owner << i);
+  struct IidInformation *information = LookupInformation (uid);
+  const struct IidInformation *ownerInformation = LookupInformation (owner);
+  if (kind == ATTRIBUTE)
+    {
+      const std::string &name = ownerInformation->attributes[i].name;
+      Insert (&information->attributeIndex, kind, NameHash (name), name, owner, i);
+    }
+  else
+    {
+      const std::string &name = ownerInformation->traceSources[i].name;
+      Insert (&information->traceSourceIndex, kind, NameHash (name), name, owner, i);
+    }
+  for (std::vector<uint16_t>::const_iterator j = information->children.begin ();
+       j != information->children.end (); ++j)
+    {
+      IndexMember (*j, kind, owner, i);
+    }
+}
   
 uint16_t
 IidManager::AllocateUid (std::string name)
 {
   NS_LOG_FUNCTION (this << name);
   // Type names are definitive: equal names are equal types
-  NS_ASSERT_MSG (m_namemap.count (name) == 0,
+  NS_ASSERT_MSG (GetUid (name) == 0,
                  "Trying to allocate twice the same uid: " << name);
   
   TypeId::hash_t hash = Hasher (name) & (~HashChainFlag);
-  if (m_hashmap.count (hash) == 1) {
+  if (GetUid (hash) != 0) {
     NS_LOG_ERROR ("Hash chaining TypeId for '" << name << "'.  "
                  << "This is not a bug, but is extremely unlikely.  "
                  << "Please contact the ns3 developers.");
@@ -377,7 +653,7 @@ IidManager::AllocateUid (std::string name)
     //  Oh, by the way, I owe you a beer, since I bet Mathieu that
     //  this would never happen..  -- Peter Barnes, LLNL
 
-    NS_ASSERT_MSG (m_hashmap.count (hash | HashChainFlag) == 0,
+    NS_ASSERT_MSG (GetUid (hash | HashChainFlag) == 0,
                    "Triplicate hash detected while chaining TypeId for '"
                    << name
                    << "'. Please contact the ns3 developers for assistance.");
@@ -397,10 +673,13 @@ IidManager::AllocateUid (std::string name)
     else
       { // chain old type
         NS_LOG_LOGIC ("Old TypeId '" << hinfo->name << "' getting chained.");
-        uint32_t oldUid = GetUid (hinfo->hash);
-        m_hashmap.erase (m_hashmap.find (hinfo->hash));
         hinfo->hash = hash | HashChainFlag;
-        m_hashmap.insert (std::make_pair (hinfo->hash, oldUid));
+        // open addressing tables have no removal: rebuild the by-hash one
+        m_hashmap = Index ();
+        for (uint32_t i = 0; i < m_information.size (); ++i)
+          {
+            Insert (&m_hashmap, BY_HASH, m_information[i].hash, "", i + 1, 0);
+          }
         // leave new hash unchained
       }
   }
@@ -417,9 +696,9 @@ IidManager::AllocateUid (std::string name)
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
 
-  // Add to both maps:
-  m_namemap.insert (std::make_pair (name, uid));
-  m_hashmap.insert (std::make_pair (hash, uid));
+  // Add to both indices:
+  Insert (&m_namemap, BY_NAME, NameHash (name), name, uid, 0);
+  Insert (&m_hashmap, BY_HASH, hash, "", uid, 0);
   return uid;
 }
 
@@ -437,7 +716,17 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_LOG_FUNCTION (this << uid << parent);
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
+  if (information->parent != 0 && information->parent != uid)
+    {
+      std::vector<uint16_t> *children = &LookupInformation (information->parent)->children;
+      children->erase (std::find (children->begin (), children->end (), uid));
+    }
   information->parent = parent;
+  if (parent != 0 && parent != uid)
+    {
+      LookupInformation (parent)->children.push_back (uid);
+    }
+  IndexMembers (uid);
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -478,28 +767,14 @@ uint16_t
 IidManager::GetUid (std::string name) const
 {
   NS_LOG_FUNCTION (this << name);
-  namemap_t::const_iterator it = m_namemap.find (name);
-  if (it != m_namemap.end ())
-    {
-      return it->second;
-    }
-  else
-    {
-      return 0;
-    }
+  const struct IndexEntry *entry = Find (m_namemap, BY_NAME, NameHash (name), name);
+  return entry != 0 ? entry->uid : 0;
 }
 uint16_t 
 IidManager::GetUid (TypeId::hash_t hash) const
 {
-  hashmap_t::const_iterator it = m_hashmap.find (hash);
-  if (it != m_hashmap.end ())
-    {
-    return it->second;
-    }
-  else
-    { // hash not found 
-      return 0;
-    }
+  const struct IndexEntry *entry = Find (m_hashmap, BY_HASH, hash, "");
+  return entry != 0 ? entry->uid : 0;
 }
 std::string 
 IidManager::GetName (uint16_t uid) const
@@ -576,26 +851,7 @@ IidManager::HasAttribute (uint16_t uid,
 {
   NS_LOG_FUNCTION (this << uid << name);
   struct IidInformation *information  = LookupInformation (uid);
-  while (true)
-    {
-      for (std::vector<struct TypeId::AttributeInformation>::const_iterator i = information->attributes.begin ();
-           i != information->attributes.end (); ++i)
-        {
-          if (i->name == name)
-            {
-              return true;
-            }
-        }
-      struct IidInformation *parent = LookupInformation (information->parent);
-      if (parent == information)
-        {
-          // top of inheritance tree
-          return false;
-        }
-      // check parent
-      information = parent;
-    }
-  return false;
+  return Find (information->attributeIndex, ATTRIBUTE, NameHash (name), name) != 0;
 }
 
 void 
@@ -623,6 +879,8 @@ IidManager::AddAttribute (uint16_t uid,
   info.accessor = accessor;
   info.checker = checker;
   information->attributes.push_back (info);
+  NS_ASSERT (information->attributes.size () <= 0xffff);
+  IndexMember (uid, ATTRIBUTE, uid, information->attributes.size () - 1);
 }
 void 
 IidManager::SetAttributeInitialValue(uint16_t uid,
@@ -659,26 +917,7 @@ IidManager::HasTraceSource (uint16_t uid,
 {
   NS_LOG_FUNCTION (this << uid << name);
   struct IidInformation *information  = LookupInformation (uid);
-  while (true)
-    {
-      for (std::vector<struct TypeId::TraceSourceInformation>::const_iterator i = information->traceSources.begin ();
-           i != information->traceSources.end (); ++i)
-        {
-          if (i->name == name)
-            {
-              return true;
-            }
-        }
-      struct IidInformation *parent = LookupInformation (information->parent);
-      if (parent == information)
-        {
-          // top of inheritance tree
-          return false;
-        }
-      // check parent
-      information = parent;
-    }
-  return false;
+  return Find (information->traceSourceIndex, TRACE_SOURCE, NameHash (name), name) != 0;
 }
 
 void 
@@ -701,6 +940,8 @@ IidManager::AddTraceSource (uint16_t uid,
   source.accessor = accessor;
   source.callback = callback;
   information->traceSources.push_back (source);
+  NS_ASSERT (information->traceSources.size () <= 0xffff);
+  IndexMember (uid, TRACE_SOURCE, uid, information->traceSources.size () - 1);
 }
 uint32_t 
 IidManager::GetTraceSourceN (uint16_t uid) const
@@ -717,6 +958,32 @@ IidManager::GetTraceSource(uint16_t uid, uint32_t i) const
   NS_ASSERT (i < information->traceSources.size ());
   return information->traceSources[i];
 }
+bool
+IidManager::LookupAttribute (uint16_t uid, const std::string &name,
+                             struct TypeId::AttributeInformation *info) const
+{
+  NS_LOG_FUNCTION (this << uid << name << info);
+  struct IidInformation *information = LookupInformation (uid);
+  const struct IndexEntry *entry = Find (information->attributeIndex, ATTRIBUTE, NameHash (name), name);
+  if (entry == 0)
+    {
+      return false;
+    }
+  *info = m_information[entry->uid - 1].attributes[entry->index];
+  return true;
+}
+Ptr<const TraceSourceAccessor>
+IidManager::LookupTraceSource (uint16_t uid, const std::string &name) const
+{
+  NS_LOG_FUNCTION (this << uid << name);
+  struct IidInformation *information = LookupInformation (uid);
+  const struct IndexEntry *entry = Find (information->traceSourceIndex, TRACE_SOURCE, NameHash (name), name);
+  if (entry == 0)
+    {
+      return 0;
+    }
+  return m_information[entry->uid - 1].traceSources[entry->index].accessor;
+}
 bool 
 IidManager::MustHideFromDocumentation (uint16_t uid) const
 {
@@ -804,22 +1071,7 @@ bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-          if (tmp.name == name)
-            {
-              *info = tmp;
-              return true;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  return IidManager::Get ()->LookupAttribute (m_tid, name, info);
 }
 
 TypeId 
@@ -1030,21 +1282,7 @@ Ptr<const TraceSourceAccessor>
 TypeId::LookupTraceSourceByName (std::string name) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
-          if (info.name == name)
-            {
-              return info.accessor;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  return IidManager::Get ()->LookupTraceSource (m_tid, name);
 }
 
 uint16_t 
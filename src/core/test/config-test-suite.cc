@@ -721,6 +721,85 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+// ===========================================================================
+// Test for the compiled paths, resolved again on each use.
+// ===========================================================================
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  CompiledPathConfigTestCase ();
+  virtual ~CompiledPathConfigTestCase () {}
+
+  void TraceWithPath (std::string path, int16_t old, int16_t newValue) { m_newValue = newValue; m_path = path; }
+
+private:
+  virtual void DoRun (void);
+
+  int16_t m_newValue;
+  std::string m_path;
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check that compiled paths set and connect the objects created after them")
+{
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> obj0 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj1 = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (obj0);
+  root->AddNodeA (obj1);
+
+  //
+  // A single index is looked up in the container directly.
+  //
+  Config::CompiledPath one ("/NodesA/1/A");
+  one.Set (IntegerValue (1));
+  obj0->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" set on the wrong object");
+  obj1->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 1, "Object Attribute \"A\" not set through a single index");
+
+  //
+  // A compiled path finds the objects added after it was compiled.
+  //
+  Config::CompiledPath all ("/NodesA/*|[5-7]/A");
+  all.Set (IntegerValue (2));
+  Ptr<ConfigTestObject> obj2 = CreateObject<ConfigTestObject> ();
+  root->AddNodeA (obj2);
+  NS_TEST_ASSERT_MSG_EQ (all.LookupMatches ().GetN (), 0, "Attribute matched as an object");
+  all.Set (IntegerValue (3));
+  obj0->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 3, "Object Attribute \"A\" not set through a wildcard");
+  obj2->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 3, "Object Attribute \"A\" not set on a new object");
+
+  Config::CompiledPath objects ("/NodesA/[1-2]");
+  NS_TEST_ASSERT_MSG_EQ (objects.LookupMatches ().GetN (), 2, "Wrong number of objects matched");
+  NS_TEST_ASSERT_MSG_EQ (objects.LookupMatches ().GetMatchedPath (1), "/NodesA/2/", "Wrong matched path");
+
+  //
+  // Connect with the context of each object, several times.
+  //
+  Config::CompiledPath source ("/NodesA/2/Source");
+  source.Connect (MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  m_newValue = 0;
+  obj2->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -3, "Trace did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodesA/2/Source", "Trace did not provide expected context");
+  source.Disconnect (MakeCallback (&CompiledPathConfigTestCase::TraceWithPath, this));
+  m_newValue = 0;
+  obj2->SetAttribute ("Source", IntegerValue (-4));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 0, "Trace fired after being disconnected");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -737,6 +816,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new ObjectVectorConfigTestCase, TestCase::QUICK);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase, TestCase::QUICK);
+  AddTestCase (new CompiledPathConfigTestCase, TestCase::QUICK);
 }
 
 static ConfigTestSuite configTestSuite;
@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/simulation-checkpoint.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/config.h"
+#include "ns3/object.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <sstream>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * Object with attributes, registered as a root namespace object.
+ */
+class CheckpointTestObject : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  uint32_t m_value;
+  double m_rate;
+  Ptr<RandomVariableStream> m_random;
+};
+
+TypeId
+CheckpointTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CheckpointTestObject")
+    .SetParent<Object> ()
+    .HideFromDocumentation ()
+    .AddConstructor<CheckpointTestObject> ()
+    .AddAttribute ("Value", "An integer.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&CheckpointTestObject::m_value),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Rate", "A double.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&CheckpointTestObject::m_rate),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("Random", "A random variable.",
+                   StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=10.0]"),
+                   MakePointerAccessor (&CheckpointTestObject::m_random),
+                   MakePointerChecker<RandomVariableStream> ())
+  ;
+  return tid;
+}
+
+/**
+ * Check that the state of the random number streams is restored.
+ */
+class CheckpointRngTestCase : public TestCase
+{
+public:
+  CheckpointRngTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+CheckpointRngTestCase::CheckpointRngTestCase ()
+  : TestCase ("Check that the random number streams are restored")
+{
+}
+
+void
+CheckpointRngTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> a = CreateObject<UniformRandomVariable> ();
+  Ptr<UniformRandomVariable> b = CreateObject<UniformRandomVariable> ();
+  b->SetStream (7);
+  for (int i = 0; i < 10; ++i)
+    {
+      a->GetValue ();
+    }
+  uint64_t next = RngSeedManager::PeekNextStreamIndex ();
+
+  std::stringstream checkpoint;
+  SimulationCheckpoint::Save (checkpoint);
+  double expected[4];
+  for (int i = 0; i < 4; ++i)
+    {
+      expected[i] = (i % 2) ? a->GetValue () : b->GetValue ();
+    }
+  Ptr<UniformRandomVariable> c = CreateObject<UniformRandomVariable> ();
+
+  checkpoint.seekg (0);
+  SimulationCheckpoint::Restore (checkpoint);
+  for (int i = 0; i < 4; ++i)
+    {
+      double value = (i % 2) ? a->GetValue () : b->GetValue ();
+      NS_TEST_EXPECT_MSG_EQ (value, expected[i], "Stream state not restored");
+    }
+  NS_TEST_EXPECT_MSG_EQ (RngSeedManager::PeekNextStreamIndex (), next, "Stream index not restored");
+}
+
+/**
+ * Check that the attribute values of the object graph are restored.
+ */
+class CheckpointAttributeTestCase : public TestCase
+{
+public:
+  CheckpointAttributeTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+CheckpointAttributeTestCase::CheckpointAttributeTestCase ()
+  : TestCase ("Check that the attribute values are restored")
+{
+}
+
+void
+CheckpointAttributeTestCase::DoRun (void)
+{
+  Ptr<CheckpointTestObject> object = CreateObject<CheckpointTestObject> ();
+  Config::RegisterRootNamespaceObject (object);
+  object->SetAttribute ("Value", UintegerValue (42));
+
+  std::stringstream checkpoint;
+  SimulationCheckpoint::Save (checkpoint);
+  object->SetAttribute ("Value", UintegerValue (7));
+  object->SetAttribute ("Rate", DoubleValue (2.5));
+  object->m_random->SetAttribute ("Max", DoubleValue (20.0));
+
+  checkpoint.seekg (0);
+  SimulationCheckpoint::Restore (checkpoint);
+  NS_TEST_EXPECT_MSG_EQ (object->m_value, 42, "Attribute not restored");
+  NS_TEST_EXPECT_MSG_EQ (object->m_rate, 0.5, "Attribute not restored");
+  DoubleValue max;
+  object->m_random->GetAttribute ("Max", max);
+  NS_TEST_EXPECT_MSG_EQ (max.Get (), 10.0, "Attribute of a pointed object not restored");
+  Config::UnregisterRootNamespaceObject (object);
+}
+
+/**
+ * Check that the branches continue the simulation from the same state.
+ */
+class CheckpointBranchTestCase : public TestCase
+{
+public:
+  CheckpointBranchTestCase ();
+  void Tick (void);
+  uint32_t m_ticks;
+private:
+  virtual void DoRun (void);
+  /** What a branch reports through the pipe. */
+  struct BranchResult
+  {
+    uint32_t branch;
+    uint32_t ticks;
+    double value;
+  };
+};
+
+CheckpointBranchTestCase::CheckpointBranchTestCase ()
+  : TestCase ("Check that the branches continue from the checkpoint")
+{
+}
+
+void
+CheckpointBranchTestCase::Tick (void)
+{
+  m_ticks++;
+  Simulator::Schedule (Seconds (1), &CheckpointBranchTestCase::Tick, this);
+}
+
+void
+CheckpointBranchTestCase::DoRun (void)
+{
+  int fds[2];
+  NS_TEST_ASSERT_MSG_EQ (pipe (fds), 0, "Cannot create a pipe");
+  m_ticks = 0;
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  Simulator::Schedule (Seconds (0), &CheckpointBranchTestCase::Tick, this);
+  Simulator::Stop (Seconds (10.5));
+  Simulator::Run ();
+
+  uint32_t branch = SimulationCheckpoint::Branch (3, 2);
+  if (branch != 0)
+    {
+      // each branch continues the pending events, with its own
+      // random numbers
+      SimulationCheckpoint::ResetStreams (branch);
+      Simulator::Stop (Seconds (branch));
+      Simulator::Run ();
+      struct BranchResult result;
+      result.branch = branch;
+      result.ticks = m_ticks;
+      result.value = random->GetValue ();
+      // a single write, not interleaved with those of the other branches
+      ssize_t written = write (fds[1], &result, sizeof (result));
+      _exit (written == sizeof (result) ? 0 : 1);
+    }
+  close (fds[1]);
+  Simulator::Destroy ();
+
+  double values[4];
+  uint32_t seen = 0;
+  struct BranchResult result;
+  while (read (fds[0], &result, sizeof (result)) == sizeof (result))
+    {
+      NS_TEST_EXPECT_MSG_EQ (result.ticks, 11 + result.branch, "Branch did not continue the events");
+      NS_TEST_EXPECT_MSG_EQ ((seen & (1 << result.branch)), 0, "Branch run twice");
+      seen |= 1 << result.branch;
+      values[result.branch] = result.value;
+    }
+  close (fds[0]);
+  NS_TEST_ASSERT_MSG_EQ (seen, 0xe, "Missing branches");
+  NS_TEST_EXPECT_MSG_NE (values[1], values[2], "Branches share their random numbers");
+  NS_TEST_EXPECT_MSG_NE (values[2], values[3], "Branches share their random numbers");
+}
+
+/**
+ * The simulation checkpoint test suite.
+ */
+class SimulationCheckpointTestSuite : public TestSuite
+{
+public:
+  SimulationCheckpointTestSuite ()
+    : TestSuite ("simulation-checkpoint")
+  {
+    AddTestCase (new CheckpointRngTestCase, TestCase::QUICK);
+    AddTestCase (new CheckpointAttributeTestCase, TestCase::QUICK);
+    AddTestCase (new CheckpointBranchTestCase, TestCase::QUICK);
+  }
+} g_simulationCheckpointTestSuite;
@@ -23,6 +23,17 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/event-profiler.h"
+#include "ns3/event-batch.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/default-simulator-impl.h"
+#include <set>
+#include <fstream>
+#include <sstream>
 
 using namespace ns3;
 
@@ -459,6 +470,442 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  Scheduler::Event MakeEvent (uint64_t ts);
+  static void Nothing (void);
+  uint32_t m_uid;
+  std::vector<Ptr<EventImpl> > m_impls;
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of many events against ns3::MapScheduler with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_uid (0),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+Scheduler::Event
+SchedulerOrderTestCase::MakeEvent (uint64_t ts)
+{
+  // some schedulers check the implementation of the removed events
+  m_impls.push_back (Ptr<EventImpl> (ns3::MakeEvent (&SchedulerOrderTestCase::Nothing), false));
+  Scheduler::Event ev;
+  ev.impl = PeekPointer (m_impls.back ());
+  ev.key.m_ts = ts;
+  ev.key.m_uid = m_uid++;
+  ev.key.m_context = 0;
+  return ev;
+}
+
+void
+SchedulerOrderTestCase::Nothing (void)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+
+  // a mix of far, near and simultaneous events, some of them removed
+  std::vector<Scheduler::Event> pending;
+  std::set<uint32_t> executed;
+  uint64_t now = 0;
+  for (uint32_t i = 0; i < 40000; i++)
+    {
+      uint32_t action = rand->GetInteger (0, 9);
+      if (action < 5 || reference->IsEmpty ())
+        {
+          uint64_t delay;
+          switch (action % 3)
+            {
+            case 0:
+              delay = rand->GetInteger (0, 1000000000);
+              break;
+            case 1:
+              delay = rand->GetInteger (0, 1000);
+              break;
+            default:
+              delay = 0;
+              break;
+            }
+          Scheduler::Event ev = MakeEvent (now + delay);
+          scheduler->Insert (ev);
+          reference->Insert (ev);
+          pending.push_back (ev);
+        }
+      else if (action < 7 && !pending.empty ())
+        {
+          uint32_t index = rand->GetInteger (0, pending.size () - 1);
+          Scheduler::Event ev = pending[index];
+          pending[index] = pending.back ();
+          pending.pop_back ();
+          if (executed.find (ev.key.m_uid) == executed.end ())
+            {
+              scheduler->Remove (ev);
+              reference->Remove (ev);
+            }
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ (scheduler->PeekNext ().key.m_uid, reference->PeekNext ().key.m_uid, "Wrong next event");
+          Scheduler::Event ev = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, reference->RemoveNext ().key.m_uid, "Wrong event removed");
+          executed.insert (ev.key.m_uid);
+          now = ev.key.m_ts;
+        }
+    }
+  while (!reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "Scheduler empty too early");
+      NS_TEST_ASSERT_MSG_EQ (scheduler->RemoveNext ().key.m_uid, reference->RemoveNext ().key.m_uid, "Wrong event removed");
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "Scheduler not empty");
+  m_impls.clear ();
+}
+
+class SchedulerBatchTestCase : public TestCase
+{
+public:
+  SchedulerBatchTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  static void Nothing (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerBatchTestCase::SchedulerBatchTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the batches of events against ns3::MapScheduler with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SchedulerBatchTestCase::Nothing (void)
+{
+}
+
+void
+SchedulerBatchTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (2);
+  Ptr<EventImpl> impl = Ptr<EventImpl> (MakeEvent (&SchedulerBatchTestCase::Nothing), false);
+
+  // batches both small and large relative to the pending events, with
+  // many simultaneous events
+  uint32_t uid = 0;
+  uint64_t now = 0;
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      std::vector<Scheduler::Event> batch (rand->GetInteger (1, i % 10 ? 20 : 2000));
+      for (std::vector<Scheduler::Event>::iterator ev = batch.begin (); ev != batch.end (); ++ev)
+        {
+          ev->impl = PeekPointer (impl);
+          ev->key.m_ts = now + rand->GetInteger (0, 100);
+          ev->key.m_uid = uid++;
+          ev->key.m_context = 0;
+          reference->Insert (*ev);
+        }
+      scheduler->InsertBatch (batch);
+
+      std::vector<Scheduler::Event> next;
+      scheduler->RemoveNextBatch (next);
+      NS_TEST_ASSERT_MSG_EQ (next.empty (), false, "Empty batch removed");
+      for (std::vector<Scheduler::Event>::const_iterator ev = next.begin (); ev != next.end (); ++ev)
+        {
+          NS_TEST_ASSERT_MSG_EQ (ev->key.m_ts, next.front ().key.m_ts, "Events of different times removed");
+          NS_TEST_ASSERT_MSG_EQ (ev->key.m_uid, reference->RemoveNext ().key.m_uid, "Wrong event removed");
+        }
+      NS_TEST_ASSERT_MSG_EQ ((!reference->IsEmpty () && reference->PeekNext ().key.m_ts == next.front ().key.m_ts),
+                             false, "Simultaneous event left out of the batch");
+      now = next.front ().key.m_ts;
+    }
+  while (!reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->RemoveNext ().key.m_uid, reference->RemoveNext ().key.m_uid, "Wrong event removed");
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "Scheduler not empty");
+}
+
+class SimulatorBatchTestCase : public TestCase
+{
+public:
+  SimulatorBatchTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Record (uint32_t tag);
+  void RemoveLater (uint32_t tag);
+  ObjectFactory m_schedulerFactory;
+  std::vector<uint32_t> m_tags;
+  std::vector<Time> m_times;
+  EventId m_later;
+};
+
+SimulatorBatchTestCase::SimulatorBatchTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check Simulator::ScheduleBatch with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorBatchTestCase::Record (uint32_t tag)
+{
+  if (tag < 10)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), tag, "Wrong context");
+    }
+  m_tags.push_back (tag);
+  m_times.push_back (Simulator::Now ());
+}
+
+void
+SimulatorBatchTestCase::RemoveLater (uint32_t tag)
+{
+  Record (tag);
+  // both events are already out of the event list, in the batch of the
+  // current time
+  Simulator::Remove (m_later);
+  Simulator::ScheduleNow (&SimulatorBatchTestCase::Record, this, 13);
+}
+
+void
+SimulatorBatchTestCase::DoRun (void)
+{
+  Simulator::SetScheduler (m_schedulerFactory);
+  {
+    EventBatch batch;
+    batch.Add (0, MicroSeconds (10), &SimulatorBatchTestCase::Record, this, 0);
+    batch.Add (1, MicroSeconds (5), &SimulatorBatchTestCase::Record, this, 1);
+    batch.Add (2, MicroSeconds (10), &SimulatorBatchTestCase::Record, this, 2);
+    batch.Add (3, MicroSeconds (5), &SimulatorBatchTestCase::Record, this, 3);
+    Simulator::ScheduleBatch (batch);
+    NS_TEST_EXPECT_MSG_EQ (batch.GetN (), 0, "Batch not released");
+  }
+  {
+    // never scheduled: released without being run
+    EventBatch batch;
+    batch.Add (4, MicroSeconds (1), &SimulatorBatchTestCase::Record, this, 4);
+  }
+  Simulator::Schedule (MicroSeconds (20), &SimulatorBatchTestCase::RemoveLater, this, 10);
+  Simulator::Schedule (MicroSeconds (20), &SimulatorBatchTestCase::Record, this, 11);
+  m_later = Simulator::Schedule (MicroSeconds (20), &SimulatorBatchTestCase::Record, this, 12);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  uint32_t tags[] = { 1, 3, 0, 2, 10, 11, 13 };
+  uint32_t times[] = { 5, 5, 10, 10, 20, 20, 20 };
+  NS_TEST_ASSERT_MSG_EQ (m_tags.size (), 7, "Wrong number of events run");
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_tags[i], tags[i], "Wrong order of the events");
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], MicroSeconds (times[i]), "Wrong time of the events");
+    }
+}
+
+class EventPoolTestCase : public TestCase
+{
+public:
+  EventPoolTestCase ();
+  virtual void DoRun (void);
+  void Event1 (uint64_t a);
+  void Event3 (uint64_t a, uint64_t b, uint64_t c);
+  uint64_t m_sum;
+};
+
+EventPoolTestCase::EventPoolTestCase ()
+  : TestCase ("Check that the events are recycled by their pool"),
+    m_sum (0)
+{
+}
+
+void
+EventPoolTestCase::Event1 (uint64_t a)
+{
+  m_sum += a;
+}
+
+void
+EventPoolTestCase::Event3 (uint64_t a, uint64_t b, uint64_t c)
+{
+  m_sum += a + b + c;
+}
+
+void
+EventPoolTestCase::DoRun (void)
+{
+  EventImpl *event = MakeEvent (&EventPoolTestCase::Event1, this, 1);
+  EventImpl *first = event;
+  event->Unref ();
+  event = MakeEvent (&EventPoolTestCase::Event1, this, 2);
+  NS_TEST_ASSERT_MSG_EQ (event, first, "Event not recycled");
+  event->Invoke ();
+  event->Unref ();
+  NS_TEST_ASSERT_MSG_EQ (m_sum, 2, "Wrong argument of a recycled event");
+
+  // events of different sizes through the simulator
+  m_sum = 0;
+  for (uint64_t i = 0; i < 1000; i++)
+    {
+      Simulator::Schedule (NanoSeconds (i), &EventPoolTestCase::Event1, this, i);
+      EventId id = Simulator::Schedule (NanoSeconds (i), &EventPoolTestCase::Event3, this, i, i, i);
+      if (i % 2 == 0)
+        {
+          Simulator::Cancel (id);
+        }
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_sum, 999 * 1000 / 2 + 3 * 500 * 500, "Wrong events run");
+}
+
+class EventProfilerTestCase : public TestCase
+{
+public:
+  EventProfilerTestCase ();
+  virtual void DoRun (void);
+  void EventA (uint32_t a);
+  void EventB (void);
+  void EventC (void);
+  std::string ReadFile (std::string filename);
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check the profile of the events by type and context")
+{
+}
+
+void
+EventProfilerTestCase::EventA (uint32_t a)
+{
+}
+
+void
+EventProfilerTestCase::EventB (void)
+{
+}
+
+void
+EventProfilerTestCase::EventC (void)
+{
+}
+
+std::string
+EventProfilerTestCase::ReadFile (std::string filename)
+{
+  std::ifstream is (filename.c_str ());
+  std::ostringstream oss;
+  oss << is.rdbuf ();
+  return oss.str ();
+}
+
+void
+EventProfilerTestCase::DoRun (void)
+{
+  EventImpl *event = MakeEvent (&EventProfilerTestCase::EventA, this, 1);
+  std::string nameA = EventProfiler::GetName (event);
+  event->Unref ();
+  NS_TEST_ASSERT_MSG_EQ (nameA.find ("void (EventProfilerTestCase::*)(unsigned int) at 0x"), 0,
+                         "Wrong name of a member function event " << nameA);
+  event = MakeEvent (&EventProfilerTestCase::EventB, this);
+  std::string nameB = EventProfiler::GetName (event);
+  event->Unref ();
+  event = MakeEvent (&EventProfilerTestCase::EventC, this);
+  std::string nameC = EventProfiler::GetName (event);
+  event->Unref ();
+  NS_TEST_ASSERT_MSG_NE (nameB, nameC, "Same name of two functions with the same signature");
+
+  // counts by type, with two functions of the same signature
+  EventProfiler profiler;
+  event = MakeEvent (&EventProfilerTestCase::EventA, this, 1);
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      profiler.Start (event);
+      profiler.Stop (i);
+    }
+  event->Unref ();
+  event = MakeEvent (&EventProfilerTestCase::EventC, this);
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      profiler.Start (event);
+      profiler.Stop (i);
+    }
+  event->Unref ();
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetEventCount (), 5, "Wrong number of events");
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetEventCount (nameA), 3, "Wrong number of events of a type");
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetEventCount (nameB), 0, "Wrong number of events of a type");
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetEventCount (nameC), 2, "Wrong number of events of a type");
+
+  // the same member function, called on objects of two TypeIds
+  Ptr<Object> object = CreateObject<Object> ();
+  Ptr<Object> scheduler = CreateObject<ListScheduler> ();
+  EventImpl *objectEvent = MakeEvent (&Object::Dispose, object);
+  EventImpl *schedulerEvent = MakeEvent (&Object::Dispose, scheduler);
+  NS_TEST_ASSERT_MSG_EQ ((typeid (*objectEvent) == typeid (*schedulerEvent)), true,
+                         "Events of different C++ types");
+  std::string nameObject = EventProfiler::GetName (objectEvent);
+  std::string nameScheduler = EventProfiler::GetName (schedulerEvent);
+  NS_TEST_EXPECT_MSG_EQ (nameObject.substr (nameObject.size () - 15), " on ns3::Object",
+                         "Wrong TypeId in the name " << nameObject);
+  NS_TEST_EXPECT_MSG_EQ (nameScheduler.substr (nameScheduler.size () - 22), " on ns3::ListScheduler",
+                         "Wrong TypeId in the name " << nameScheduler);
+  profiler.Start (schedulerEvent);
+  profiler.Stop (0);
+  objectEvent->Unref ();
+  schedulerEvent->Unref ();
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetEventCount (nameObject), 0, "Wrong number of events of a TypeId");
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetEventCount (nameScheduler), 1, "Wrong number of events of a TypeId");
+
+  // report of a simulation, in both formats
+  std::string filename = CreateTempDirFilename ("event-profile");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (filename));
+  for (int folded = 0; folded < 2; ++folded)
+    {
+      Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFormat",
+                          EnumValue (folded ? DefaultSimulatorImpl::PROFILE_FOLDED :
+                                     DefaultSimulatorImpl::PROFILE_REPORT));
+      for (uint32_t i = 0; i < 10; ++i)
+        {
+          Simulator::ScheduleWithContext (1, MicroSeconds (i), &EventProfilerTestCase::EventA, this, i);
+        }
+      for (uint32_t i = 0; i < 5; ++i)
+        {
+          Simulator::Schedule (MicroSeconds (i), &EventProfilerTestCase::EventB, this);
+        }
+      Simulator::Run ();
+      Simulator::Destroy ();
+      std::string profile = ReadFile (filename);
+      if (folded)
+        {
+          NS_TEST_EXPECT_MSG_NE (profile.find ("node 1;" + nameA + " "), std::string::npos,
+                                 "Missing folded entry");
+          NS_TEST_EXPECT_MSG_NE (profile.find ("no context;" + nameB + " "), std::string::npos,
+                                 "Missing folded entry");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (profile.find ("Events: 15,"), 0, "Wrong number of events");
+          NS_TEST_EXPECT_MSG_NE (profile.find ("node 1, " + nameA + "\n"), std::string::npos,
+                                 "Missing entry");
+          NS_TEST_EXPECT_MSG_NE (profile.find ("          10  "), std::string::npos,
+                                 "Missing count");
+        }
+    }
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (""));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFormat", EnumValue (DefaultSimulatorImpl::PROFILE_REPORT));
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +922,22 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerBatchTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorBatchTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorBatchTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerBatchTestCase (factory), TestCase::QUICK);
+    AddTestCase (new EventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new EventProfilerTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -26,6 +26,9 @@
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/thread-exit.h"
+#include "ns3/make-event.h"
+#include "ns3/rng-stream.h"
 
 #include <ctime>
 #include <list>
@@ -225,6 +228,226 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class ThreadedSimulatorBurstTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorBurstTestCase (unsigned int threads);
+  void Receive (unsigned int threadno, uint32_t seq);
+  void Poll (void);
+  static void SchedulingThread (std::pair<ThreadedSimulatorBurstTestCase *, unsigned int> context);
+  unsigned int m_threads;
+  uint32_t m_events;
+  uint32_t m_next[MAXTHREADS];
+  uint32_t m_received;
+  volatile uint32_t m_done;
+  std::string m_error;
+  std::list<Ptr<SystemThread> > m_threadlist;
+
+private:
+  virtual void DoRun (void);
+};
+
+ThreadedSimulatorBurstTestCase::ThreadedSimulatorBurstTestCase (unsigned int threads)
+  : TestCase ("Check that bursts of events from other threads are all run in order"),
+    m_threads (threads),
+    m_events (3000)
+{
+}
+
+void
+ThreadedSimulatorBurstTestCase::SchedulingThread (std::pair<ThreadedSimulatorBurstTestCase *, unsigned int> context)
+{
+  ThreadedSimulatorBurstTestCase *me = context.first;
+  unsigned int threadno = context.second;
+
+  // more events than the ring holds, without waiting, so that some
+  // of them overflow
+  for (uint32_t seq = 0; seq < me->m_events; ++seq)
+    {
+      Simulator::ScheduleWithContext (threadno, MicroSeconds (1),
+                                      &ThreadedSimulatorBurstTestCase::Receive, me, threadno, seq);
+    }
+  __sync_add_and_fetch (&me->m_done, 1);
+}
+
+void
+ThreadedSimulatorBurstTestCase::Receive (unsigned int threadno, uint32_t seq)
+{
+  if (Simulator::GetContext () != threadno || seq != m_next[threadno])
+    {
+      m_error = "Bad order of events from other threads";
+    }
+  m_next[threadno] = seq + 1;
+  m_received++;
+}
+
+void
+ThreadedSimulatorBurstTestCase::Poll (void)
+{
+  if (m_done == m_threads && m_received == m_threads * m_events)
+    {
+      return;
+    }
+  Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorBurstTestCase::Poll, this);
+}
+
+void
+ThreadedSimulatorBurstTestCase::DoRun (void)
+{
+  m_received = 0;
+  m_done = 0;
+  for (unsigned int i = 0; i < m_threads; ++i)
+    {
+      m_next[i] = 0;
+      m_threadlist.push_back (
+        Create<SystemThread> (MakeBoundCallback (
+                                &ThreadedSimulatorBurstTestCase::SchedulingThread,
+                                std::pair<ThreadedSimulatorBurstTestCase *, unsigned int> (this, i))));
+    }
+
+  Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorBurstTestCase::Poll, this);
+  for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+  Simulator::Run ();
+  for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+  Simulator::Destroy ();
+  m_threadlist.clear ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_error.empty (), true, m_error);
+  NS_TEST_EXPECT_MSG_EQ (m_received, m_threads * m_events, "Events from other threads lost");
+}
+
+class ThreadExitTestCase : public TestCase
+{
+public:
+  ThreadExitTestCase ();
+  static void Thread (void);
+  static void First (void);
+  static void Second (void);
+  static void Nop (void);
+  static std::string g_calls;
+
+private:
+  virtual void DoRun (void);
+};
+
+std::string ThreadExitTestCase::g_calls;
+
+ThreadExitTestCase::ThreadExitTestCase ()
+  : TestCase ("Check that the functions registered by a thread are called when it exits")
+{
+}
+
+void
+ThreadExitTestCase::Thread (void)
+{
+  AtThreadExit (&ThreadExitTestCase::First);
+  AtThreadExit (&ThreadExitTestCase::Second);
+  // fill the event pools of the thread, which are freed at exit
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      MakeEvent (&ThreadExitTestCase::Nop)->Unref ();
+    }
+  g_calls += "run ";
+}
+
+void
+ThreadExitTestCase::First (void)
+{
+  g_calls += "first ";
+}
+
+void
+ThreadExitTestCase::Second (void)
+{
+  g_calls += "second ";
+}
+
+void
+ThreadExitTestCase::Nop (void)
+{
+}
+
+void
+ThreadExitTestCase::DoRun (void)
+{
+  g_calls.clear ();
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&ThreadExitTestCase::Thread));
+  thread->Start ();
+  thread->Join ();
+  NS_TEST_EXPECT_MSG_EQ (g_calls, "run second first ", "Wrong calls at thread exit");
+}
+
+class RngStreamListTestCase : public TestCase
+{
+public:
+  RngStreamListTestCase ();
+  static void Thread (void);
+  static uint32_t CountStreams (void);
+
+private:
+  virtual void DoRun (void);
+};
+
+RngStreamListTestCase::RngStreamListTestCase ()
+  : TestCase ("Check that threads can create and destroy random streams at once")
+{
+}
+
+void
+RngStreamListTestCase::Thread (void)
+{
+  RngStream stream (1, 0, 0);
+  RngStream *streams[10];
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      streams[i] = new RngStream (stream);
+    }
+  // copies are cheap, so that the threads change the list at once
+  for (uint32_t i = 0; i < 100000; ++i)
+    {
+      delete streams[i % 10];
+      streams[i % 10] = new RngStream (stream);
+    }
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      delete streams[i];
+    }
+}
+
+uint32_t
+RngStreamListTestCase::CountStreams (void)
+{
+  uint32_t count = 0;
+  for (RngStream *stream = RngStream::GetFirst (); stream != 0; stream = stream->GetNext ())
+    {
+      count++;
+    }
+  return count;
+}
+
+void
+RngStreamListTestCase::DoRun (void)
+{
+  uint32_t before = CountStreams ();
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&RngStreamListTestCase::Thread)));
+      threads.back ()->Start ();
+    }
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (CountStreams (), before, "Corrupted list of live streams");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -241,7 +464,8 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -262,5 +486,8 @@ public:
               }
           }
       }
+    AddTestCase (new ThreadedSimulatorBurstTestCase (4), TestCase::QUICK);
+    AddTestCase (new ThreadExitTestCase, TestCase::QUICK);
+    AddTestCase (new RngStreamListTestCase, TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
@@ -23,9 +23,15 @@
 #include <ctime>
 
 #include "ns3/type-id.h"
+#include "ns3/object.h"
+#include "ns3/uinteger.h"
+#include "ns3/traced-value.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/test.h"
 #include "ns3/log.h"
 
+#include <sstream>
+
 using namespace std;
 
 using namespace ns3;
@@ -180,6 +186,16 @@ CollisionTestCase::DoRun (void)
                           "Second and lesser TypeId has HashChainFlag set");
   cout << suite << "collision: second,lesser not chained: OK" << endl;
 
+  // Check that the chained types are still found
+  TypeId all[] = { t1, t2, t3, t4 };
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByHash (all[i].GetHash ()), all[i],
+                             "LookupByHash failed for " << all[i].GetName ());
+      NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByName (all[i].GetName ()), all[i],
+                             "LookupByName failed for " << all[i].GetName ());
+    }
+
   /** TODO Extra credit:  register three types whose hashes collide
    *
    *  None found in /usr/share/dict/web2
@@ -188,6 +204,119 @@ CollisionTestCase::DoRun (void)
 }
   
   
+//----------------------------
+//
+// Attribute and trace source lookup test
+
+class MemberLookupTestObject : public Object
+{
+public:
+  uint32_t m_value;
+  TracedValue<uint32_t> m_traced;
+};
+
+class MemberLookupTestCase : public TestCase
+{
+public:
+  MemberLookupTestCase ();
+  virtual ~MemberLookupTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+MemberLookupTestCase::MemberLookupTestCase ()
+  : TestCase ("Check lookup of attributes and trace sources by name")
+{
+}
+
+MemberLookupTestCase::~MemberLookupTestCase ()
+{
+}
+
+void
+MemberLookupTestCase::DoRun (void)
+{
+  TypeId base = TypeId ("ns3::MemberLookupBase")
+    .SetParent<Object> ()
+    .HideFromDocumentation ()
+    .AddAttribute ("Value", "A value.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MemberLookupTestObject::m_value),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("Traced", "A traced value.",
+                     MakeTraceSourceAccessor (&MemberLookupTestObject::m_traced),
+                     "ns3::TracedValue::Uint32Callback")
+  ;
+  TypeId child = TypeId ("ns3::MemberLookupChild")
+    .SetParent (base)
+    .HideFromDocumentation ()
+    .AddAttribute ("ChildValue", "A value of the child.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&MemberLookupTestObject::m_value),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  // enough attributes to grow the hash tables several times
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      std::ostringstream oss;
+      oss << "Value" << i;
+      child.AddAttribute (oss.str (), "One of many values.",
+                          UintegerValue (i),
+                          MakeUintegerAccessor (&MemberLookupTestObject::m_value),
+                          MakeUintegerChecker<uint32_t> ());
+    }
+
+  struct TypeId::AttributeInformation info;
+  NS_TEST_ASSERT_MSG_EQ (child.LookupAttributeByName ("ChildValue", &info), true,
+                         "Attribute of the type not found");
+  NS_TEST_EXPECT_MSG_EQ (info.name, "ChildValue", "Wrong attribute found");
+  NS_TEST_ASSERT_MSG_EQ (child.LookupAttributeByName ("Value", &info), true,
+                         "Attribute of the parent not found");
+  NS_TEST_EXPECT_MSG_EQ (info.help, "A value.", "Wrong attribute found");
+  NS_TEST_EXPECT_MSG_EQ (base.LookupAttributeByName ("ChildValue", &info), false,
+                         "Attribute of the child found in the parent");
+  NS_TEST_EXPECT_MSG_EQ (child.LookupAttributeByName ("Missing", &info), false,
+                         "Attribute which does not exist found");
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      std::ostringstream oss;
+      oss << "Value" << i;
+      NS_TEST_ASSERT_MSG_EQ (child.LookupAttributeByName (oss.str (), &info), true,
+                             "Attribute " << oss.str () << " not found");
+      Ptr<const UintegerValue> value = DynamicCast<const UintegerValue> (info.initialValue);
+      NS_TEST_EXPECT_MSG_EQ (value->Get (), i, "Wrong attribute found for " << oss.str ());
+    }
+
+  NS_TEST_EXPECT_MSG_NE (child.LookupTraceSourceByName ("Traced"), 0,
+                         "Trace source of the parent not found");
+  NS_TEST_EXPECT_MSG_EQ (child.LookupTraceSourceByName ("Missing"), 0,
+                         "Trace source which does not exist found");
+
+  // members added to the parent later are visible from the child
+  base.AddAttribute ("LateValue", "A value added after the child.",
+                     UintegerValue (3),
+                     MakeUintegerAccessor (&MemberLookupTestObject::m_value),
+                     MakeUintegerChecker<uint32_t> ());
+  base.AddTraceSource ("LateTraced", "A trace source added after the child.",
+                       MakeTraceSourceAccessor (&MemberLookupTestObject::m_traced),
+                       "ns3::TracedValue::Uint32Callback");
+  NS_TEST_EXPECT_MSG_EQ (child.LookupAttributeByName ("LateValue", &info), true,
+                         "Attribute added to the parent later not found");
+  NS_TEST_EXPECT_MSG_NE (child.LookupTraceSourceByName ("LateTraced"), 0,
+                         "Trace source added to the parent later not found");
+
+  // and so are those of a new parent
+  child.SetParent<Object> ();
+  NS_TEST_EXPECT_MSG_EQ (child.LookupAttributeByName ("Value", &info), false,
+                         "Attribute of the old parent found");
+  NS_TEST_EXPECT_MSG_EQ (child.LookupAttributeByName ("ChildValue", &info), true,
+                         "Attribute of the type not found after a new parent");
+  child.SetParent (base);
+  NS_TEST_EXPECT_MSG_EQ (child.LookupAttributeByName ("LateValue", &info), true,
+                         "Attribute of the parent not found after a new parent");
+}
+
+
 //----------------------------
 //
 // Performance test
@@ -298,6 +427,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   // as chained.
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
+  AddTestCase (new MemberLookupTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;  
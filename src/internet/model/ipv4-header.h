@@ -143,6 +143,14 @@ public:
    * \param ttl the ipv4 TTL
    */
   void SetTtl (uint8_t ttl);
+  /**
+   * \brief Decrement the TTL, as a router does when it forwards the packet.
+   *
+   * If the header was deserialized with a correct checksum, the
+   * checksum is updated incrementally (RFC 1624) instead of being
+   * calculated again when the header is serialized.
+   */
+  void DecrementTtl (void);
   /**
    * \param num the ipv4 protocol field
    */
@@ -253,6 +261,7 @@ private:
   Ipv4Address m_destination; //!< destination address
   uint16_t m_checksum; //!< checksum
   bool m_goodChecksum; //!< true if checksum is correct
+  bool m_checksumValid; //!< true if m_checksum matches the other fields
   uint16_t m_headerSize; //!< IP header size
 };
 
@@ -256,11 +256,97 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
+class Ipv4HeaderChecksumTest : public TestCase
+{
+  Ipv4Header MakeHeader (uint8_t ttl, uint8_t protocol, uint16_t identification);
+  std::string Serialize (const Ipv4Header &header);
+
+public:
+  virtual void DoRun (void);
+  Ipv4HeaderChecksumTest ();
+};
+
+Ipv4HeaderChecksumTest::Ipv4HeaderChecksumTest ()
+  : TestCase ("IPv4 Header incremental checksum update")
+{
+}
+
+Ipv4Header
+Ipv4HeaderChecksumTest::MakeHeader (uint8_t ttl, uint8_t protocol, uint16_t identification)
+{
+  Ipv4Header header;
+  header.EnableChecksum ();
+  header.SetSource (Ipv4Address ("10.1.2.3"));
+  header.SetDestination (Ipv4Address ("192.168.200.17"));
+  header.SetProtocol (protocol);
+  header.SetIdentification (identification);
+  header.SetPayloadSize (1000 + identification % 400);
+  header.SetTtl (ttl);
+  return header;
+}
+
+std::string
+Ipv4HeaderChecksumTest::Serialize (const Ipv4Header &header)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+  uint8_t data[20];
+  p->CopyData (data, 20);
+  return std::string (reinterpret_cast<char *> (data), 20);
+}
+
+void
+Ipv4HeaderChecksumTest::DoRun (void)
+{
+  uint8_t ttls[] = { 0, 1, 2, 64, 128, 255 };
+  uint8_t protocols[] = { 0, 1, 6, 17, 255 };
+  for (uint32_t identification = 0; identification < 65536; identification += 4099)
+    {
+      for (uint32_t t = 0; t < sizeof (ttls); t++)
+        {
+          for (uint32_t p = 0; p < sizeof (protocols); p++)
+            {
+              Ptr<Packet> packet = Create<Packet> ();
+              packet->AddHeader (MakeHeader (ttls[t], protocols[p], identification));
+              Ipv4Header received;
+              received.EnableChecksum ();
+              packet->PeekHeader (received);
+              NS_TEST_ASSERT_MSG_EQ (received.IsChecksumOk (), true, "Bad checksum");
+
+              received.DecrementTtl ();
+              uint8_t ttl = ttls[t] - 1;
+              NS_TEST_EXPECT_MSG_EQ (uint32_t (received.GetTtl ()), uint32_t (ttl), "Wrong TTL");
+              NS_TEST_EXPECT_MSG_EQ ((Serialize (received) == Serialize (MakeHeader (ttl, protocols[p], identification))),
+                                     true, "Incremental checksum differs for ttl " << uint32_t (ttls[t])
+                                     << " protocol " << uint32_t (protocols[p]));
+
+              // A header changed after the update is checksummed again.
+              received.SetTos (0x28);
+              Ipv4Header expected = MakeHeader (ttl, protocols[p], identification);
+              expected.SetTos (0x28);
+              NS_TEST_EXPECT_MSG_EQ ((Serialize (received) == Serialize (expected)), true,
+                                     "Checksum not calculated again");
+            }
+        }
+    }
+
+  // Without checksums, the checksum field stays zero.
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (MakeHeader (64, 17, 1));
+  Ipv4Header received;
+  packet->PeekHeader (received);
+  received.DecrementTtl ();
+  std::string data = Serialize (received);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t (data[10]) | uint32_t (data[11])), 0, "Checksum written while disabled");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (uint8_t (data[8])), 63, "Wrong TTL");
+}
+//-----------------------------------------------------------------------------
 class Ipv4HeaderTestSuite : public TestSuite
 {
 public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest, TestCase::QUICK);
+    AddTestCase (new Ipv4HeaderChecksumTest, TestCase::QUICK);
   }
 } g_ipv4HeaderTestSuite;
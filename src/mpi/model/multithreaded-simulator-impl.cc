@@ -0,0 +1,672 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <sched.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+/** Largest time step, used for "no event" and "no stop time". */
+const uint64_t MAX_TS = 0x7fffffffffffffffLL;
+/** Number of polls of the barrier before yielding the processor. */
+const uint32_t BARRIER_SPINS = 1000;
+
+/** Index of the partition run by the calling thread; 0 for the main thread. */
+__thread uint32_t g_partition = 0;
+
+} // unnamed namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_lookAhead (MAX_TS),
+    m_running (false),
+    m_barrierCount (0),
+    m_barrierSense (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<struct Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      struct Partition *p = *i;
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      for (uint32_t j = 0; j < p->outbox.size (); j++)
+        {
+          for (uint32_t k = 0; k < p->outbox[j].size (); k++)
+            {
+              p->outbox[j][k].impl->Unref ();
+            }
+        }
+      delete p;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+struct MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::CreatePartition (void) const
+{
+  NS_LOG_FUNCTION (this);
+  struct Partition *p = new Partition ();
+  p->events = m_schedulerFactory.Create<Scheduler> ();
+  // uids are allocated from 4, as by DefaultSimulatorImpl
+  p->uid = 4;
+  p->currentUid = 0;
+  // a partition created between two runs starts at the time reached
+  p->currentTs = m_partitions.empty () ? 0 : m_partitions[0]->currentTs;
+  p->currentContext = 0xffffffff;
+  p->eventCount = 0;
+  p->unscheduledEvents = 0;
+  p->stop = false;
+  p->stopTs = MAX_TS;
+  p->nextTs = MAX_TS;
+  p->grantedTs = MAX_TS;
+  p->sense = false;
+  return p;
+}
+
+struct MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrent (void) const
+{
+  NS_ASSERT (g_partition < m_partitions.size ());
+  return m_partitions[g_partition];
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  if (m_partitions.empty ())
+    {
+      m_partitions.push_back (CreatePartition ());
+      return;
+    }
+  for (std::vector<struct Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      while (!(*i)->events->IsEmpty ())
+        {
+          scheduler->Insert ((*i)->events->RemoveNext ());
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Distribute (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nNodes = NodeList::GetNNodes ();
+  m_partitionOf.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      uint32_t systemId = NodeList::GetNode (i)->GetSystemId ();
+      m_partitionOf[i] = systemId;
+      while (m_partitions.size () <= systemId)
+        {
+          m_partitions.push_back (CreatePartition ());
+        }
+    }
+
+  // the pending events of all the partitions have smaller uids than the
+  // next uid of each partition
+  uint32_t uid = 0;
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      uid = std::max (uid, m_partitions[i]->uid);
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      m_partitions[i]->uid = uid;
+    }
+
+  // move the events scheduled before the run to the partition of their node
+  struct Partition *main = m_partitions[0];
+  std::vector<Scheduler::Event> events;
+  while (!main->events->IsEmpty ())
+    {
+      events.push_back (main->events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      uint32_t context = i->key.m_context;
+      struct Partition *p = context < nNodes ? m_partitions[m_partitionOf[context]] : main;
+      p->events->Insert (*i);
+      if (p != main)
+        {
+          main->unscheduledEvents--;
+          p->unscheduledEvents++;
+        }
+    }
+  NS_LOG_LOGIC (nNodes << " nodes in " << m_partitions.size () << " partitions");
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_lookAhead = MAX_TS;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      uint32_t partition = m_partitionOf[(*node)->GetId ()];
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> localNetDevice = (*node)->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+            {
+              Ptr<Node> remoteNode = channel->GetDevice (j)->GetNode ();
+              if (remoteNode == 0 || m_partitionOf[remoteNode->GetId ()] == partition)
+                {
+                  continue;
+                }
+              // only the point to point links have a known delay between
+              // the transmission and the reception by the other node
+              if (!localNetDevice->IsPointToPoint ())
+                {
+                  NS_FATAL_ERROR ("Node " << (*node)->GetId () << " and node " << remoteNode->GetId () <<
+                                  " have different system ids and share a channel which is not point to point");
+                }
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              if (!delay.Get ().IsStrictlyPositive ())
+                {
+                  NS_FATAL_ERROR ("Node " << (*node)->GetId () << " and node " << remoteNode->GetId () <<
+                                  " have different system ids and share a channel without delay");
+                }
+              m_lookAhead = std::min (m_lookAhead, static_cast<uint64_t> (delay.Get ().GetTimeStep ()));
+            }
+        }
+    }
+  NS_LOG_LOGIC ("lookahead " << m_lookAhead);
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (struct Partition *p)
+{
+  p->sense = !p->sense;
+  if (__sync_add_and_fetch (&m_barrierCount, 1) == m_partitions.size ())
+    {
+      m_barrierCount = 0;
+      __sync_synchronize ();
+      m_barrierSense = p->sense;
+    }
+  else
+    {
+      uint32_t spins = 0;
+      while (m_barrierSense != p->sense)
+        {
+          if (++spins > BARRIER_SPINS)
+            {
+              sched_yield ();
+            }
+        }
+    }
+  __sync_synchronize ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (struct Partition *p)
+{
+  Scheduler::Event next = p->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= p->currentTs);
+  p->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  p->currentTs = next.key.m_ts;
+  p->currentContext = next.key.m_context;
+  p->currentUid = next.key.m_uid;
+  p->eventCount++;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (uint32_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  g_partition = id;
+  struct Partition *p = m_partitions[id];
+  uint32_t n = m_partitions.size ();
+  while (true)
+    {
+      p->nextTs = p->stop || p->events->IsEmpty () ? MAX_TS : p->events->PeekNext ().key.m_ts;
+      Barrier (p);
+
+      // every partition computes the same window from the published state
+      uint64_t nextTs = MAX_TS;
+      uint64_t stopTs = MAX_TS;
+      bool stop = false;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          nextTs = std::min (nextTs, m_partitions[i]->nextTs);
+          stopTs = std::min (stopTs, m_partitions[i]->stopTs);
+          stop = stop || m_partitions[i]->stop;
+        }
+      if (stop || nextTs == MAX_TS || nextTs > stopTs)
+        {
+          break;
+        }
+      p->grantedTs = nextTs > MAX_TS - m_lookAhead ? MAX_TS : nextTs + m_lookAhead;
+      if (stopTs < p->grantedTs)
+        {
+          // the events at the stop time are run
+          p->grantedTs = stopTs + 1;
+        }
+
+      while (!p->stop && !p->events->IsEmpty ())
+        {
+          uint64_t ts = p->events->PeekNext ().key.m_ts;
+          if (ts >= p->grantedTs || ts > p->stopTs)
+            {
+              break;
+            }
+          ProcessOneEvent (p);
+        }
+      Barrier (p);
+
+      // take the events handed over by the other partitions
+      for (uint32_t i = 0; i < n; i++)
+        {
+          std::vector<Scheduler::Event> &inbox = m_partitions[i]->outbox[id];
+          for (std::vector<Scheduler::Event>::iterator ev = inbox.begin (); ev != inbox.end (); ++ev)
+            {
+              ev->key.m_uid = p->uid;
+              p->uid++;
+              p->unscheduledEvents++;
+              p->events->Insert (*ev);
+            }
+          inbox.clear ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  Distribute ();
+  CalculateLookAhead ();
+
+  uint32_t n = m_partitions.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_partitions[i]->stop = false;
+      m_partitions[i]->sense = false;
+      m_partitions[i]->outbox.resize (n);
+    }
+  m_barrierCount = 0;
+  m_barrierSense = false;
+
+  m_running = true;
+  for (uint32_t i = 1; i < n; i++)
+    {
+      m_partitions[i]->thread = Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::RunPartition, this).Bind (i));
+      m_partitions[i]->thread->Start ();
+    }
+  RunPartition (0);
+  for (uint32_t i = 1; i < n; i++)
+    {
+      m_partitions[i]->thread->Join ();
+      m_partitions[i]->thread = 0;
+    }
+  m_running = false;
+
+  // unless stopped by Simulator::Stop, leave all the partitions at the
+  // same time, as after a sequential run
+  uint64_t ts = 0;
+  uint64_t stopTs = MAX_TS;
+  bool stop = false;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      ts = std::max (ts, m_partitions[i]->currentTs);
+      stopTs = std::min (stopTs, m_partitions[i]->stopTs);
+      stop = stop || m_partitions[i]->stop;
+    }
+  if (!stop && stopTs != MAX_TS)
+    {
+      ts = stopTs;
+    }
+  uint32_t uid = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      struct Partition *p = m_partitions[i];
+      if (!stop)
+        {
+          p->currentTs = ts;
+          p->stopTs = MAX_TS;
+        }
+      uid = std::max (uid, p->uid);
+      // If the simulator stopped naturally by lack of events, make a
+      // consistency test to check that we didn't lose any events along the way.
+      NS_ASSERT (!p->events->IsEmpty () || p->unscheduledEvents == 0);
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_partitions[i]->uid = uid;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  GetCurrent ()->stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  struct Partition *p = GetCurrent ();
+  p->stopTs = std::min (p->stopTs, p->currentTs + delay.GetTimeStep ());
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  bool finished = true;
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      if (m_partitions[i]->stop)
+        {
+          return true;
+        }
+      finished = finished && m_partitions[i]->events->IsEmpty ();
+    }
+  return finished;
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  struct Partition *p = GetCurrent ();
+
+  Time tAbsolute = delay + TimeStep (p->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (p->currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
+  ev.key.m_context = p->currentContext;
+  ev.key.m_uid = p->uid;
+  p->uid++;
+  p->unscheduledEvents++;
+  p->events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  struct Partition *p = GetCurrent ();
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = p->currentTs + delay.GetTimeStep ();
+  ev.key.m_context = context;
+  if (m_running && context < m_partitionOf.size () && m_partitionOf[context] != g_partition)
+    {
+      // the other partition may already run events up to the end of
+      // the window: the event must be later
+      if (ev.key.m_ts < p->grantedTs)
+        {
+          NS_FATAL_ERROR ("Event for node " << context << " of another system scheduled in " <<
+                          delay << ", less than the lookahead");
+        }
+      // the uid is set by the destination partition
+      ev.key.m_uid = 0;
+      p->outbox[m_partitionOf[context]].push_back (ev);
+      return;
+    }
+  ev.key.m_uid = p->uid;
+  p->uid++;
+  p->unscheduledEvents++;
+  p->events->Insert (ev);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  struct Partition *p = GetCurrent ();
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = p->currentTs;
+  ev.key.m_context = p->currentContext;
+  ev.key.m_uid = p->uid;
+  p->uid++;
+  p->unscheduledEvents++;
+  p->events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  EventId id (Ptr<EventImpl> (event, false), GetCurrent ()->currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_destroyEventsMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetCurrent ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrent ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  struct Partition *p = GetCurrent ();
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  p->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyEventsMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  struct Partition *p = GetCurrent ();
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < p->currentTs
+      || (id.GetTs () == p->currentTs
+          && id.GetUid () <= p->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (MAX_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return g_partition;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ()->currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = 0;
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      count += m_partitions[i]->eventCount;
+    }
+  return count;
+}
+
+} // namespace ns3
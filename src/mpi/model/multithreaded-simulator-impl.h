@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Parallel simulator implementation using threads of a single
+ * process
+ *
+ * The nodes are partitioned by their system id, as for the distributed
+ * simulator, and each partition is run by its own thread: partition 0
+ * by the thread which calls Simulator::Run, the others by threads
+ * started by Run.  The partitions are synchronized with the same
+ * conservative time windows as DistributedSimulatorImpl: the lookahead
+ * is the smallest delay of the point to point channels between nodes of
+ * different partitions, and a window spans from the earliest pending
+ * event of all the partitions to that time plus the lookahead.
+ *
+ * An event scheduled with the context of a node of another partition is
+ * handed over by pointer: it is appended to the outbox of the source
+ * partition for the destination, and inserted in the event list of the
+ * destination after the end of the window.  The outboxes are written
+ * and read by a single thread at a time, separated by the barrier which
+ * ends the window, so that no lock nor atomic operation is needed.  The
+ * PointToPointRemoteChannel gives the destination a copy of the packet
+ * which shares no data with the original, so that the packet buffers,
+ * which are reference counted without atomic operations, are never
+ * accessed by two threads.
+ *
+ * The events scheduled before Simulator::Run are moved to the partition
+ * of the node of their context when Run starts; the events without the
+ * context of a node are run by partition 0.  During the run, the events
+ * must only access the objects of their own partition, and an event can
+ * only be cancelled or removed by its own partition.  A call to
+ * Simulator::Stop stops the other partitions at the end of the current
+ * time window.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** The state of a partition, only accessed by its own thread during the run. */
+  struct Partition
+  {
+    Ptr<Scheduler> events;        /**< The event priority queue. */
+    uint32_t uid;                 /**< Next event unique id. */
+    uint32_t currentUid;          /**< Unique id of the current event. */
+    uint64_t currentTs;           /**< Timestamp of the current event. */
+    uint32_t currentContext;      /**< Execution context of the current event. */
+    uint64_t eventCount;          /**< The event count. */
+    int unscheduledEvents;        /**< Events inserted but not yet run. */
+    bool stop;                    /**< Simulator::Stop was called by this partition. */
+    uint64_t stopTs;              /**< Earliest stop time set by this partition. */
+    uint64_t nextTs;              /**< Time of the next event, published between windows. */
+    uint64_t grantedTs;           /**< End of the current window, excluded. */
+    bool sense;                   /**< Sense of the last barrier passed. */
+    /** Events for the other partitions, by destination. */
+    std::vector<std::vector<Scheduler::Event> > outbox;
+    Ptr<SystemThread> thread;     /**< The thread running the partition. */
+  };
+
+  /**
+   * Create a partition, with an empty event list.
+   * \returns The partition.
+   */
+  struct Partition *CreatePartition (void) const;
+  /**
+   * Get the partition of the calling thread.
+   * \returns The partition.
+   */
+  struct Partition *GetCurrent (void) const;
+  /**
+   * Create the partitions of the nodes, move the events scheduled before
+   * the run to them and compute the lookahead.
+   */
+  void Distribute (void);
+  /**
+   * Compute the lookahead from the delay of the channels between nodes
+   * of different partitions.
+   */
+  void CalculateLookAhead (void);
+  /**
+   * Run a partition until the end of the simulation.
+   * \param [in] id The index of the partition.
+   */
+  void RunPartition (uint32_t id);
+  /**
+   * Process the next event of a partition.
+   * \param [in] p The partition.
+   */
+  void ProcessOneEvent (struct Partition *p);
+  /**
+   * Wait until all the partitions reach the barrier.
+   * \param [in] p The partition of the calling thread.
+   */
+  void Barrier (struct Partition *p);
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex to control access to the list of events to run at Destroy. */
+  SystemMutex m_destroyEventsMutex;
+
+  /** Factory of the event priority queues. */
+  ObjectFactory m_schedulerFactory;
+  /** The partitions, indexed by system id. */
+  std::vector<struct Partition *> m_partitions;
+  /** Partition of each node, indexed by node id. */
+  std::vector<uint32_t> m_partitionOf;
+  /** Lookahead, in time steps. */
+  uint64_t m_lookAhead;
+  /** Flag \c true while the partitions are run by their threads. */
+  bool m_running;
+  /** Number of partitions which reached the barrier. */
+  volatile uint32_t m_barrierCount;
+  /** Sense of the barrier, flipped when all the partitions reach it. */
+  volatile bool m_barrierSense;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
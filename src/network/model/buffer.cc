@@ -20,6 +20,14 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include <algorithm>
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__)) && \
+  (defined (__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+/* SSE2 and AVX2 versions of the checksum, selected at run time */
+#define BUFFER_CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -43,6 +51,136 @@ static struct Zeroes
   const uint32_t size;  //!< buffer size
 } g_zeroes; //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * \brief Sum the 16-bit words of a piece of a buffer for its checksum.
+ * \param data the bytes
+ * \param size the number of bytes, less than 64KiB
+ * \returns the sum of the words read as by Buffer::Iterator::ReadU16, the
+ *          last byte of an odd size being the low byte of its word
+ */
+typedef uint64_t (*ChecksumSum) (const uint8_t *data, uint32_t size);
+
+/**
+ * \ingroup packet
+ * \brief Portable version of the checksum sum.
+ * \copydetails ChecksumSum
+ */
+uint64_t
+SumWords (const uint8_t *data, uint32_t size)
+{
+  /* the sum of 32-bit little-endian words, since 2^16 = 1 (mod 2^16-1) */
+  uint64_t sum = 0;
+  uint32_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    {
+      sum += (uint32_t)data[i] | ((uint32_t)data[i + 1] << 8) |
+        ((uint32_t)data[i + 2] << 16) | ((uint32_t)data[i + 3] << 24);
+    }
+  for (; i + 2 <= size; i += 2)
+    {
+      sum += (uint32_t)data[i] | ((uint32_t)data[i + 1] << 8);
+    }
+  if (i < size)
+    {
+      sum += data[i];
+    }
+  return sum;
+}
+
+#ifdef BUFFER_CHECKSUM_X86
+/**
+ * \ingroup packet
+ * \brief SSE2 version of the checksum sum.
+ * \copydetails ChecksumSum
+ */
+__attribute__ ((target ("sse2")))
+uint64_t
+SumWordsSse2 (const uint8_t *data, uint32_t size)
+{
+  /* the words are added to four 32-bit lanes, which cannot overflow
+   * for less than 64KiB. */
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i sum = zero;
+  uint32_t i = 0;
+  for (; i + 16 <= size; i += 16)
+    {
+      __m128i words = _mm_loadu_si128 ((const __m128i *)(data + i));
+      sum = _mm_add_epi32 (sum, _mm_unpacklo_epi16 (words, zero));
+      sum = _mm_add_epi32 (sum, _mm_unpackhi_epi16 (words, zero));
+    }
+  uint32_t lanes[4];
+  _mm_storeu_si128 ((__m128i *)lanes, sum);
+  return (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3] + SumWords (data + i, size - i);
+}
+
+/**
+ * \ingroup packet
+ * \brief AVX2 version of the checksum sum.
+ * \copydetails ChecksumSum
+ */
+__attribute__ ((target ("avx2")))
+uint64_t
+SumWordsAvx2 (const uint8_t *data, uint32_t size)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  __m256i sum = zero;
+  uint32_t i = 0;
+  for (; i + 32 <= size; i += 32)
+    {
+      __m256i words = _mm256_loadu_si256 ((const __m256i *)(data + i));
+      sum = _mm256_add_epi32 (sum, _mm256_unpacklo_epi16 (words, zero));
+      sum = _mm256_add_epi32 (sum, _mm256_unpackhi_epi16 (words, zero));
+    }
+  uint32_t lanes[8];
+  _mm256_storeu_si256 ((__m256i *)lanes, sum);
+  uint64_t total = SumWords (data + i, size - i);
+  for (uint32_t k = 0; k < 8; k++)
+    {
+      total += lanes[k];
+    }
+  return total;
+}
+#endif /* BUFFER_CHECKSUM_X86 */
+
+/**
+ * \ingroup packet
+ * \brief Select the fastest checksum sum supported by the processor.
+ * \returns the checksum sum
+ */
+ChecksumSum
+SelectSumWords (void)
+{
+#ifdef BUFFER_CHECKSUM_X86
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    {
+      return &SumWordsAvx2;
+    }
+  if (__builtin_cpu_supports ("sse2"))
+    {
+      return &SumWordsSse2;
+    }
+#endif /* BUFFER_CHECKSUM_X86 */
+  return &SumWords;
+}
+
+/**
+ * \ingroup packet
+ * \brief Fold a sum of 16-bit words into 16 bits, with end-around carry.
+ * \param sum the sum
+ * \returns the ones' complement sum
+ */
+uint32_t
+FoldChecksum (uint64_t sum)
+{
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return sum;
+}
+
 }
 
 namespace ns3 {
@@ -50,48 +188,52 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+__thread uint32_t Buffer::g_recommendedStart = 0;
+__thread struct Buffer::AllocationStats Buffer::g_stats = { 0, 0, 0, 0, 0 };
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
+__thread Buffer::FreeList *Buffer::g_freeList = 0;
+__thread ThreadFreeList Buffer::g_freeListState;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
   NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
+  DestroyFreeList ();
+}
+
+void
+Buffer::DestroyFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (g_freeList != 0)
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
+      for (uint32_t k = 0; k <= BUFFER_MAX_CLASS_SHIFT - BUFFER_MIN_CLASS_SHIFT; k++)
         {
-          Buffer::Deallocate (*i);
+          std::vector<struct Buffer::Data*> &list = g_freeList->m_classes[k];
+          for (std::vector<struct Buffer::Data*>::iterator i = list.begin ();
+               i != list.end (); i++)
+            {
+              Buffer::Deallocate (*i);
+            }
         }
       delete g_freeList;
-      g_freeList = DESTROYED;
+      g_freeList = 0;
+      g_stats.pooled = 0;
+      g_stats.pooledBytes = 0;
     }
+  // the storages released from now on are deallocated
+  g_freeListState.Destroy ();
+}
+
+uint32_t
+Buffer::GetSizeClass (uint32_t size)
+{
+  uint32_t k = 0;
+  while ((1U << (k + BUFFER_MIN_CLASS_SHIFT)) < size)
+    {
+      k++;
+    }
+  return k;
 }
 
 void
@@ -99,46 +241,52 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
+  g_stats.released++;
+  /* feed into the free list of its size class: up to 1000 storages,
+   * and up to 2MB for the largest classes */
+  if (data->m_size <= (1U << BUFFER_MAX_CLASS_SHIFT) && g_freeList != 0)
     {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      uint32_t k = GetSizeClass (data->m_size);
+      uint32_t max = std::min (1000U, std::max (32U, (1U << 21) >> (k + BUFFER_MIN_CLASS_SHIFT)));
+      std::vector<struct Buffer::Data*> &list = g_freeList->m_classes[k];
+      if (data->m_size == (1U << (k + BUFFER_MIN_CLASS_SHIFT)) && list.size () < max)
+        {
+          list.push_back (data);
+          g_stats.pooled++;
+          g_stats.pooledBytes += data->m_size;
+          return;
+        }
     }
+  Buffer::Deallocate (data);
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
+  g_stats.created++;
+  if (g_freeList == 0 && g_freeListState.Use (&Buffer::DestroyFreeList))
     {
       g_freeList = new Buffer::FreeList ();
     }
-  else if (IS_INITIALIZED (g_freeList))
+  if (dataSize > (1U << BUFFER_MAX_CLASS_SHIFT))
     {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
+      return Buffer::Allocate (dataSize);
+    }
+  /* round up to the size of the class, so that the storage can be
+   * recycled for any size of its class. */
+  uint32_t k = GetSizeClass (dataSize);
+  if (g_freeList != 0 && !g_freeList->m_classes[k].empty ())
+    {
+      struct Buffer::Data *data = g_freeList->m_classes[k].back ();
+      g_freeList->m_classes[k].pop_back ();
+      g_stats.recycled++;
+      g_stats.pooled--;
+      g_stats.pooledBytes -= data->m_size;
+      data->m_count = 1;
+      return data;
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
+  struct Buffer::Data *data = Buffer::Allocate (1U << (k + BUFFER_MIN_CLASS_SHIFT));
   NS_ASSERT (data->m_count == 1);
   return data;
 }
@@ -148,6 +296,7 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
+  g_stats.released++;
   Deallocate (data);
 }
 
@@ -155,10 +304,17 @@ Buffer::Data *
 Buffer::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
+  g_stats.created++;
   return Allocate (size);
 }
 #endif /* BUFFER_FREE_LIST */
 
+struct Buffer::AllocationStats
+Buffer::GetAllocationStats (void)
+{
+  return g_stats;
+}
+
 struct Buffer::Data *
 Buffer::Allocate (uint32_t reqSize)
 {
@@ -426,17 +582,69 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
-  Buffer dst = CreateFullCopy ();
-  Buffer src = o.CreateFullCopy ();
+  /* A buffer has a single zero area: keep both zero areas virtual if
+   * they are adjacent, else the largest one, and copy all the other
+   * bytes of the two buffers around it, so that reassembling fragments
+   * of a payload does not write its zeroes in memory.
+   * [zeroStart, zeroEnd) are offsets in the concatenation of the two
+   * buffers.
+   */
+  uint32_t size = GetSize ();
+  uint32_t total = size + o.GetSize ();
+  uint32_t zeroStart;
+  uint32_t zeroEnd;
+  if (m_end == m_zeroAreaEnd && o.m_start == o.m_zeroAreaStart)
+    {
+      zeroStart = m_zeroAreaStart - m_start;
+      zeroEnd = size + o.m_zeroAreaEnd - o.m_start;
+    }
+  else if (m_zeroAreaEnd - m_zeroAreaStart >= o.m_zeroAreaEnd - o.m_zeroAreaStart)
+    {
+      zeroStart = m_zeroAreaStart - m_start;
+      zeroEnd = m_zeroAreaEnd - m_start;
+    }
+  else
+    {
+      zeroStart = size + o.m_zeroAreaStart - o.m_start;
+      zeroEnd = size + o.m_zeroAreaEnd - o.m_start;
+    }
 
-  dst.AddAtEnd (src.GetSize ());
-  Buffer::Iterator destStart = dst.End ();
-  destStart.Prev (src.GetSize ());
-  destStart.Write (src.Begin (), src.End ());
+  Buffer dst (zeroEnd - zeroStart);
+  dst.AddAtStart (zeroStart);
+  Buffer::Iterator i = dst.Begin ();
+  WriteRange (&i, *this, o, 0, zeroStart);
+  dst.AddAtEnd (total - zeroEnd);
+  i = dst.End ();
+  i.Prev (total - zeroEnd);
+  WriteRange (&i, *this, o, zeroEnd, total);
   *this = dst;
   NS_ASSERT (CheckInternalState ());
 }
 
+void
+Buffer::WriteRange (Buffer::Iterator *dst, const Buffer &a, const Buffer &b,
+                    uint32_t start, uint32_t end)
+{
+  NS_LOG_FUNCTION (dst << &a << &b << start << end);
+  uint32_t size = a.GetSize ();
+  if (start < size)
+    {
+      Buffer::Iterator from = a.Begin ();
+      from.Next (start);
+      Buffer::Iterator to = a.Begin ();
+      to.Next (std::min (end, size));
+      dst->Write (from, to);
+    }
+  if (end > size)
+    {
+      Buffer::Iterator from = b.Begin ();
+      from.Next (std::max (start, size) - size);
+      Buffer::Iterator to = b.Begin ();
+      to.Next (end - size);
+      dst->Write (from, to);
+    }
+}
+
 void 
 Buffer::RemoveAtStart (uint32_t start)
 {
@@ -843,27 +1051,32 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  /* the bytes written are all before or all after our zero area */
+  uint8_t *to = &m_data[m_current];
+  if (m_current >= m_zeroEnd)
+    {
+      to -= m_zeroEnd - m_zeroStart;
+    }
+  m_current += size;
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
-  m_current += toCopy;
 }
 
 void 
@@ -1140,18 +1353,47 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
-  /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
-
-  while (sum >> 16)
-    sum = (sum & 0xffff) + (sum >> 16);
-  return ~sum;
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  static const ChecksumSum sumWords = SelectSumWords ();
+  /* see RFC 1071 to understand this code: the bytes before and after
+   * the zero area are summed in place, and the sum of a piece which
+   * starts at an odd offset is byte-swapped. */
+  uint64_t sum = initialChecksum;
+  uint32_t end = m_current + size;
+  bool odd = false;
+  while (m_current < end)
+    {
+      const uint8_t *data = 0;
+      uint32_t n;
+      if (m_current < m_zeroStart)
+        {
+          data = &m_data[m_current];
+          n = std::min (end, m_zeroStart) - m_current;
+        }
+      else if (m_current < m_zeroEnd)
+        {
+          n = std::min (end, m_zeroEnd) - m_current;
+        }
+      else
+        {
+          data = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+          n = end - m_current;
+        }
+      if (data != 0)
+        {
+          uint32_t piece = FoldChecksum (sumWords (data, n));
+          if (odd)
+            {
+              piece = ((piece & 0xff) << 8) | (piece >> 8);
+            }
+          sum += piece;
+        }
+      odd ^= (n & 1);
+      m_current += n;
+    }
+  return ~FoldChecksum (sum);
 }
 
 uint32_t 
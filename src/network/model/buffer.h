@@ -24,8 +24,11 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "ns3/thread-exit.h"
 
 #define BUFFER_FREE_LIST 1
+#define BUFFER_MIN_CLASS_SHIFT 5
+#define BUFFER_MAX_CLASS_SHIFT 16
 
 namespace ns3 {
 
@@ -65,10 +68,14 @@ namespace ns3 {
  * contains real data bytes in its BufferData instance but it also
  * contains "virtual zero data" which typically is used to represent
  * application-level payload. No memory is allocated to store the
- * zero bytes of application-level payload unless the user fragments
- * a Buffer: this application-level payload is kept track of with
- * a pair of integers which describe where in the buffer content
- * the "virtual zero area" starts and ends.
+ * zero bytes of application-level payload: this application-level
+ * payload is kept track of with a pair of integers which describe
+ * where in the buffer content the "virtual zero area" starts and ends.
+ * Fragments of a Buffer keep their part of the zero area virtual, and
+ * so does their concatenation with AddAtEnd.  The zero bytes are only
+ * written in memory by PeekData, and when AddAtEnd concatenates two
+ * buffers whose zero areas are not adjacent: the smallest one is
+ * then written.
  *
  * \verbatim
  * ***: unused bytes
@@ -518,7 +525,8 @@ private:
   /**
    * \param o the buffer to append to the end of this buffer.
    *
-   * Add bytes at the end of the Buffer.
+   * Add bytes at the end of the Buffer.  The largest of the zero areas
+   * of the two buffers, or both if they are adjacent, stays virtual.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
    */
@@ -605,6 +613,28 @@ private:
    */
   uint32_t CopyData (uint8_t *buffer, uint32_t size) const;
 
+  /**
+   * \brief Statistics of the allocation of the memory of the buffers
+   * by the calling thread.
+   */
+  struct AllocationStats
+  {
+    uint64_t created;     //!< Number of buffer data storages created
+    uint64_t recycled;    //!< Number of them taken from a free list
+    uint64_t released;    //!< Number of buffer data storages released
+    uint64_t pooled;      //!< Number of them kept in a free list
+    uint64_t pooledBytes; //!< Size of the storages in the free lists
+  };
+  /**
+   * \brief Get the allocation statistics of the calling thread.
+   *
+   * The storages created minus the storages recycled is the number
+   * of memory allocations.
+   *
+   * \returns the statistics of the calling thread since it started.
+   */
+  static struct AllocationStats GetAllocationStats (void);
+
   /**
    * \brief Copy constructor
    * \param o the buffer to copy
@@ -691,6 +721,17 @@ private:
    * \brief Transform a "Virtual byte buffer" into a "Real byte buffer"
    */
   void TransformIntoRealBuffer (void) const;
+  /**
+   * \brief Write a range of the concatenation of two buffers.
+   *
+   * \param [in,out] dst The iterator to write to, moved past the range.
+   * \param [in] a The first buffer.
+   * \param [in] b The second buffer.
+   * \param [in] start The offset of the range.
+   * \param [in] end The offset of the end of the range.
+   */
+  static void WriteRange (Buffer::Iterator *dst, const Buffer &a, const Buffer &b,
+                          uint32_t start, uint32_t end);
   /**
    * \brief Checks the internal buffer structures consistency
    *
@@ -759,9 +800,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value.  Per thread, like the free lists.
    */
-  static uint32_t g_recommendedStart;
+  static __thread uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -785,17 +826,39 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
+  /**
+   * The free lists of a thread, one per size class: the storages of a
+   * size class hold 2^k bytes, from 2^BUFFER_MIN_CLASS_SHIFT to
+   * 2^BUFFER_MAX_CLASS_SHIFT.  Larger storages are never recycled.
+   */
+  struct FreeList
+  {
+    /// Free storages of each size class
+    std::vector<struct Buffer::Data*> m_classes[BUFFER_MAX_CLASS_SHIFT - BUFFER_MIN_CLASS_SHIFT + 1];
+  };
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
+  /**
+   * \brief Get the size class of a storage.
+   * \param size the storage size
+   * \returns the index of the smallest size class which holds size bytes
+   */
+  static uint32_t GetSizeClass (uint32_t size);
+  /**
+   * \brief Empty the free lists of the calling thread.
+   *
+   * Called at thread exit, and by the local static destructor for the
+   * main thread.  Storages released later by the thread are deallocated.
+   */
+  static void DestroyFreeList (void);
+  static __thread FreeList *g_freeList; //!< Buffer data containers of the thread
+  static __thread ThreadFreeList g_freeListState; //!< State of the free lists of the thread
   static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
+  static __thread struct AllocationStats g_stats; //!< Allocation statistics of the thread
 };
 
 } // namespace ns3
@@ -21,6 +21,7 @@
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
+#include <algorithm>
 
 #define USE_FREE_LIST 1
 #define FREE_LIST_SIZE 1000
@@ -106,8 +107,20 @@ ByteTagList::Iterator::PrepareForNext (void)
       TagBuffer buf = TagBuffer (m_current, m_end);
       m_nextTid = buf.ReadU32 ();
       m_nextSize = buf.ReadU32 ();
-      m_nextStart = buf.ReadU32 () + m_adjustment;
-      m_nextEnd = buf.ReadU32 () + m_adjustment;
+      int32_t start = buf.ReadU32 ();
+      int32_t end = buf.ReadU32 ();
+      if (m_current < m_clipped)
+        {
+          if (start >= m_clipEnd || end <= m_clipStart)
+            {
+              m_current += 4 + 4 + 4 + 4 + m_nextSize;
+              continue;
+            }
+          start = std::max (start, m_clipStart);
+          end = std::min (end, m_clipEnd);
+        }
+      m_nextStart = start + m_adjustment;
+      m_nextEnd = end + m_adjustment;
       if (m_nextStart >= m_offsetEnd || m_nextEnd <= m_offsetStart)
         {
           m_current += 4 + 4 + 4 + 4 + m_nextSize;
@@ -118,14 +131,18 @@ ByteTagList::Iterator::PrepareForNext (void)
         }
     }
 }
-ByteTagList::Iterator::Iterator (uint8_t *start, uint8_t *end, int32_t offsetStart, int32_t offsetEnd, int32_t adjustment)
+ByteTagList::Iterator::Iterator (uint8_t *start, uint8_t *end, int32_t offsetStart, int32_t offsetEnd, int32_t adjustment,
+                                 uint8_t *clipped, int32_t clipStart, int32_t clipEnd)
   : m_current (start),
     m_end (end),
     m_offsetStart (offsetStart),
     m_offsetEnd (offsetEnd),
-    m_adjustment (adjustment)
+    m_adjustment (adjustment),
+    m_clipped (clipped),
+    m_clipStart (clipStart),
+    m_clipEnd (clipEnd)
 {
-  NS_LOG_FUNCTION (this << &start << &end << offsetStart << offsetEnd << adjustment);
+  NS_LOG_FUNCTION (this << &start << &end << offsetStart << offsetEnd << adjustment << clipStart << clipEnd);
   PrepareForNext ();
 }
 
@@ -141,6 +158,9 @@ ByteTagList::ByteTagList ()
   : m_minStart (INT32_MAX),
     m_maxEnd (INT32_MIN),
     m_adjustment (0),
+    m_clipStart (INT32_MIN),
+    m_clipEnd (INT32_MAX),
+    m_clipped (0),
     m_used (0),
     m_data (0)
 {
@@ -150,6 +170,9 @@ ByteTagList::ByteTagList (const ByteTagList &o)
   : m_minStart (o.m_minStart),
     m_maxEnd (o.m_maxEnd),
     m_adjustment (o.m_adjustment),
+    m_clipStart (o.m_clipStart),
+    m_clipEnd (o.m_clipEnd),
+    m_clipped (o.m_clipped),
     m_used (o.m_used),
     m_data (o.m_data)
 {
@@ -171,6 +194,9 @@ ByteTagList::operator = (const ByteTagList &o)
   m_minStart = o.m_minStart;
   m_maxEnd = o.m_maxEnd;
   m_adjustment = o.m_adjustment;
+  m_clipStart = o.m_clipStart;
+  m_clipEnd = o.m_clipEnd;
+  m_clipped = o.m_clipped;
   m_data = o.m_data;
   m_used = o.m_used;
   if (m_data != 0)
@@ -246,6 +272,9 @@ ByteTagList::RemoveAll (void)
   m_minStart = INT32_MAX;
   m_maxEnd = INT32_MIN;
   m_adjustment = 0;
+  m_clipStart = INT32_MIN;
+  m_clipEnd = INT32_MAX;
+  m_clipped = 0;
   m_data = 0;
   m_used = 0;
 }
@@ -265,11 +294,12 @@ ByteTagList::Begin (int32_t offsetStart, int32_t offsetEnd) const
   NS_LOG_FUNCTION (this << offsetStart << offsetEnd);
   if (m_data == 0)
     {
-      return Iterator (0, 0, offsetStart, offsetEnd, 0);
+      return Iterator (0, 0, offsetStart, offsetEnd, 0, 0, INT32_MIN, INT32_MAX);
     }
   else
     {
-      return Iterator (m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment);
+      return Iterator (m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment,
+                       &m_data->data[m_clipped], m_clipStart, m_clipEnd);
     }
 }
 
@@ -281,28 +311,7 @@ ByteTagList::AddAtEnd (int32_t appendOffset)
     {
       return;
     }
-  ByteTagList list;
-  ByteTagList::Iterator i = BeginAll ();
-  while (i.HasNext ())
-    {
-      ByteTagList::Iterator::Item item = i.Next ();
-
-      if (item.start >= appendOffset)
-        {
-          continue;
-        }
-      if (item.end > appendOffset)
-        {
-          item.end = appendOffset;
-        }
-      TagBuffer buf = list.Add (item.tid, item.size, item.start, item.end);
-      buf.CopyFrom (item.buf);
-      if (item.end > m_maxEnd)
-        {
-          m_maxEnd = item.end;
-        }
-    }
-  *this = list;
+  Clip (-m_adjustment, appendOffset - m_adjustment);
 }
 
 void 
@@ -313,29 +322,82 @@ ByteTagList::AddAtStart (int32_t prependOffset)
     {
       return;
     }
-  m_minStart = INT32_MAX;
-  ByteTagList list;
-  ByteTagList::Iterator i = BeginAll ();
-  while (i.HasNext ())
+  Clip (prependOffset - m_adjustment, INT32_MAX);
+}
+
+void
+ByteTagList::Clip (int32_t start, int32_t end)
+{
+  NS_LOG_FUNCTION (this << start << end);
+  if (m_clipped != m_used)
     {
-      ByteTagList::Iterator::Item item = i.Next ();
+      // tags were added since the last cut: write it, and cut all tags.
+      ApplyClip ();
+      m_clipped = m_used;
+    }
+  m_clipStart = std::max (m_clipStart, start);
+  m_clipEnd = std::min (m_clipEnd, end);
+  m_minStart = std::max (m_minStart, m_clipStart);
+  m_maxEnd = std::min (m_maxEnd, m_clipEnd);
+}
 
-      if (item.end <= prependOffset)
-        {
-          continue;
-        }
-      if (item.start < prependOffset)
+void
+ByteTagList::ApplyClip (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_clipped == 0)
+    {
+      return;
+    }
+  if (m_data->count != 1)
+    {
+      struct ByteTagListData *newData = Allocate (m_used);
+      std::memcpy (&newData->data, &m_data->data, m_used);
+      Deallocate (m_data);
+      m_data = newData;
+    }
+  m_minStart = INT32_MAX;
+  m_maxEnd = INT32_MIN;
+  uint8_t *clipped = &m_data->data[m_clipped];
+  uint8_t *last = &m_data->data[m_used];
+  uint8_t *cur = m_data->data;
+  uint8_t *next = m_data->data;
+  while (next < last)
+    {
+      TagBuffer buf = TagBuffer (next, last);
+      uint32_t tid = buf.ReadU32 ();
+      uint32_t size = buf.ReadU32 ();
+      int32_t start = buf.ReadU32 ();
+      int32_t end = buf.ReadU32 ();
+      uint8_t *tag = next;
+      next += 4 + 4 + 4 + 4 + size;
+      if (tag < clipped)
         {
-          item.start = prependOffset;
+          if (start >= m_clipEnd || end <= m_clipStart)
+            {
+              continue;
+            }
+          start = std::max (start, m_clipStart);
+          end = std::min (end, m_clipEnd);
         }
-      TagBuffer buf = list.Add (item.tid, item.size, item.start, item.end);
-      buf.CopyFrom (item.buf);
-      if (item.start < m_minStart)
+      if (cur != tag)
         {
-          m_minStart = item.start;
+          std::memmove (cur + 16, tag + 16, size);
         }
+      buf = TagBuffer (cur, cur + 16);
+      buf.WriteU32 (tid);
+      buf.WriteU32 (size);
+      buf.WriteU32 (start);
+      buf.WriteU32 (end);
+      m_minStart = std::min (m_minStart, start);
+      m_maxEnd = std::max (m_maxEnd, end);
+      cur += 4 + 4 + 4 + 4 + size;
     }
-  *this = list;
+  m_used = cur - m_data->data;
+  m_data->dirty = m_used;
+  m_clipStart = INT32_MIN;
+  m_clipEnd = INT32_MAX;
+  m_clipped = 0;
 }
 
 #ifdef USE_FREE_LIST
@@ -358,7 +420,8 @@ ByteTagList::Allocate (uint32_t size)
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
     }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
+  size = std::max (size, g_maxSize);
+  uint8_t *buffer = new uint8_t [size + sizeof (struct ByteTagListData) - 4];
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
   data->size = size;
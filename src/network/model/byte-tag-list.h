@@ -59,6 +59,13 @@ struct ByteTagListData;
  *     the boundaries before returning item. However, when packet is extending,
  *     it calls ByteTagList::AddAtStart or ByteTagList::AddAtEnd to cut byte
  *     tags that will otherwise cover new bytes.
+ *
+ *   - The cuts are not written to the shared byte buffer: each ByteTagList
+ *     keeps the bounds of the tags it has cut, which the iterator applies,
+ *     so that the fragments of a packet keep sharing its tags when headers
+ *     and trailers are added to them.  The cuts are written, after a copy
+ *     of the byte buffer if it is shared, only when a list is cut again
+ *     after tags were added to it.
  */
 class ByteTagList
 {
@@ -121,8 +128,12 @@ private:
      * \param offsetStart offset to the start of the tag from the virtual byte buffer
      * \param offsetEnd offset to the end of the tag from the virtual byte buffer
      * \param adjustment adjustment to byte tag offsets
+     * \param clipped end of the tags cut to [clipStart, clipEnd)
+     * \param clipStart minimum start of the cut tags, before adjustment
+     * \param clipEnd maximum end of the cut tags, before adjustment
      */
-    Iterator (uint8_t *start, uint8_t *end, int32_t offsetStart, int32_t offsetEnd, int32_t m_adjustment);
+    Iterator (uint8_t *start, uint8_t *end, int32_t offsetStart, int32_t offsetEnd, int32_t adjustment,
+              uint8_t *clipped, int32_t clipStart, int32_t clipEnd);
 
     /**
      * \brief Prepare the iterator for the next tag
@@ -133,6 +144,9 @@ private:
     int32_t m_offsetStart;  //!< Offset to the start of the tag from the virtual byte buffer
     int32_t m_offsetEnd;    //!< Offset to the end of the tag from the virtual byte buffer
     int32_t m_adjustment;   //!< Adjustment to byte tag offsets
+    uint8_t *m_clipped;     //!< End of the cut tags
+    int32_t m_clipStart;    //!< Minimum start of the cut tags, before adjustment
+    int32_t m_clipEnd;      //!< Maximum end of the cut tags, before adjustment
     uint32_t m_nextTid;     //!< TypeId of the next tag
     uint32_t m_nextSize;    //!< Size of the next tag
     int32_t m_nextStart;    //!< Start of the next tag
@@ -233,6 +247,21 @@ private:
    */
   ByteTagList::Iterator BeginAll (void) const;
 
+  /**
+   * \brief Cut the byte tags to the range [start, end): the tags
+   * which do not overlap it are removed.
+   *
+   * \param start minimum offset value, before adjustment
+   * \param end maximum offset value, before adjustment
+   */
+  void Clip (int32_t start, int32_t end);
+
+  /**
+   * \brief Write the cut of the tags to the byte buffer, after a copy
+   * of the ByteTagListData if it is shared with other lists.
+   */
+  void ApplyClip (void);
+
   /**
    * \brief Allocate the memory for the ByteTagListData
    * \param size the memory to allocate
@@ -249,6 +278,9 @@ private:
   int32_t m_minStart; // !< minimal start offset
   int32_t m_maxEnd; // !< maximal end offset
   int32_t m_adjustment; // !< adjustment to byte tag offsets
+  int32_t m_clipStart; //!< minimum start offset of the cut tags
+  int32_t m_clipEnd; //!< maximum end offset of the cut tags
+  uint16_t m_clipped; //!< the number of bytes of the cut tags in the buffer
   uint16_t m_used; //!< the number of used bytes in the buffer
   struct ByteTagListData *m_data; //!< the ByteTagListData structure
 };
@@ -19,6 +19,7 @@
  */
 #include <utility>
 #include <list>
+#include <algorithm>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -34,9 +35,12 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+struct PacketMetadata::Data PacketMetadata::m_emptyData = { 2, 0, 0, 0 };
+__thread uint32_t PacketMetadata::m_maxSize = 0;
+__thread uint16_t PacketMetadata::m_chunkUid = 0;
+__thread PacketMetadata::DataFreeList *PacketMetadata::m_freeList = 0;
+__thread ThreadFreeList PacketMetadata::m_freeListState;
+struct PacketMetadata::LocalStaticDestructor PacketMetadata::m_localStaticDestructor;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -45,9 +49,25 @@ PacketMetadata::DataFreeList::~DataFreeList ()
     {
       PacketMetadata::Deallocate (*i);
     }
+}
+
+PacketMetadata::LocalStaticDestructor::~LocalStaticDestructor ()
+{
+  NS_LOG_FUNCTION (this);
+  PacketMetadata::DestroyFreeList ();
+  // the packets destroyed from now on are not recycled
   PacketMetadata::m_enable = false;
 }
 
+void
+PacketMetadata::DestroyFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  delete m_freeList;
+  m_freeList = 0;
+  m_freeListState.Destroy ();
+}
+
 void 
 PacketMetadata::Enable (void)
 {
@@ -71,500 +91,117 @@ PacketMetadata::EnableChecking (void)
 }
 
 void
-PacketMetadata::ReserveCopy (uint32_t size)
+PacketMetadata::GetRecord (uint16_t i, struct PacketMetadata::Record *record) const
 {
-  NS_LOG_FUNCTION (this << size);
-  struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
-  memcpy (newData->m_data, m_data->m_data, m_used);
-  newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  NS_LOG_FUNCTION (this << i << record);
+  NS_ASSERT (i >= m_start && i < m_end);
+  *record = m_data->m_records[i];
+  if ((record->typeUid & 0x1) == 0)
     {
-      PacketMetadata::Recycle (m_data);
+      record->packetUid = m_packetUid;
     }
-  m_data = newData;
-  if (m_head != 0xffff)
+  if (i == m_start && record->fragmentStart != m_headStart)
     {
-      uint8_t *start;
-      NS_ASSERT (m_tail != 0xffff);
-      // clear the next field of the tail
-      start = &m_data->m_data[m_tail];
-      Append16 (0xffff, start);
-      // clear the prev field of the head
-      start = &m_data->m_data[m_head] + 2;
-      Append16 (0xffff, start);
+      record->fragmentStart = m_headStart;
+      record->typeUid |= 0x1;
     }
-}
-void
-PacketMetadata::Reserve (uint32_t size)
-{
-  NS_LOG_FUNCTION (this << size);
-  NS_ASSERT (m_data != 0);
-  if (m_data->m_size >= m_used + size &&
-      (m_head == 0xffff ||
-       m_data->m_count == 1 ||
-       m_data->m_dirtyEnd == m_used))
-    {
-      /* enough room, not dirty. */
-    }
-  else 
+  if (i == m_end - 1 && record->fragmentEnd != m_tailEnd)
     {
-      /* (enough room and dirty) or (not enough room) */
-      ReserveCopy (size);
+      record->fragmentEnd = m_tailEnd;
+      record->typeUid |= 0x1;
     }
 }
 
-bool
-PacketMetadata::IsSharedPointerOk (uint16_t pointer) const
-{
-  NS_LOG_FUNCTION (this << pointer);
-  bool ok = pointer == 0xffff || pointer <= m_data->m_size;
-  return ok;
-}
-bool
-PacketMetadata::IsPointerOk (uint16_t pointer) const
+void
+PacketMetadata::ReserveCopy (uint32_t headroom, uint32_t tailroom)
 {
-  NS_LOG_FUNCTION (this << pointer);
-  bool ok = pointer == 0xffff || pointer <= m_used;
-  return ok;
+  NS_LOG_FUNCTION (this << headroom << tailroom);
+  uint32_t n = m_end - m_start;
+  NS_ASSERT_MSG (n + headroom + tailroom < 0xffff, "Too many packet metadata records");
+  uint32_t size = std::max (2 * (n + headroom + tailroom),
+                            (uint32_t)PACKET_METADATA_DATA_MIN_RECORDS);
+  struct PacketMetadata::Data *newData = PacketMetadata::Create (std::min (size, (uint32_t)0xffff));
+  /* split the free records between the two ends, most of them
+   * before the records, where headers are added. */
+  uint32_t free = newData->m_size - n - headroom - tailroom;
+  uint16_t start = headroom + (tailroom == 0 ? free - free / 4 : free / 4);
+  for (uint16_t i = m_start; i < m_end; i++)
+    {
+      // the fragments of the first and last records are written in the copy
+      GetRecord (i, &newData->m_records[start + i - m_start]);
+    }
+  if (m_data != &m_emptyData && --m_data->m_count == 0)
+    {
+      PacketMetadata::Recycle (m_data);
+    }
+  m_data = newData;
+  m_start = start;
+  m_end = start + n;
+  m_data->m_dirtyStart = m_start;
+  m_data->m_dirtyEnd = m_end;
 }
 
-bool
-PacketMetadata::IsStateOk (void) const
+void
+PacketMetadata::PrepareHead (void)
 {
   NS_LOG_FUNCTION (this);
-  bool ok = m_used <= m_data->m_size;
-  ok &= IsPointerOk (m_head);
-  ok &= IsPointerOk (m_tail);
-  uint16_t current = m_head;
-  while (ok && current != 0xffff)
-    {
-      struct PacketMetadata::SmallItem item;
-      PacketMetadata::ExtraItem extraItem;
-      ReadItems (current, &item, &extraItem);
-      ok &= IsSharedPointerOk (item.next);
-      ok &= IsSharedPointerOk (item.prev);
-      if (current != m_head)
-        {
-          ok &= IsPointerOk (item.prev);
-        }
-      if (current != m_tail)
+  bool isTrimmed = m_start != m_end &&
+    m_headStart != m_data->m_records[m_start].fragmentStart;
+  if (m_start > 0 &&
+      (m_data->m_count == 1 ||
+       (m_start == m_data->m_dirtyStart && !isTrimmed)))
+    {
+      /* enough room, not dirty: the first record can be written
+       * in place if it is trimmed. */
+      if (isTrimmed)
         {
-          ok &= IsPointerOk (item.next);
+          GetRecord (m_start, &m_data->m_records[m_start]);
         }
-      if (current == m_tail)
-        {
-          break;
-        }
-      current = item.next;
-    }
-  return ok;
-}
-
-uint32_t 
-PacketMetadata::GetUleb128Size (uint32_t value) const
-{
-  NS_LOG_FUNCTION (this << value);
-  if (value < 0x80)
-    {
-      return 1;
-    }
-  if (value < 0x4000)
-    {
-      return 2;
-    }
-  if (value < 0x200000)
-    {
-      return 3;
     }
-  if (value < 0x10000000)
-    {
-      return 4;
-    }
-  return 5;
-}
-uint32_t
-PacketMetadata::ReadUleb128 (const uint8_t **pBuffer) const
-{
-  NS_LOG_FUNCTION (this << &pBuffer);
-  const uint8_t *buffer = *pBuffer;
-  uint32_t result = 0;
-  uint8_t byte;
-  result = 0;
-  byte = buffer[0];
-  result = (byte & (~0x80));
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 1;
-      return result;
-    }
-  byte = buffer[1];
-  result |= (byte & (~0x80)) << 7;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 2;
-      return result;
-    }
-  byte = buffer[2];
-  result |= (byte & (~0x80)) << 14;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 3;
-      return result;
-    }
-  byte = buffer[3];
-  result |= (byte & (~0x80)) << 21;
-  if (!(byte & 0x80))
-    {
-      *pBuffer = buffer + 4;
-      return result;
-    }
-  byte = buffer[4];
-  result |= (byte & (~0x80)) << 28;
-  if (!(byte & 0x80))
+  else
     {
-      *pBuffer = buffer + 5;
-      return result;
-    }
-  /* This means that the LEB128 number was not valid.
-   * ie: the last (5th) byte did not have the high-order bit zeroed.
-   */
-  NS_ASSERT (false);
-  return 0;
-}
-
-void
-PacketMetadata::Append16 (uint16_t value, uint8_t *buffer)
-{
-  NS_LOG_FUNCTION (this << value << &buffer);
-  buffer[0] = value & 0xff;
-  value >>= 8;
-  buffer[1] = value;
-}
-void
-PacketMetadata::Append32 (uint32_t value,  uint8_t *buffer)
-{
-  NS_LOG_FUNCTION (this << value << &buffer);
-  buffer[0] = value & 0xff;
-  buffer[1] = (value >> 8) & 0xff;
-  buffer[2] = (value >> 16) & 0xff;
-  buffer[3] = (value >> 24) & 0xff;
-}
-
-void
-PacketMetadata::AppendValueExtra (uint32_t value, uint8_t *buffer)
-{
-  NS_LOG_FUNCTION (this << value << &buffer);
-  if (value < 0x200000)
-    {
-      uint8_t byte = value & (~0x80);
-      buffer[0] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[1] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[2] = value;
-      return;
-    }
-  if (value < 0x10000000)
-    {
-      uint8_t byte = value & (~0x80);
-      buffer[0] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[1] = 0x80 | byte;
-      value >>= 7;
-      byte = value & (~0x80);
-      buffer[2] = 0x80 | byte;
-      value >>= 7;
-      buffer[3] = value;
-      return;
+      ReserveCopy (1, 0);
     }
-  {
-    uint8_t byte = value & (~0x80);
-    buffer[0] = 0x80 | byte;
-    value >>= 7;
-    byte = value & (~0x80);
-    buffer[1] = 0x80 | byte;
-    value >>= 7;
-    byte = value & (~0x80);
-    buffer[2] = 0x80 | byte;
-    value >>= 7;
-    byte = value & (~0x80);
-    buffer[3] = 0x80 | byte;
-    value >>= 7;
-    buffer[4] = value;
-  }
 }
 
 void
-PacketMetadata::AppendValue (uint32_t value, uint8_t *buffer)
+PacketMetadata::PrepareTail (uint32_t n)
 {
-  NS_LOG_FUNCTION (this << value << &buffer);
-  if (value < 0x80)
-    {
-      buffer[0] = value;
-      return;
-    }
-  if (value < 0x4000)
-    {
-      uint8_t byte = value & (~0x80);
-      buffer[0] = 0x80 | byte;
-      value >>= 7;
-      buffer[1] = value;
-      return;
+  NS_LOG_FUNCTION (this << n);
+  bool isTrimmed = m_start != m_end &&
+    m_tailEnd != m_data->m_records[m_end - 1].fragmentEnd;
+  if (m_end + n <= m_data->m_size &&
+      (m_data->m_count == 1 ||
+       (m_end == m_data->m_dirtyEnd && !isTrimmed)))
+    {
+      if (isTrimmed)
+        {
+          GetRecord (m_end - 1, &m_data->m_records[m_end - 1]);
+        }
     }
-  AppendValueExtra (value, buffer);
-}
-
-void
-PacketMetadata::UpdateTail (uint16_t written)
-{
-  NS_LOG_FUNCTION (this << written);
-  if (m_head == 0xffff)
-    {
-      NS_ASSERT (m_tail == 0xffff);
-      m_head = m_used;
-      m_tail = m_used;
-    } 
-  else
-    {
-      NS_ASSERT (m_tail != 0xffff);
-      // overwrite the next field of the previous tail of the list.
-      uint8_t *previousTail = &m_data->m_data[m_tail];
-      Append16 (m_used, previousTail);
-      // update the tail of the list to the new node.
-      m_tail = m_used;
-    }
-  NS_ASSERT (m_tail != 0xffff);
-  NS_ASSERT (m_head != 0xffff);
-  NS_ASSERT (written >= 8);
-  m_used += written;
-  m_data->m_dirtyEnd = m_used;
-}
-
-
-void
-PacketMetadata::UpdateHead (uint16_t written)
-{
-  NS_LOG_FUNCTION (this << written);
-  if (m_head == 0xffff)
-    {
-      NS_ASSERT (m_tail == 0xffff);
-      m_head = m_used;
-      m_tail = m_used;
-    } 
   else
     {
-      NS_ASSERT (m_head != 0xffff);
-      // overwrite the prev field of the previous head of the list.
-      uint8_t *previousHead = &m_data->m_data[m_head + 2];
-      Append16 (m_used, previousHead);
-      // update the head of list to the new node.
-      m_head = m_used;
-    }
-  NS_ASSERT (m_tail != 0xffff);
-  NS_ASSERT (m_head != 0xffff);
-  NS_ASSERT (written >= 8);
-  m_used += written;
-  m_data->m_dirtyEnd = m_used;
-}
-
-uint16_t
-PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
-{
-  NS_LOG_FUNCTION (this << item->next << item->prev << item->typeUid << item->size << item->chunkUid);
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_used != item->prev && m_used != item->next);
-  uint32_t typeUidSize = GetUleb128Size (item->typeUid);
-  uint32_t sizeSize = GetUleb128Size (item->size);
-  uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
-  if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
-    {
-      ReserveCopy (n);
-    }
-  uint8_t *buffer = &m_data->m_data[m_used];
-  Append16 (item->next, buffer);
-  buffer += 2;
-  Append16 (item->prev, buffer);
-  buffer += 2;
-  AppendValue (item->typeUid, buffer);
-  buffer += typeUidSize;
-  AppendValue (item->size, buffer);
-  buffer += sizeSize;
-  Append16 (item->chunkUid, buffer);
-  return n;
-}
-
-uint16_t
-PacketMetadata::AddBig (uint32_t next, uint32_t prev, 
-                        const PacketMetadata::SmallItem *item,
-                        const PacketMetadata::ExtraItem *extraItem)
-{
-  NS_LOG_FUNCTION (this << next << prev <<
-                   item->next << item->prev << item->typeUid << item->size << item->chunkUid <<
-                   extraItem->fragmentStart << extraItem->fragmentEnd << extraItem->packetUid);
-  NS_ASSERT (m_data != 0);
-  uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
-  NS_ASSERT (m_used != prev && m_used != next);
-
-  uint32_t typeUidSize = GetUleb128Size (typeUid);
-  uint32_t sizeSize = GetUleb128Size (item->size);
-  uint32_t fragStartSize = GetUleb128Size (extraItem->fragmentStart);
-  uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
-  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
-
-  if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
-    {
-      ReserveCopy (n);
+      ReserveCopy (0, n);
     }
-
-  uint8_t *buffer = &m_data->m_data[m_used];
-
-  Append16 (next, buffer);
-  buffer += 2;
-  Append16 (prev, buffer);
-  buffer += 2;
-  AppendValue (typeUid, buffer);
-  buffer += typeUidSize;
-  AppendValue (item->size, buffer);
-  buffer += sizeSize;
-  Append16 (item->chunkUid, buffer);
-  buffer += 2;
-  AppendValue (extraItem->fragmentStart, buffer);
-  buffer += fragStartSize;
-  AppendValue (extraItem->fragmentEnd, buffer);
-  buffer += fragEndSize;
-  Append32 (extraItem->packetUid, buffer);
-
-  return n;
 }
 
-void
-PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item, 
-                             PacketMetadata::ExtraItem *extraItem,
-                             uint32_t available)
-{
-  NS_LOG_FUNCTION (this <<
-                   item->next << item->prev << item->typeUid << item->size << item->chunkUid <<
-                   extraItem->fragmentStart << extraItem->fragmentEnd << extraItem->packetUid <<
-                   available);
-
-  NS_ASSERT (m_data != 0);
-  /* If the tail we want to replace is located at the end of the data array,
-   * and if there is extra room at the end of this array, then, 
-   * we can try to use that extra space to avoid falling in the slow
-   * path below.
-   */
-  if (m_tail + available == m_used &&
-      m_used == m_data->m_dirtyEnd)
-    {
-      available = m_data->m_size - m_tail;
-    }
-
-  uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
-  uint32_t typeUidSize = GetUleb128Size (typeUid);
-  uint32_t sizeSize = GetUleb128Size (item->size);
-  uint32_t fragStartSize = GetUleb128Size (extraItem->fragmentStart);
-  uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
-  uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
-
-  if (available >= n &&
-      m_data->m_count == 1)
-    {
-      uint8_t *buffer = &m_data->m_data[m_tail];
-      Append16 (item->next, buffer);
-      buffer += 2;
-      Append16 (item->prev, buffer);
-      buffer += 2;
-      AppendValue (typeUid, buffer);
-      buffer += typeUidSize;
-      AppendValue (item->size, buffer);
-      buffer += sizeSize;
-      Append16 (item->chunkUid, buffer);
-      buffer += 2;
-      AppendValue (extraItem->fragmentStart, buffer);
-      buffer += fragStartSize;
-      AppendValue (extraItem->fragmentEnd, buffer);
-      buffer += fragEndSize;
-      Append32 (extraItem->packetUid, buffer);
-      m_used = std::max (m_used, (uint16_t)(buffer - &m_data->m_data[0]));
-      m_data->m_dirtyEnd = m_used;
-      return;
-    }
-
-  /* Below is the slow path which is hit if the new tail we want 
-   * to append is bigger than the previous tail.
-   */
-
-  // create a copy of the packet without its tail.
-  PacketMetadata h (m_packetUid, 0);
-  uint16_t current = m_head;
-  while (current != 0xffff && current != m_tail)
-    {
-      struct PacketMetadata::SmallItem tmpItem;
-      PacketMetadata::ExtraItem tmpExtraItem;
-      ReadItems (current, &tmpItem, &tmpExtraItem);
-      uint16_t written = h.AddBig (0xffff, h.m_tail, 
-                                   &tmpItem, &tmpExtraItem);
-      h.UpdateTail (written);
-      current = tmpItem.next;
-    }
-  // append new tail.
-  uint16_t written = h.AddBig (0xffff, h.m_tail, item, extraItem);
-  h.UpdateTail (written);
-
-  *this = h;
-}
-
-
-uint32_t
-PacketMetadata::ReadItems (uint16_t current, 
-                           struct PacketMetadata::SmallItem *item,
-                           struct PacketMetadata::ExtraItem *extraItem) const
+bool
+PacketMetadata::IsStateOk (void) const
 {
-  NS_LOG_FUNCTION (this << current << item->chunkUid << item->prev << item->next << item->size <<
-                        item->typeUid << extraItem->fragmentEnd << extraItem->fragmentStart <<
-                        extraItem->packetUid);
-  NS_ASSERT (current <= m_data->m_size);
-  const uint8_t *buffer = &m_data->m_data[current];
-  item->next = buffer[0];
-  item->next |= (buffer[1]) << 8;
-  item->prev = buffer[2];
-  item->prev |= (buffer[3]) << 8;
-  buffer += 4;
-  item->typeUid = ReadUleb128 (&buffer);
-  item->size = ReadUleb128 (&buffer);
-  item->chunkUid = buffer[0];
-  item->chunkUid |= (buffer[1]) << 8;
-  buffer += 2;
-
-  bool isExtra = (item->typeUid & 0x1) == 0x1;
-  if (isExtra)
+  NS_LOG_FUNCTION (this);
+  bool ok = m_start <= m_end && m_end <= m_data->m_size;
+  if (ok && m_start != m_end)
     {
-      extraItem->fragmentStart = ReadUleb128 (&buffer);
-      extraItem->fragmentEnd = ReadUleb128 (&buffer);
-      extraItem->packetUid = buffer[0];
-      extraItem->packetUid |= buffer[1] << 8;
-      extraItem->packetUid |= buffer[2] << 16;
-      extraItem->packetUid |= buffer[3] << 24;
-      buffer += 4;
+      ok &= m_data->m_dirtyStart <= m_start && m_end <= m_data->m_dirtyEnd;
     }
-  else
+  for (uint16_t i = m_start; ok && i < m_end; i++)
     {
-      extraItem->fragmentStart = 0;
-      extraItem->fragmentEnd = item->size;
-      extraItem->packetUid = m_packetUid;
+      struct PacketMetadata::Record record;
+      GetRecord (i, &record);
+      ok &= record.fragmentStart <= record.fragmentEnd;
+      ok &= record.fragmentEnd <= record.size;
     }
-  NS_ASSERT (buffer <= &m_data->m_data[m_data->m_size]);
-  return buffer - &m_data->m_data[current];
+  return ok;
 }
 
 struct PacketMetadata::Data *
@@ -576,10 +213,14 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  if (m_freeList == 0 && m_freeListState.Use (&PacketMetadata::DestroyFreeList))
     {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
+      m_freeList = new DataFreeList ();
+    }
+  while (m_freeList != 0 && !m_freeList->empty ()) 
+    {
+      struct PacketMetadata::Data *data = m_freeList->back ();
+      m_freeList->pop_back ();
       if (data->m_size >= size) 
         {
           NS_LOG_LOGIC ("create found size="<<data->m_size);
@@ -597,21 +238,25 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || !m_freeListState.Use (&PacketMetadata::DestroyFreeList))
     {
       PacketMetadata::Deallocate (data);
       return;
     } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
+  if (m_freeList == 0)
+    {
+      m_freeList = new DataFreeList ();
+    }
+  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList->size ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
+  if (m_freeList->size () > 1000 ||
       data->m_size < m_maxSize) 
     {
       PacketMetadata::Deallocate (data);
     } 
   else 
     {
-      m_freeList.push_back (data);
+      m_freeList->push_back (data);
     }
 }
 
@@ -619,16 +264,13 @@ struct PacketMetadata::Data *
 PacketMetadata::Allocate (uint32_t n)
 {
   NS_LOG_FUNCTION (n);
-  uint32_t size = sizeof (struct Data);
-  if (n <= PACKET_METADATA_DATA_M_DATA_SIZE)
-    {
-      n = PACKET_METADATA_DATA_M_DATA_SIZE;
-    }
-  size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
+  NS_ASSERT (n >= 1 && n <= 0xffff);
+  uint32_t size = sizeof (struct Data) + (n - 1) * sizeof (struct Record);
   uint8_t *buf = new uint8_t [size];
   struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
   data->m_size = n;
   data->m_count = 1;
+  data->m_dirtyStart = 0;
   data->m_dirtyEnd = 0;
   return data;
 }
@@ -670,15 +312,23 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       return;
     }
 
-  struct PacketMetadata::SmallItem item;
-  item.next = m_head;
-  item.prev = 0xffff;
-  item.typeUid = uid;
-  item.size = size;
-  item.chunkUid = m_chunkUid;
+  PrepareHead ();
+  m_start--;
+  struct PacketMetadata::Record *record = &m_data->m_records[m_start];
+  record->packetUid = m_packetUid;
+  record->typeUid = uid;
+  record->size = size;
+  record->fragmentStart = 0;
+  record->fragmentEnd = size;
+  record->chunkUid = m_chunkUid;
   m_chunkUid++;
-  uint16_t written = AddSmall (&item);
-  UpdateHead (written);
+  m_data->m_dirtyStart = m_start;
+  m_headStart = 0;
+  if (m_end == m_start + 1)
+    {
+      m_tailEnd = size;
+      m_data->m_dirtyEnd = std::max (m_data->m_dirtyEnd, m_end);
+    }
 }
 void 
 PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
@@ -691,11 +341,8 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
-  struct PacketMetadata::SmallItem item;
-  struct PacketMetadata::ExtraItem extraItem;
-  uint32_t read = ReadItems (m_head, &item, &extraItem);
-  if ((item.typeUid & 0xfffffffe) != uid ||
-      item.size != size)
+  struct PacketMetadata::Record record;
+  if (m_start == m_end)
     {
       if (m_enableChecking)
         {
@@ -703,28 +350,30 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
         }
       return;
     }
-  else if (item.typeUid != uid &&
-           (extraItem.fragmentStart != 0 ||
-            extraItem.fragmentEnd != size))
+  GetRecord (m_start, &record);
+  if ((record.typeUid & 0xfffffffe) != uid ||
+      record.size != size)
     {
       if (m_enableChecking)
         {
-          NS_FATAL_ERROR ("Removing incomplete header.");
+          NS_FATAL_ERROR ("Removing unexpected header.");
         }
       return;
     }
-  if (m_head + read == m_used)
+  else if (record.typeUid != uid &&
+           (record.fragmentStart != 0 ||
+            record.fragmentEnd != size))
     {
-      m_used = m_head;
-    }
-  if (m_head == m_tail)
-    {
-      m_head = 0xffff;
-      m_tail = 0xffff;
+      if (m_enableChecking)
+        {
+          NS_FATAL_ERROR ("Removing incomplete header.");
+        }
+      return;
     }
-  else
+  m_start++;
+  if (m_start != m_end)
     {
-      m_head = item.next;
+      m_headStart = m_data->m_records[m_start].fragmentStart;
     }
   NS_ASSERT (IsStateOk ());
 }
@@ -739,15 +388,23 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
-  struct PacketMetadata::SmallItem item;
-  item.next = 0xffff;
-  item.prev = m_tail;
-  item.typeUid = uid;
-  item.size = size;
-  item.chunkUid = m_chunkUid;
+  PrepareTail (1);
+  struct PacketMetadata::Record *record = &m_data->m_records[m_end];
+  record->packetUid = m_packetUid;
+  record->typeUid = uid;
+  record->size = size;
+  record->fragmentStart = 0;
+  record->fragmentEnd = size;
+  record->chunkUid = m_chunkUid;
   m_chunkUid++;
-  uint16_t written = AddSmall (&item);
-  UpdateTail (written);
+  m_end++;
+  m_data->m_dirtyEnd = m_end;
+  m_tailEnd = size;
+  if (m_end == m_start + 1)
+    {
+      m_headStart = 0;
+      m_data->m_dirtyStart = std::min (m_data->m_dirtyStart, m_start);
+    }
   NS_ASSERT (IsStateOk ());
 }
 void 
@@ -761,11 +418,8 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
-  struct PacketMetadata::SmallItem item;
-  struct PacketMetadata::ExtraItem extraItem;
-  uint32_t read = ReadItems (m_tail, &item, &extraItem);
-  if ((item.typeUid & 0xfffffffe) != uid ||
-      item.size != size)
+  struct PacketMetadata::Record record;
+  if (m_start == m_end)
     {
       if (m_enableChecking)
         {
@@ -773,28 +427,30 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
         }
       return;
     }
-  else if (item.typeUid != uid &&
-           (extraItem.fragmentStart != 0 ||
-            extraItem.fragmentEnd != size))
+  GetRecord (m_end - 1, &record);
+  if ((record.typeUid & 0xfffffffe) != uid ||
+      record.size != size)
     {
       if (m_enableChecking)
         {
-          NS_FATAL_ERROR ("Removing incomplete trailer.");
+          NS_FATAL_ERROR ("Removing unexpected trailer.");
         }
       return;
     }
-  if (m_tail + read == m_used)
+  else if (record.typeUid != uid &&
+           (record.fragmentStart != 0 ||
+            record.fragmentEnd != size))
     {
-      m_used = m_tail;
-    }
-  if (m_head == m_tail)
-    {
-      m_head = 0xffff;
-      m_tail = 0xffff;
+      if (m_enableChecking)
+        {
+          NS_FATAL_ERROR ("Removing incomplete trailer.");
+        }
+      return;
     }
-  else
+  m_end--;
+  if (m_start != m_end)
     {
-      m_tail = item.prev;
+      m_tailEnd = m_data->m_records[m_end - 1].fragmentEnd;
     }
   NS_ASSERT (IsStateOk ());
 }
@@ -808,72 +464,82 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
-  if (m_tail == 0xffff)
+  if (m_start == m_end)
     {
-      // We have no items so 'AddAtEnd' is 
+      // We have no records so 'AddAtEnd' is 
       // equivalent to self-assignment.
       *this = o;
       NS_ASSERT (IsStateOk ());
       return;
     }
-  if (o.m_head == 0xffff)
+  if (o.m_start == o.m_end)
     {
-      NS_ASSERT (o.m_tail == 0xffff);
       // we have nothing to append.
       return;
     }
-  NS_ASSERT (m_head != 0xffff && m_tail != 0xffff);
-
-  // We read the current tail because we are going to append
-  // after this item.
-  struct PacketMetadata::SmallItem tailItem;
-  PacketMetadata::ExtraItem tailExtraItem;
-  uint32_t tailSize = ReadItems (m_tail, &tailItem, &tailExtraItem);
+  if (&o == this)
+    {
+      PacketMetadata copy = o;
+      AddAtEnd (copy);
+      return;
+    }
 
-  uint16_t current;
-  struct PacketMetadata::SmallItem item;
-  PacketMetadata::ExtraItem extraItem;
-  o.ReadItems (o.m_head, &item, &extraItem);
-  if (extraItem.packetUid == tailExtraItem.packetUid &&
-      item.typeUid == tailItem.typeUid &&
-      item.chunkUid == tailItem.chunkUid &&
-      item.size == tailItem.size &&
-      extraItem.fragmentStart == tailExtraItem.fragmentEnd)
+  struct PacketMetadata::Record tail;
+  GetRecord (m_end - 1, &tail);
+  struct PacketMetadata::Record head;
+  o.GetRecord (o.m_start, &head);
+  uint16_t first = o.m_start;
+  bool isMerged = false;
+  if (head.packetUid == tail.packetUid &&
+      head.typeUid == tail.typeUid &&
+      head.chunkUid == tail.chunkUid &&
+      head.size == tail.size &&
+      head.fragmentStart == tail.fragmentEnd)
     {
       /* If the previous tail came from the same header as
-       * the next item we want to append to our array, then, 
-       * we merge them and attempt to reuse the previous tail's
-       * location.
+       * the next record we want to append to our array, then, 
+       * we merge them by extending the fragment of our tail.
        */
-      tailExtraItem.fragmentEnd = extraItem.fragmentEnd;
-      ReplaceTail (&tailItem, &tailExtraItem, tailSize);
-      if (o.m_head == o.m_tail)
+      m_tailEnd = head.fragmentEnd;
+      first++;
+      isMerged = true;
+      if (first == o.m_end)
         {
-          // there is only one item to append to self from other.
+          // there is only one record to append to self from other.
+          NS_ASSERT (IsStateOk ());
           return;
         }
-      current = item.next;
     }
-  else
+
+  if (o.m_data == m_data && first == m_end &&
+      o.m_packetUid == m_packetUid &&
+      (isMerged ||
+       (m_tailEnd == m_data->m_records[m_end - 1].fragmentEnd &&
+        o.m_headStart == m_data->m_records[first].fragmentStart)))
     {
-      current = o.m_head;
+      /* The other records follow ours in the data, as when the
+       * fragments of a packet are reassembled in order: reference
+       * them. */
+      m_end = o.m_end;
+      m_tailEnd = o.m_tailEnd;
+      NS_ASSERT (IsStateOk ());
+      return;
     }
 
   /* Now that we have merged our current tail with the head of the
-   * next packet, we just append all items from the next packet
+   * next packet, we just append all records from the next packet
    * to the current packet.
    */
-  while (current != 0xffff)
+  PrepareTail (o.m_end - first);
+  for (uint16_t i = first; i < o.m_end; i++)
     {
-      o.ReadItems (current, &item, &extraItem);
-      uint16_t written = AddBig (0xffff, m_tail, &item, &extraItem);
-      UpdateTail (written);
-      if (current == o.m_tail)
-        {
-          break;
-        }
-      current = item.next;
+      struct PacketMetadata::Record *record = &m_data->m_records[m_end];
+      o.GetRecord (i, record);
+      record->typeUid |= 0x1;
+      m_end++;
     }
+  m_data->m_dirtyEnd = m_end;
+  m_tailEnd = m_data->m_records[m_end - 1].fragmentEnd;
   NS_ASSERT (IsStateOk ());
 }
 void
@@ -898,53 +564,27 @@ PacketMetadata::RemoveAtStart (uint32_t start)
     }
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
-  uint16_t current = m_head;
-  while (current != 0xffff && leftToRemove > 0)
-    {
-      struct PacketMetadata::SmallItem item;
-      PacketMetadata::ExtraItem extraItem;
-      ReadItems (current, &item, &extraItem);
-      uint32_t itemRealSize = extraItem.fragmentEnd - extraItem.fragmentStart;
-      if (itemRealSize <= leftToRemove)
+  while (m_start != m_end && leftToRemove > 0)
+    {
+      uint32_t fragmentEnd = (m_start == m_end - 1) ?
+        m_tailEnd : m_data->m_records[m_start].fragmentEnd;
+      uint32_t recordRealSize = fragmentEnd - m_headStart;
+      if (recordRealSize <= leftToRemove)
         {
-          // remove from list.
-          if (m_head == m_tail)
-            {
-              m_head = 0xffff;
-              m_tail = 0xffff;
-            }
-          else
+          // remove the record.
+          m_start++;
+          if (m_start != m_end)
             {
-              m_head = item.next;
+              m_headStart = m_data->m_records[m_start].fragmentStart;
             }
-          leftToRemove -= itemRealSize;
+          leftToRemove -= recordRealSize;
         }
       else
         {
-          // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
-          extraItem.fragmentStart += leftToRemove;
+          // fragment the record.
+          m_headStart += leftToRemove;
           leftToRemove = 0;
-          uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
-                                              &item, &extraItem);
-          fragment.UpdateTail (written);
-          while (current != 0xffff && current != m_tail)
-            {
-              current = item.next;
-              ReadItems (current, &item, &extraItem);
-              written = fragment.AddBig (0xffff, fragment.m_tail,
-                                         &item, &extraItem);
-              fragment.UpdateTail (written);
-            }
-          *this = fragment;
         }
-      NS_ASSERT (item.size >= extraItem.fragmentEnd - extraItem.fragmentStart &&
-                 extraItem.fragmentStart <= extraItem.fragmentEnd);
-      if (current == m_tail)
-        {
-          break;
-        }
-      current = item.next;
     }
   NS_ASSERT (leftToRemove == 0);
   NS_ASSERT (IsStateOk ());
@@ -962,80 +602,31 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
-  uint16_t current = m_tail;
-  while (current != 0xffff && leftToRemove > 0)
-    {
-      struct PacketMetadata::SmallItem item;
-      PacketMetadata::ExtraItem extraItem;
-      ReadItems (current, &item, &extraItem);
-      uint32_t itemRealSize = extraItem.fragmentEnd - extraItem.fragmentStart;
-      if (itemRealSize <= leftToRemove)
+  while (m_start != m_end && leftToRemove > 0)
+    {
+      uint32_t fragmentStart = (m_start == m_end - 1) ?
+        m_headStart : m_data->m_records[m_end - 1].fragmentStart;
+      uint32_t recordRealSize = m_tailEnd - fragmentStart;
+      if (recordRealSize <= leftToRemove)
         {
-          // remove from list.
-          if (m_head == m_tail)
+          // remove the record.
+          m_end--;
+          if (m_start != m_end)
             {
-              m_head = 0xffff;
-              m_tail = 0xffff;
+              m_tailEnd = m_data->m_records[m_end - 1].fragmentEnd;
             }
-          else
-            {
-              m_tail = item.prev;
-            }
-          leftToRemove -= itemRealSize;
+          leftToRemove -= recordRealSize;
         }
       else
         {
-          // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
-          NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
-          extraItem.fragmentEnd -= leftToRemove;
+          // fragment the record.
+          m_tailEnd -= leftToRemove;
           leftToRemove = 0;
-          uint16_t written = fragment.AddBig (fragment.m_head, 0xffff,
-                                              &item, &extraItem);
-          fragment.UpdateHead (written);
-          while (current != 0xffff && current != m_head)
-            {
-              current = item.prev;
-              ReadItems (current, &item, &extraItem);
-              written = fragment.AddBig (fragment.m_head, 0xffff,
-                                         &item, &extraItem);
-              fragment.UpdateHead (written);
-            }
-          *this = fragment;
         }
-      NS_ASSERT (item.size >= extraItem.fragmentEnd - extraItem.fragmentStart &&
-                 extraItem.fragmentStart <= extraItem.fragmentEnd);
-      if (current == m_head)
-        {
-          break;
-        }
-      current = item.prev;
     }
   NS_ASSERT (leftToRemove == 0);
   NS_ASSERT (IsStateOk ());
 }
-uint32_t
-PacketMetadata::GetTotalSize (void) const
-{
-  NS_LOG_FUNCTION (this);
-  uint32_t totalSize = 0;
-  uint16_t current = m_head;
-  uint16_t tail = m_tail;
-  while (current != 0xffff)
-    {
-      struct PacketMetadata::SmallItem item;
-      PacketMetadata::ExtraItem extraItem;
-      ReadItems (current, &item, &extraItem);
-      totalSize += extraItem.fragmentEnd - extraItem.fragmentStart;
-      if (current == tail)
-        {
-          break;
-        }
-      NS_ASSERT (current != item.next);
-      current = item.next;
-    }
-  return totalSize;
-}
 
 uint64_t 
 PacketMetadata::GetUid (void) const
@@ -1052,7 +643,7 @@ PacketMetadata::BeginItem (Buffer buffer) const
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
   : m_metadata (metadata),
     m_buffer (buffer),
-    m_current (metadata->m_head),
+    m_current (metadata->m_start != metadata->m_end ? metadata->m_start : 0xffff),
     m_offset (0),
     m_hasReadTail (false)
 {
@@ -1077,20 +668,19 @@ PacketMetadata::ItemIterator::Next (void)
 {
   NS_LOG_FUNCTION (this);
   struct PacketMetadata::Item item;
-  struct PacketMetadata::SmallItem smallItem;
-  struct PacketMetadata::ExtraItem extraItem;
-  m_metadata->ReadItems (m_current, &smallItem, &extraItem);
-  if (m_current == m_metadata->m_tail)
+  struct PacketMetadata::Record record;
+  m_metadata->GetRecord (m_current, &record);
+  if (m_current == m_metadata->m_end - 1)
     {
       m_hasReadTail = true;
     }
-  m_current = smallItem.next;
-  uint32_t uid = (smallItem.typeUid & 0xfffffffe) >> 1;
+  m_current++;
+  uint32_t uid = (record.typeUid & 0xfffffffe) >> 1;
   item.tid.SetUid (uid);
-  item.currentTrimedFromStart = extraItem.fragmentStart;
-  item.currentTrimedFromEnd = extraItem.fragmentEnd - smallItem.size;
-  item.currentSize = extraItem.fragmentEnd - extraItem.fragmentStart;
-  if (extraItem.fragmentStart != 0 || extraItem.fragmentEnd != smallItem.size)
+  item.currentTrimedFromStart = record.fragmentStart;
+  item.currentTrimedFromEnd = record.fragmentEnd - record.size;
+  item.currentSize = record.fragmentEnd - record.fragmentStart;
+  if (record.fragmentStart != 0 || record.fragmentEnd != record.size)
     {
       item.isFragment = true;
     }
@@ -1121,7 +711,7 @@ PacketMetadata::ItemIterator::Next (void)
       if (!item.isFragment)
         {
           ns3::Buffer tmp = m_buffer;
-          tmp.RemoveAtEnd (tmp.GetSize () - (m_offset + smallItem.size));
+          tmp.RemoveAtEnd (tmp.GetSize () - (m_offset + record.size));
           tmp.RemoveAtStart (tmp.GetSize () - item.currentSize);
           item.current = tmp.End ();
         }
@@ -1130,7 +720,7 @@ PacketMetadata::ItemIterator::Next (void)
     {
       NS_ASSERT (false);
     }
-  m_offset += extraItem.fragmentEnd - extraItem.fragmentStart;
+  m_offset += record.fragmentEnd - record.fragmentStart;
   return item;
 }
 
@@ -1151,13 +741,11 @@ PacketMetadata::GetSerializedSize (void) const
       return totalSize;
     }
 
-  struct PacketMetadata::SmallItem item;
-  struct PacketMetadata::ExtraItem extraItem;
-  uint32_t current = m_head;
-  while (current != 0xffff)
+  struct PacketMetadata::Record record;
+  for (uint16_t current = m_start; current < m_end; current++)
     {
-      ReadItems (current, &item, &extraItem);
-      uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
+      GetRecord (current, &record);
+      uint32_t uid = (record.typeUid & 0xfffffffe) >> 1;
       if (uid == 0)
         {
           totalSize += 4;
@@ -1169,12 +757,6 @@ PacketMetadata::GetSerializedSize (void) const
           totalSize += 4 + tid.GetName ().size ();
         }
       totalSize += 1 + 4 + 2 + 4 + 4 + 8;
-      if (current == m_tail)
-        {
-          break;
-        }
-      NS_ASSERT (current != item.next);
-      current = item.next;
     }
   return totalSize;
 }
@@ -1191,18 +773,16 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
       return 0;
     }
 
-  struct PacketMetadata::SmallItem item;
-  struct PacketMetadata::ExtraItem extraItem;
-  uint32_t current = m_head;
-  while (current != 0xffff)
+  struct PacketMetadata::Record record;
+  for (uint16_t current = m_start; current < m_end; current++)
     {
-      ReadItems (current, &item, &extraItem);
+      GetRecord (current, &record);
       NS_LOG_LOGIC ("bytesWritten=" << static_cast<uint32_t> (buffer - start) << ", typeUid="<<
-                    item.typeUid << ", size="<<item.size<<", chunkUid="<<item.chunkUid<<
-                    ", fragmentStart="<<extraItem.fragmentStart<<", fragmentEnd="<<
-                    extraItem.fragmentEnd<< ", packetUid="<<extraItem.packetUid);
+                    record.typeUid << ", size="<<record.size<<", chunkUid="<<record.chunkUid<<
+                    ", fragmentStart="<<record.fragmentStart<<", fragmentEnd="<<
+                    record.fragmentEnd<< ", packetUid="<<record.packetUid);
 
-      uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
+      uint32_t uid = (record.typeUid & 0xfffffffe) >> 1;
       if (uid != 0)
         {
           TypeId tid;
@@ -1230,50 +810,42 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
             }
         }
 
-      uint8_t isBig = item.typeUid & 0x1;
+      uint8_t isBig = record.typeUid & 0x1;
       buffer = AddToRawU8 (isBig, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU32 (item.size, start, buffer, maxSize);
+      buffer = AddToRawU32 (record.size, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU16 (item.chunkUid, start, buffer, maxSize);
+      buffer = AddToRawU16 (record.chunkUid, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU32 (extraItem.fragmentStart, start, buffer, maxSize);
+      buffer = AddToRawU32 (record.fragmentStart, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU32 (extraItem.fragmentEnd, start, buffer, maxSize);
+      buffer = AddToRawU32 (record.fragmentEnd, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
 
-      buffer = AddToRawU64 (extraItem.packetUid, start, buffer, maxSize);
+      buffer = AddToRawU64 (record.packetUid, start, buffer, maxSize);
       if (buffer == 0) 
         {
           return 0;
         }
-
-      if (current == m_tail)
-        {
-          break;
-        }
-
-      NS_ASSERT (current != item.next);
-      current = item.next;
     }
 
   NS_ASSERT (static_cast<uint32_t> (buffer - start) == maxSize);
@@ -1290,8 +862,7 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
   buffer = ReadFromRawU64 (m_packetUid, start, buffer, size);
   desSize -= 8;
 
-  struct PacketMetadata::SmallItem item = {0};
-  struct PacketMetadata::ExtraItem extraItem = {0};
+  struct PacketMetadata::Record record = {0};
   while (desSize > 0)
     {
       uint32_t uidStringSize = 0;
@@ -1319,23 +890,31 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
       uint8_t isBig = 0;
       buffer = ReadFromRawU8 (isBig, start, buffer, size);
       desSize--;
-      item.typeUid = (uid << 1) | isBig;
-      buffer = ReadFromRawU32 (item.size, start, buffer, size);
+      record.typeUid = (uid << 1) | isBig;
+      buffer = ReadFromRawU32 (record.size, start, buffer, size);
       desSize -= 4;
-      buffer = ReadFromRawU16 (item.chunkUid, start, buffer, size);
+      buffer = ReadFromRawU16 (record.chunkUid, start, buffer, size);
       desSize -= 2;
-      buffer = ReadFromRawU32 (extraItem.fragmentStart, start, buffer, size);
+      buffer = ReadFromRawU32 (record.fragmentStart, start, buffer, size);
       desSize -= 4;
-      buffer = ReadFromRawU32 (extraItem.fragmentEnd, start, buffer, size);
+      buffer = ReadFromRawU32 (record.fragmentEnd, start, buffer, size);
       desSize -= 4;
-      buffer = ReadFromRawU64 (extraItem.packetUid, start, buffer, size);
+      buffer = ReadFromRawU64 (record.packetUid, start, buffer, size);
       desSize -= 8;
-      NS_LOG_LOGIC ("size=" << size << ", typeUid="<<item.typeUid <<
-                    ", size="<<item.size<<", chunkUid="<<item.chunkUid<<
-                    ", fragmentStart="<<extraItem.fragmentStart<<", fragmentEnd="<<
-                    extraItem.fragmentEnd<< ", packetUid="<<extraItem.packetUid);
-      uint32_t tmp = AddBig (0xffff, m_tail, &item, &extraItem);
-      UpdateTail (tmp);
+      NS_LOG_LOGIC ("size=" << size << ", typeUid="<<record.typeUid <<
+                    ", size="<<record.size<<", chunkUid="<<record.chunkUid<<
+                    ", fragmentStart="<<record.fragmentStart<<", fragmentEnd="<<
+                    record.fragmentEnd<< ", packetUid="<<record.packetUid);
+      record.typeUid |= 0x1;
+      PrepareTail (1);
+      m_data->m_records[m_end] = record;
+      m_end++;
+      m_data->m_dirtyEnd = m_end;
+      if (m_start == m_end - 1)
+        {
+          m_headStart = record.fragmentStart;
+        }
+      m_tailEnd = record.fragmentEnd;
     }
   NS_ASSERT (desSize == 0);
   return (desSize !=0) ? 0 : 1;
@@ -26,6 +26,7 @@
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
+#include "ns3/thread-exit.h"
 #include "buffer.h"
 
 namespace ns3 {
@@ -44,14 +45,12 @@ class Trailer;
  * an implementation of the Packet::Print methods which uses
  * the metadata to analyse the content of the packet's buffer.
  *
- * To achieve this, this class maintains a linked list of so-called
- * "items", each of which represents a header or a trailer, or 
- * payload, or a fragment of any of these. Each item contains a "next"
- * and a "prev" field which point to the next and previous entries
- * in the linked list. The PacketMetadata class maintains a pair
- * of pointers to the head and the tail of the linked list.
+ * To achieve this, this class maintains an array of so-called
+ * "records", each of which represents a header or a trailer, or
+ * payload, or a fragment of any of these, in the order of the bytes
+ * of the packet.
  *
- * Each entry in the list also maintains:
+ * Each record maintains:
  *   - its native size (the size it had when it was first added
  *     to the packet)
  *   - its type: identifies what kind of header, what kind of trailer,
@@ -60,20 +59,18 @@ class Trailer;
  *   - the start and end of the area represented by a fragment
  *     if it is one.
  *
- * This linked list is flattened in a byte buffer stored in
- * struct PacketMetadata::Data. Each entry of the linked list is
- * identified by an offset which identifies the first byte of the
- * entry from the start of the data buffer. The size of this data
- * buffer is 2^16-1 bytes maximum which somewhat limits the number
- * of entries which can be stored in this linked list but it is
- * quite unlikely to hit this limit in practice.
- *
- * Each item of the linked list is a variable-sized byte buffer
- * made of a number of fields. Some of these fields are stored
- * as fixed-size 32 bit integers, others as fixed-size 16 bit 
- * integers, and some others as variable-size 32-bit integers.
- * The variable-size 32 bit integers are stored using the uleb128
- * encoding.
+ * The records have a fixed size and are stored in
+ * struct PacketMetadata::Data, which is shared by the copies and the
+ * fragments of a packet. Each PacketMetadata instance references the
+ * range of records [m_start, m_end) of the data: headers are added
+ * before m_start and trailers after m_end, like the bytes of a
+ * Buffer, and the data is copied only if another instance
+ * references the area in which a record must be written (see
+ * Buffer for the "dirty area" which detects it). The fragments of
+ * the first and last records are kept in the instance rather than
+ * in the data, so that removing bytes at the start or at the end of
+ * a packet never copies the data. The data holds 2^16-1 records at
+ * most, which it is quite unlikely to hit in practice.
  */
 class PacketMetadata 
 {
@@ -146,7 +143,7 @@ public:
 private:
     const PacketMetadata *m_metadata; //!< pointer to the metadata
     Buffer m_buffer; //!< buffer the metadata refers to
-    uint16_t m_current; //!< current position
+    uint16_t m_current; //!< index of the current record
     uint32_t m_offset; //!< offset
     bool m_hasReadTail; //!< true if the metadata tail has been read
   };
@@ -400,95 +397,70 @@ private:
                                   uint32_t maxSize);
 
   /**
-   * the size of PacketMetadata::Data::m_data such that the total size
-   * of PacketMetadata::Data is 16 bytes
-   */ 
-#define PACKET_METADATA_DATA_M_DATA_SIZE 8
-  
+   * the number of records of a new PacketMetadata::Data
+   */
+#define PACKET_METADATA_DATA_MIN_RECORDS 8
+
   /**
-   * Data structure
+   * \brief Record structure
    */
-  struct Data {
-    /** number of references to this struct Data instance. */
-    uint32_t m_count;
-    /** size (in bytes) of m_data buffer below */
-    uint16_t m_size;
-    /** max of the m_used field over all objects which
-     * reference this struct Data instance */
-    uint16_t m_dirtyEnd;
-    /** variable-sized buffer of bytes */
-    uint8_t m_data[PACKET_METADATA_DATA_M_DATA_SIZE]; 
-  };
-  /* Note that since the next and prev fields are 16 bit integers
-     and since the value 0xffff is reserved to identify the 
-     fact that the end or the start of the list is reached,
-     only a limited number of elements can be stored in 
-     a m_data byte buffer.
-   */
-  /**
-   * \brief SmallItem structure
-   */
-  struct SmallItem {
-    /** offset (in bytes) from start of m_data buffer
-       to next element in linked list. value is 0xffff 
-       if next element does not exist.
-       stored as a fixed-size 16 bit integer.
-    */
-    uint16_t next;
-    /** offset (in bytes) from start of m_data buffer
-       to previous element in linked list. value is 0xffff 
-       if previous element does not exist.
-       stored as a fixed-size 16 bit integer.
+  struct Record {
+    /** the packetUid of the packet in which this header or trailer
+       was first added. It could be different from the m_packetUid
+       field if the user has aggregated multiple packets into one.
+       Valid only if the low bit of typeUid is one: it is otherwise
+       the m_packetUid field.
      */
-    uint16_t prev;
+    uint64_t packetUid;
     /** the high 31 bits of this field identify the
        type of the header or trailer represented by 
-       this item: the value zero represents payload.
-       If the low bit of this uid is one, an ExtraItem
-       structure follows this SmallItem structure.
-       stored as a variable-size 32 bit integer.
+       this record: the value zero represents payload.
+       The low bit of this uid is one if this record is a fragment
+       or comes from another packet.
      */
     uint32_t typeUid;
     /** the size (in bytes) of the header or trailer represented
-       by this element.
-       stored as a variable-size 32 bit integer.
+       by this record.
      */
     uint32_t size;
+    /** offset (in bytes) from start of original header to
+       the start of the fragment still present.
+     */
+    uint32_t fragmentStart;
+    /** offset (in bytes) from start of original header to
+       the end of the fragment still present.
+     */
+    uint32_t fragmentEnd;
     /** this field tries to uniquely identify each header or
        trailer _instance_ while the typeUid field uniquely
        identifies each header or trailer _type_. This field
-       is used to test whether two items are equal in the sense 
+       is used to test whether two records are equal in the sense 
        that they represent the same header or trailer instance.
        That equality test is based on the typeUid and chunkUid
        fields so, the likelyhood that two header instances 
        share the same chunkUid _and_ typeUid is very small 
        unless they are really representations of the same header
        instance.
-       stored as a fixed-size 16 bit integer.
      */
     uint16_t chunkUid;
   };
 
   /**
-   * \brief ExtraItem structure
+   * Data structure
    */
-  struct ExtraItem {
-    /** offset (in bytes) from start of original header to
-       the start of the fragment still present.
-       stored as a variable-size 32 bit integer.
-     */
-    uint32_t fragmentStart;
-    /** offset (in bytes) from start of original header to
-       the end of the fragment still present.
-       stored as a variable-size 32 bit integer.
-     */
-    uint32_t fragmentEnd;
-    /** the packetUid of the packet in which this header or trailer
-       was first added. It could be different from the m_packetUid
-       field if the user has aggregated multiple packets into one.
-       stored as a fixed-size 64 bit integer.
-     */
-    uint64_t packetUid;
+  struct Data {
+    /** number of references to this struct Data instance. */
+    uint32_t m_count;
+    /** number of records of the m_records array below */
+    uint16_t m_size;
+    /** min of the m_start field over all objects which
+     * reference this struct Data instance */
+    uint16_t m_dirtyStart;
+    /** max of the m_end field over all objects which
+     * reference this struct Data instance */
+    uint16_t m_dirtyEnd;
+    /** variable-sized array of records */
+    struct Record m_records[1];
   };
 
   /**
@@ -500,115 +472,44 @@ public:
     ~DataFreeList ();
   };
 
-  friend DataFreeList::~DataFreeList ();
-  friend class ItemIterator;
-
-  PacketMetadata ();
-
   /**
-   * \brief Add a SmallItem
-   * \param item the SmallItem to add
-   * \return added size
-   */
-  inline uint16_t AddSmall (const PacketMetadata::SmallItem *item);
-  /**
-   * \brief Add a "Big" Item (a SmallItem plus an ExtraItem)
-   * \param head the head
-   * \param tail the tail
-   * \param item the SmallItem to add
-   * \param extraItem the ExtraItem to add
-   * \return added size
-   */
-  uint16_t AddBig (uint32_t head, uint32_t tail,
-                   const PacketMetadata::SmallItem *item, 
-                   const PacketMetadata::ExtraItem *extraItem);
-  /**
-   * \brief Replace the tail
-   * \param item the item data to write
-   * \param extraItem the extra item data to write
-   * \param available the number of bytes which can
-   *        be written without having to rewrite the buffer entirely.
-   */
-  void ReplaceTail (PacketMetadata::SmallItem *item, 
-                    PacketMetadata::ExtraItem *extraItem,
-                    uint32_t available);
-  /**
-   * \brief Update the head
-   * \param written the used bytes
-   */
-  inline void UpdateHead (uint16_t written);
-  /**
-   * \brief Update the tail
-   * \param written the used bytes
-   */
-  inline void UpdateTail (uint16_t written);
-
-  /**
-   * \brief Get the ULEB128 (Unsigned Little Endian Base 128) size
-   * \param value the value
-   * \returns the value's ULEB128 size
-   */
-  inline uint32_t GetUleb128Size (uint32_t value) const;
-  /**
-   * \brief Read a ULEB128 (Unsigned Little Endian Base 128) coded number
-   * \param pBuffer the buffer to read from
-   * \returns the value
-   */
-  uint32_t ReadUleb128 (const uint8_t **pBuffer) const;
-  /**
-   * \brief Append a 16-bit value to the buffer
-   * \param value the value to add
-   * \param buffer the buffer to write to
-   */
-  inline void Append16 (uint16_t value, uint8_t *buffer);
-  /**
-   * \brief Append a 32-bit value to the buffer
-   * \param value the value to add
-   * \param buffer the buffer to write to
-   */
-  inline void Append32 (uint32_t value, uint8_t *buffer);
-  /**
-   * \brief Append a value to the buffer
-   * \param value the value to add
-   * \param buffer the buffer to write to
-   */
-  inline void AppendValue (uint32_t value, uint8_t *buffer);
-  /**
-   * \brief Append a value to the buffer - extra
+   * \brief Empties the free list of the main thread at exit
    *
-   * This function is called by AppendValue
-   *
-   * \param value the value to add
-   * \param buffer the buffer to write to
+   * The lists of the other threads are emptied by DestroyFreeList
+   * when the threads exit.
    */
-  void AppendValueExtra (uint32_t value, uint8_t *buffer);
+  struct LocalStaticDestructor
+  {
+    ~LocalStaticDestructor ();
+  };
+
+  friend struct LocalStaticDestructor;
+  friend class ItemIterator;
+
+  PacketMetadata ();
 
   /**
-   * \brief Reserve space
-   * \param n space to reserve
+   * \brief Read a record, with the fragment of the first and last
+   * records of this instance
+   * \param i the index of the record
+   * \param record pointer to where we should store the record
    */
-  inline void Reserve (uint32_t n);
+  void GetRecord (uint16_t i, struct PacketMetadata::Record *record) const;
   /**
-   * \brief Reserve space and make a metadata copy
-   * \param n space to reserve
+   * \brief Make room for a record before the first record
    */
-  void ReserveCopy (uint32_t n);
-
+  void PrepareHead (void);
   /**
-   * \brief Get the total size used by the metadata
+   * \brief Make room for records after the last record
+   * \param n the number of records
    */
-  uint32_t GetTotalSize (void) const;
-
+  void PrepareTail (uint32_t n);
   /**
-   * \brief Read items
-   * \param current the offset we should start reading the data from
-   * \param item pointer to where we should store the data to return to the caller
-   * \param extraItem pointer to where we should store the data to return to the caller
-   * \returns the number of bytes read.
+   * \brief Copy the records to a new data storage
+   * \param headroom the number of records to make room for before them
+   * \param tailroom the number of records to make room for after them
    */
-  uint32_t ReadItems (uint16_t current, 
-                      struct PacketMetadata::SmallItem *item,
-                      struct PacketMetadata::ExtraItem *extraItem) const;
+  void ReserveCopy (uint32_t headroom, uint32_t tailroom);
   /**
    * \brief Add an header
    * \param uid header's uid to add
@@ -620,18 +521,6 @@ public:
    * \returns true if the internal state is ok
    */
   bool IsStateOk (void) const;
-  /**
-   * \brief Check if the position is valid
-   * \param pointer the position to check
-   * \returns true if the position is valid
-   */
-  bool IsPointerOk (uint16_t pointer) const;
-  /**
-   * \brief Check if the position is valid
-   * \param pointer the position to check
-   * \returns true if the position is valid
-   */
-  bool IsSharedPointerOk (uint16_t pointer) const;
 
   /**
    * \brief Recycle the buffer memory
@@ -640,13 +529,13 @@ public:
   static void Recycle (struct PacketMetadata::Data *data);
   /**
    * \brief Create a buffer data storage
-   * \param size the storage size to create
+   * \param size the number of records of the storage to create
    * \returns a pointer to the created buffer storage
    */
   static struct PacketMetadata::Data *Create (uint32_t size);
   /**
    * \brief Allocate a buffer data storage
-   * \param n the storage size to create
+   * \param n the number of records of the storage to create
    * \returns a pointer to the allocated buffer storage
    */
   static struct PacketMetadata::Data *Allocate (uint32_t n);
@@ -655,8 +544,16 @@ public:
    * \param data the buffer data storage
    */
   static void Deallocate (struct PacketMetadata::Data *data);
+  /**
+   * \brief Empty the free list of the calling thread.
+   *
+   * Storages released later by the thread are deallocated.
+   */
+  static void DestroyFreeList (void);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  static __thread DataFreeList *m_freeList; //!< the metadata data storage of the thread
+  static __thread ThreadFreeList m_freeListState; //!< the state of the free list of the thread
+  static struct LocalStaticDestructor m_localStaticDestructor; //!< Local static destructor
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -667,18 +564,22 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  /**
+   * The records of the packets created while the metadata is disabled.
+   * It holds no record and is shared by all threads, so its reference
+   * count is never changed, and is kept above 1 so that the first
+   * record added to it is written in a copy.
+   */
+  static struct Data m_emptyData;
+
+  static __thread uint32_t m_maxSize; //!< maximum number of records
+  static __thread uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
-  /*
-     head -(next)-> tail
-       ^             |
-        \---(prev)---|
-   */
-  uint16_t m_head; //!< list head
-  uint16_t m_tail; //!< list tail
-  uint16_t m_used; //!< used portion
+  uint16_t m_start; //!< index of the first record
+  uint16_t m_end; //!< index past the last record
+  uint32_t m_headStart; //!< fragment start of the first record
+  uint32_t m_tailEnd; //!< fragment end of the last record
   uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -687,13 +588,22 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
-    m_head (0xffff),
-    m_tail (0xffff),
-    m_used (0),
+  : m_data (&m_emptyData),
+    m_start (0),
+    m_end (0),
+    m_headStart (0),
+    m_tailEnd (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
+  if (m_enable)
+    {
+      m_data = PacketMetadata::Create (PACKET_METADATA_DATA_MIN_RECORDS);
+      // leave room for the headers before the payload, and for the trailers after it.
+      m_start = m_data->m_size - m_data->m_size / 4;
+      m_end = m_start;
+      m_data->m_dirtyStart = m_start;
+      m_data->m_dirtyEnd = m_end;
+    }
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -701,14 +611,18 @@ PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
 }
 PacketMetadata::PacketMetadata (PacketMetadata const &o)
   : m_data (o.m_data),
-    m_head (o.m_head),
-    m_tail (o.m_tail),
-    m_used (o.m_used),
+    m_start (o.m_start),
+    m_end (o.m_end),
+    m_headStart (o.m_headStart),
+    m_tailEnd (o.m_tailEnd),
     m_packetUid (o.m_packetUid)
 {
   NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != &m_emptyData)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -717,26 +631,28 @@ PacketMetadata::operator = (PacketMetadata const& o)
     {
       // not self assignment
       NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != &m_emptyData && --m_data->m_count == 0)
         {
           PacketMetadata::Recycle (m_data);
         }
       m_data = o.m_data;
       NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != &m_emptyData)
+        {
+          m_data->m_count++;
+        }
     }
-  m_head = o.m_head;
-  m_tail = o.m_tail;
-  m_used = o.m_used;
+  m_start = o.m_start;
+  m_end = o.m_end;
+  m_headStart = o.m_headStart;
+  m_tailEnd = o.m_tailEnd;
   m_packetUid = o.m_packetUid;
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
 {
   NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (m_data != &m_emptyData && --m_data->m_count == 0)
     {
       PacketMetadata::Recycle (m_data);
     }
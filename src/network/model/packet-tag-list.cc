@@ -34,6 +34,70 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
+/** Maximum number of TagData kept in the free list of a thread */
+#define PACKET_TAG_LIST_FREE_LIST_SIZE 1000
+
+__thread struct PacketTagList::TagData *PacketTagList::g_free = 0;
+__thread uint32_t PacketTagList::g_nFree = 0;
+__thread ThreadFreeList PacketTagList::g_freeState;
+struct PacketTagList::LocalStaticDestructor PacketTagList::g_localStaticDestructor;
+
+PacketTagList::LocalStaticDestructor::~LocalStaticDestructor (void)
+{
+  NS_LOG_FUNCTION (this);
+  DestroyFreeList ();
+}
+
+void
+PacketTagList::DestroyFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  while (g_free != 0)
+    {
+      struct TagData *data = g_free;
+      g_free = data->next;
+      delete data;
+    }
+  g_nFree = 0;
+  // the lists destroyed by the thread after this point release their TagData.
+  g_freeState.Destroy ();
+}
+
+struct PacketTagList::TagData *
+PacketTagList::CreateTagData (void)
+{
+  struct TagData *data = g_free;
+  if (data != 0)
+    {
+      g_free = data->next;
+      g_nFree--;
+      std::memset (data->data, 0, TagData::MAX_SIZE);
+    }
+  else
+    {
+      data = new struct TagData ();
+    }
+  data->next = 0;
+  data->count = 1;
+  return data;
+}
+
+void
+PacketTagList::RecycleTagData (struct TagData *data)
+{
+  if (g_nFree < PACKET_TAG_LIST_FREE_LIST_SIZE
+      && g_freeState.Use (&PacketTagList::DestroyFreeList))
+    {
+      data->next = g_free;
+      g_free = data;
+      g_nFree++;
+    }
+  else
+    {
+      delete data;
+    }
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -133,9 +197,8 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
       NS_ASSERT (cur != 0);
       NS_ASSERT (cur->count > 1);
       cur->count--;                       // unmerge cur
-      struct TagData * copy = new struct TagData ();
+      struct TagData * copy = CreateTagData ();
       copy->tid = cur->tid;
-      copy->count = 1;
       memcpy (copy->data, cur->data, TagData::MAX_SIZE);
       copy->next = cur->next;             // merge into tail
       copy->next->count++;                // mark new merge
@@ -177,7 +240,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      delete cur;
+      RecycleTagData (cur);
     }
   else
     {
@@ -225,9 +288,8 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
       // cur is always a merge at this point
       // need to copy, replace, and link past cur
       cur->count--;                     // unmerge cur
-      struct TagData * copy = new struct TagData ();
+      struct TagData * copy = CreateTagData ();
       copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
       tag.Serialize (TagBuffer (copy->data,
                                 copy->data + tag.GetSerializedSize ()));
       copy->next = cur->next;           // merge into tail
@@ -249,9 +311,7 @@ PacketTagList::Add (const Tag &tag) const
     {
       NS_ASSERT (cur->tid != tag.GetInstanceTypeId ());
     }
-  struct TagData * head = new struct TagData ();
-  head->count = 1;
-  head->next = 0;
+  struct TagData * head = CreateTagData ();
   head->tid = tag.GetInstanceTypeId ();
   head->next = m_next;
   NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "ns3/thread-exit.h"
 
 namespace ns3 {
 
@@ -124,6 +125,11 @@ class Tag;
  * \n
  * Packet tags must serialize to a finite maximum size, see TagData
  *
+ * The TagData released by the lists of a thread are kept in a free
+ * list of this thread, linked through their \c next pointer, and
+ * reused by the next tags added in this thread: once a simulation has
+ * warmed up, adding, removing and copying tags does not allocate.
+ *
  * This documentation entitles the original author to a free beer.
  */
 class PacketTagList 
@@ -287,6 +293,38 @@ private:
    */
   bool ReplaceWriter (Tag & tag, bool preMerge, struct TagData * cur, struct TagData ** prevNext);
 
+  /**
+   * Get a TagData from the free list of the thread, or allocate one.
+   *
+   * \returns A TagData with zeroed data, no next and a count of 1.
+   */
+  static struct TagData * CreateTagData (void);
+  /**
+   * Give a TagData no longer referenced back to the free list of the
+   * thread, or release it if the free list is full.
+   *
+   * \param [in] data The TagData.
+   */
+  static void RecycleTagData (struct TagData * data);
+  /**
+   * Release the TagData in the free list of the thread.
+   *
+   * Called at thread exit, and by the local static destructor for the
+   * main thread.  The TagData given back later by the thread are
+   * released.
+   */
+  static void DestroyFreeList (void);
+
+  /// Local static destructor structure
+  struct LocalStaticDestructor
+  {
+    ~LocalStaticDestructor ();
+  };
+  static __thread struct TagData *g_free;  //!< Free TagData, linked through next
+  static __thread uint32_t g_nFree;        //!< Number of TagData in g_free
+  static __thread ThreadFreeList g_freeState; //!< State of the free list of the thread
+  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+
   /**
    * Pointer to first \ref TagData on the list
    */
@@ -350,13 +388,13 @@ PacketTagList::RemoveAll (void)
         }
       if (prev != 0) 
         {
-	  delete prev;
+          RecycleTagData (prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
-      delete prev;
+      RecycleTagData (prev);
     }
   m_next = 0;
 }
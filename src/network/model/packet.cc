@@ -28,7 +28,7 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+__thread uint32_t Packet::m_globalUid = 0;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -721,7 +721,12 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  /*
+   * The counter is per thread: the packets created by the threads of a
+   * parallel simulation are told apart by the system id in the upper
+   * 32 bits of their uid.
+   */
+  static __thread uint32_t m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
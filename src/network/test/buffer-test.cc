@@ -22,6 +22,13 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/thread-exit.h"
+#endif
+
+#include <vector>
 
 using namespace ns3;
 
@@ -361,6 +368,268 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 //-----------------------------------------------------------------------------
+class BufferZeroAreaTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferZeroAreaTest ();
+};
+
+BufferZeroAreaTest::BufferZeroAreaTest ()
+  : TestCase ("Buffer zero area concatenation") {
+}
+
+void
+BufferZeroAreaTest::DoRun (void)
+{
+  // reassemble fragments of a payload which share its data
+  Buffer payload (10000);
+  Buffer first = payload.CreateFragment (0, 4000);
+  Buffer second = payload.CreateFragment (4000, 6000);
+  first.AddAtEnd (second);
+  NS_TEST_ASSERT_MSG_EQ (first.GetSize (), 10000, "Wrong reassembled size");
+  NS_TEST_EXPECT_MSG_LT (first.GetSerializedSize (), 100, "Payload zeroes written in memory");
+
+  // [aa bb][1000 zeroes][cc] + [dd][3000 zeroes]: only the first zero
+  // area is written in memory
+  Buffer a (1000);
+  a.AddAtStart (2);
+  a.Begin ().WriteHtonU16 (0xaabb);
+  a.AddAtEnd (1);
+  Buffer::Iterator i = a.End ();
+  i.Prev ();
+  i.WriteU8 (0xcc);
+  Buffer b (3000);
+  b.AddAtStart (1);
+  b.Begin ().WriteU8 (0xdd);
+  a.AddAtEnd (b);
+  NS_TEST_ASSERT_MSG_EQ (a.GetSize (), 4004, "Wrong concatenated size");
+  NS_TEST_EXPECT_MSG_LT (a.GetSerializedSize (), 1100, "Largest zero area written in memory");
+  std::vector<uint8_t> bytes (a.GetSize (), 0xff);
+  a.CopyData (&bytes[0], bytes.size ());
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (bytes[0]), 0xaa, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (bytes[1]), 0xbb, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (bytes[1002]), 0xcc, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (bytes[1003]), 0xdd, "Wrong byte");
+  uint32_t nonZero = 0;
+  for (uint32_t j = 2; j < bytes.size (); ++j)
+    {
+      if (bytes[j] != 0 && j != 1002 && j != 1003)
+        {
+          nonZero++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (nonZero, 0, "Zero area not zero");
+
+  // the other way around, the second zero area stays virtual
+  Buffer c (10);
+  c.AddAtEnd (1);
+  i = c.End ();
+  i.Prev ();
+  i.WriteU8 (0xee);
+  Buffer d = c;
+  c.AddAtEnd (b);
+  NS_TEST_EXPECT_MSG_LT (c.GetSerializedSize (), 100, "Largest zero area written in memory");
+  i = c.Begin ();
+  i.Next (10);
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (i.ReadU8 ()), 0xee, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (i.ReadU8 ()), 0xdd, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ (c.GetSize (), 3012, "Wrong concatenated size");
+  // and a copy which shares the data is not changed
+  NS_TEST_EXPECT_MSG_EQ (d.GetSize (), 11, "Shared buffer modified");
+}
+//-----------------------------------------------------------------------------
+class BufferAllocationTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferAllocationTest ();
+};
+
+BufferAllocationTest::BufferAllocationTest ()
+  : TestCase ("Buffer storage recycling") {
+}
+
+void
+BufferAllocationTest::DoRun (void)
+{
+  // a jumbo buffer must not prevent the recycling of smaller ones
+  {
+    Buffer jumbo;
+    jumbo.AddAtStart (9000);
+  }
+  Buffer::AllocationStats before = Buffer::GetAllocationStats ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Buffer small;
+      small.AddAtStart (100 + i);
+      Buffer copy = small;
+      copy.AddAtEnd (20);
+    }
+  Buffer::AllocationStats after = Buffer::GetAllocationStats ();
+  uint64_t created = after.created - before.created;
+  uint64_t allocated = created - (after.recycled - before.recycled);
+  NS_TEST_EXPECT_MSG_GT (created, 200, "Storages not created");
+  NS_TEST_EXPECT_MSG_LT (allocated, 10, "Storages not recycled");
+  NS_TEST_EXPECT_MSG_EQ (after.released - before.released, created, "Storages not released");
+  NS_TEST_EXPECT_MSG_GT (after.pooled, 0, "No storage in the free lists");
+  NS_TEST_EXPECT_MSG_GT (after.pooledBytes, after.pooled * 31, "Wrong size of the free lists");
+}
+//-----------------------------------------------------------------------------
+#ifdef HAVE_PTHREAD_H
+class BufferThreadExitTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferThreadExitTest ();
+private:
+  static void Thread (void);
+  static void AtExit (void);
+  static uint64_t g_pooledInThread;
+  static uint64_t g_pooledAtExit;
+};
+
+uint64_t BufferThreadExitTest::g_pooledInThread;
+uint64_t BufferThreadExitTest::g_pooledAtExit;
+
+BufferThreadExitTest::BufferThreadExitTest ()
+  : TestCase ("Buffer free lists emptied at thread exit") {
+}
+
+void
+BufferThreadExitTest::Thread (void)
+{
+  // registered before the free lists are created, so called after them
+  AtThreadExit (&BufferThreadExitTest::AtExit);
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Buffer small;
+      small.AddAtStart (100 + i);
+    }
+  g_pooledInThread = Buffer::GetAllocationStats ().pooled;
+}
+
+void
+BufferThreadExitTest::AtExit (void)
+{
+  g_pooledAtExit = Buffer::GetAllocationStats ().pooled;
+}
+
+void
+BufferThreadExitTest::DoRun (void)
+{
+  g_pooledInThread = 0;
+  g_pooledAtExit = 1;
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&BufferThreadExitTest::Thread));
+  thread->Start ();
+  thread->Join ();
+  NS_TEST_EXPECT_MSG_GT (g_pooledInThread, 0, "No storage in the free lists of the thread");
+  NS_TEST_EXPECT_MSG_EQ (g_pooledAtExit, 0, "Free lists of the thread not emptied");
+}
+#endif /* HAVE_PTHREAD_H */
+//-----------------------------------------------------------------------------
+class BufferChecksumTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+private:
+  uint16_t ReferenceChecksum (Buffer::Iterator i, uint16_t size, uint32_t initialChecksum);
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer checksum") {
+}
+
+uint16_t
+BufferChecksumTest::ReferenceChecksum (Buffer::Iterator i, uint16_t size, uint32_t initialChecksum)
+{
+  // RFC 1071, one 16-bit word at a time
+  uint32_t sum = initialChecksum;
+  for (int j = 0; j < size / 2; j++)
+    {
+      sum += i.ReadU16 ();
+    }
+  if (size & 1)
+    {
+      sum += i.ReadU8 ();
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> bytesRng = CreateObject<UniformRandomVariable> ();
+  bytesRng->SetAttribute ("Min", DoubleValue (0));
+  bytesRng->SetAttribute ("Max", DoubleValue (256));
+
+  // buffers of h bytes, a zero area of z bytes and t bytes, checksummed
+  // from an odd or even offset, over an odd or even size.
+  const uint32_t sizes[] = { 0, 1, 2, 3, 15, 16, 17, 33, 64, 65, 1499 };
+  const uint32_t zeroes[] = { 0, 1, 40 };
+  const uint32_t nSizes = sizeof (sizes) / sizeof (sizes[0]);
+  for (uint32_t h = 0; h < nSizes; h++)
+    {
+      for (uint32_t z = 0; z < sizeof (zeroes) / sizeof (zeroes[0]); z++)
+        {
+          for (uint32_t t = 0; t < nSizes; t++)
+            {
+              Buffer buffer (zeroes[z]);
+              buffer.AddAtStart (sizes[h]);
+              Buffer::Iterator i = buffer.Begin ();
+              for (uint32_t k = 0; k < sizes[h]; k++)
+                {
+                  i.WriteU8 (static_cast<uint8_t> (bytesRng->GetValue ()));
+                }
+              buffer.AddAtEnd (sizes[t]);
+              i = buffer.End ();
+              i.Prev (sizes[t]);
+              for (uint32_t k = 0; k < sizes[t]; k++)
+                {
+                  i.WriteU8 (static_cast<uint8_t> (bytesRng->GetValue ()));
+                }
+              uint32_t size = buffer.GetSize ();
+              for (uint32_t start = 0; start < 2 && start <= size; start++)
+                {
+                  for (uint32_t end = size; end + 2 > size && end >= start; end--)
+                    {
+                      Buffer::Iterator a = buffer.Begin ();
+                      a.Next (start);
+                      Buffer::Iterator b = a;
+                      uint32_t initial = (end & 1) ? 0x1a2b3 : 0;
+                      uint16_t expected = ReferenceChecksum (b, end - start, initial);
+                      uint16_t checksum = a.CalculateIpChecksum (end - start, initial);
+                      NS_TEST_ASSERT_MSG_EQ (checksum, expected, "Wrong checksum of [" << start << ", " << end
+                                             << ") in " << sizes[h] << "+" << zeroes[z] << "+" << sizes[t] << " bytes");
+                      NS_TEST_ASSERT_MSG_EQ (a.GetDistanceFrom (buffer.Begin ()), end, "Iterator not advanced");
+                      if (end == 0)
+                        {
+                          break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+  // a header followed by its checksum sums to zero
+  Buffer header;
+  header.AddAtStart (20);
+  Buffer::Iterator i = header.Begin ();
+  for (uint32_t k = 0; k < 20; k++)
+    {
+      i.WriteU8 (k == 10 || k == 11 ? 0 : static_cast<uint8_t> (bytesRng->GetValue ()));
+    }
+  i = header.Begin ();
+  uint16_t checksum = i.CalculateIpChecksum (20);
+  i = header.Begin ();
+  i.Next (10);
+  i.WriteU16 (checksum);
+  i = header.Begin ();
+  NS_TEST_EXPECT_MSG_EQ (i.CalculateIpChecksum (20), 0, "Checksum does not verify");
+}
+//-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
 {
 public:
@@ -371,6 +640,12 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferZeroAreaTest, TestCase::QUICK);
+  AddTestCase (new BufferAllocationTest, TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new BufferThreadExitTest, TestCase::QUICK);
+#endif
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite;
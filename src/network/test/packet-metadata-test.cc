@@ -18,6 +18,8 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include <cstdarg>
+#include <ctime>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include "ns3/test.h"
@@ -821,6 +823,40 @@ PacketMetadataTest::DoRun (void)
                                  p3->GetSize ());
   delete [] buf;
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
+
+  // fragments share the records of their packet, also when
+  // headers are added to them and when they are reassembled.
+  p = Create<Packet> (1000);
+  ADD_HEADER (p, 8);
+  ADD_HEADER (p, 20);
+  ADD_TRAILER (p, 4);
+  p1 = p->CreateFragment (0, 300);
+  p2 = p->CreateFragment (300, 732);
+  CHECK_HISTORY (p1, 3, 20, 8, 272);
+  CHECK_HISTORY (p2, 2, 728, 4);
+  p3 = p1->Copy ();
+  p3->AddAtEnd (p2);
+  CHECK_HISTORY (p3, 4, 20, 8, 1000, 4);
+  ADD_HEADER (p1, 5);
+  ADD_HEADER (p2, 5);
+  CHECK_HISTORY (p1, 4, 5, 20, 8, 272);
+  CHECK_HISTORY (p2, 3, 5, 728, 4);
+  CHECK_HISTORY (p, 4, 20, 8, 1000, 4);
+  REM_HEADER (p1, 5);
+  REM_HEADER (p2, 5);
+  p1->AddAtEnd (p2);
+  CHECK_HISTORY (p1, 4, 20, 8, 1000, 4);
+  REM_HEADER (p1, 20);
+  REM_HEADER (p1, 8);
+  REM_TRAILER (p1, 4);
+  CHECK_HISTORY (p1, 1, 1000);
+  p2 = p->CreateFragment (0, 500);
+  ADD_TRAILER (p2, 3);
+  CHECK_HISTORY (p2, 4, 20, 8, 472, 3);
+  p3 = p->CreateFragment (30, 1002);
+  ADD_HEADER (p3, 7);
+  CHECK_HISTORY (p3, 3, 7, 998, 4);
+  CHECK_HISTORY (p, 4, 20, 8, 1000, 4);
 }
 //-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
@@ -836,3 +872,123 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
 }
 
 PacketMetadataTestSuite g_packetMetadataTest;
+
+//-----------------------------------------------------------------------------
+class PacketMetadataTimeTestCase : public TestCase
+{
+public:
+  /**
+   * \param enable whether to enable the packet metadata, which
+   *        cannot be disabled again in the same process.
+   */
+  PacketMetadataTimeTestCase (bool enable);
+private:
+  virtual void DoRun (void);
+  void Report (const std::string how, clock_t delta) const;
+
+  enum { REPETITIONS = 100000 };
+  bool m_enable;
+};
+
+PacketMetadataTimeTestCase::PacketMetadataTimeTestCase (bool enable)
+  : TestCase (enable ? "Measure the packet metadata time per packet" :
+              "Measure the packet time per packet without metadata"),
+    m_enable (enable)
+{
+}
+
+void
+PacketMetadataTimeTestCase::DoRun (void)
+{
+  if (m_enable)
+    {
+      PacketMetadata::Enable ();
+    }
+  HistoryHeader<8> udp;
+  HistoryHeader<20> ipv4;
+  HistoryTrailer<4> fcs;
+
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddHeader (udp);
+      p->AddHeader (ipv4);
+      p->AddTrailer (fcs);
+      Ptr<Packet> o = p->Copy ();
+      o->RemoveTrailer (fcs);
+      o->RemoveHeader (ipv4);
+      o->RemoveHeader (udp);
+    }
+  Report ("headers and trailers", clock () - start);
+
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddHeader (udp);
+      Ptr<Packet> reassembled;
+      for (uint32_t offset = 0; offset < p->GetSize (); offset += 300)
+        {
+          uint32_t size = std::min (p->GetSize () - offset, (uint32_t)300);
+          Ptr<Packet> fragment = p->CreateFragment (offset, size);
+          fragment->AddHeader (ipv4);
+          fragment->RemoveHeader (ipv4);
+          if (reassembled == 0)
+            {
+              reassembled = fragment;
+            }
+          else
+            {
+              reassembled->AddAtEnd (fragment);
+            }
+        }
+      reassembled->RemoveHeader (udp);
+    }
+  Report ("fragmentation and reassembly", clock () - start);
+}
+
+void
+PacketMetadataTimeTestCase::Report (const std::string how, clock_t delta) const
+{
+  double per = 1E9 * double (delta) / (double (REPETITIONS) * double (CLOCKS_PER_SEC));
+  std::cout << (m_enable ? "packet-metadata-perf: " : "packet-metadata-disabled-perf: ")
+            << how << ": "
+            << "ticks: " << delta
+            << "\tper: " << per
+            << " ns/packet"
+            << std::endl;
+}
+
+class PacketMetadataPerformanceSuite : public TestSuite
+{
+public:
+  PacketMetadataPerformanceSuite ();
+};
+
+PacketMetadataPerformanceSuite::PacketMetadataPerformanceSuite ()
+  : TestSuite ("packet-metadata-perf", PERFORMANCE)
+{
+  AddTestCase (new PacketMetadataTimeTestCase (true), TestCase::QUICK);
+}
+
+PacketMetadataPerformanceSuite g_packetMetadataPerformanceSuite;
+
+/**
+ * Measures the same packets as packet-metadata-perf with the metadata
+ * disabled, which is the default.  This is a suite of its own because
+ * adding headers with the metadata disabled forbids enabling it later.
+ */
+class PacketMetadataDisabledPerformanceSuite : public TestSuite
+{
+public:
+  PacketMetadataDisabledPerformanceSuite ();
+};
+
+PacketMetadataDisabledPerformanceSuite::PacketMetadataDisabledPerformanceSuite ()
+  : TestSuite ("packet-metadata-disabled-perf", PERFORMANCE)
+{
+  AddTestCase (new PacketMetadataTimeTestCase (false), TestCase::QUICK);
+}
+
+PacketMetadataDisabledPerformanceSuite g_packetMetadataDisabledPerformanceSuite;
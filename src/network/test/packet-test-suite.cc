@@ -27,6 +27,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -66,14 +67,21 @@ template <int N>
 class ATestTag : public ATestTagBase
 {
 public:
+  /**
+   * Get the name of this type.
+   * \return The name.
+   */
+  static std::string GetTypeName (void) {
+    std::ostringstream oss;
+    oss << "anon::ATestTag<" << N << ">";
+    return oss.str ();
+  }
   /**
    * Register this type.
    * \return The TypeId.
    */
   static TypeId GetTypeId (void) {
-    std::ostringstream oss;
-    oss << "anon::ATestTag<" << N << ">";
-    static TypeId tid = TypeId (oss.str ().c_str ())
+    static TypeId tid = TypeId (GetTypeName ().c_str ())
       .SetParent<ATestTagBase> ()
       .SetGroupName ("Network")
       .HideFromDocumentation ()
@@ -139,14 +147,21 @@ template <int N>
 class ATestHeader : public ATestHeaderBase
 {
 public:
+  /**
+   * Get the name of this type.
+   * \return The name.
+   */
+  static std::string GetTypeName (void) {
+    std::ostringstream oss;
+    oss << "anon::ATestHeader<" << N << ">";
+    return oss.str ();
+  }
   /**
    * Register this type.
    * \return The TypeId.
    */
   static TypeId GetTypeId (void) {
-    std::ostringstream oss;
-    oss << "anon::ATestHeader<" << N << ">";
-    static TypeId tid = TypeId (oss.str ().c_str ())
+    static TypeId tid = TypeId (GetTypeName ().c_str ())
       .SetParent<ATestHeaderBase> ()
       .SetGroupName ("Network")
       .HideFromDocumentation ()
@@ -209,14 +224,21 @@ template <int N>
 class ATestTrailer : public ATestTrailerBase
 {
 public:
+  /**
+   * Get the name of this type.
+   * \return The name.
+   */
+  static std::string GetTypeName (void) {
+    std::ostringstream oss;
+    oss << "anon::ATestTrailer<" << N << ">";
+    return oss.str ();
+  }
   /**
    * Register this type.
    * \return The TypeId.
    */
   static TypeId GetTypeId (void) {
-    std::ostringstream oss;
-    oss << "anon::ATestTrailer<" << N << ">";
-    static TypeId tid = TypeId (oss.str ().c_str ())
+    static TypeId tid = TypeId (GetTypeName ().c_str ())
       .SetParent<ATestTrailerBase> ()
       .SetGroupName ("Network")
       .HideFromDocumentation ()
@@ -582,6 +604,33 @@ PacketTest::DoRun (void)
     tmp->AddPaddingAtEnd (50);
     CHECK (tmp, 1, E (25, 0, 50));
   }
+
+  /* Test cutting byte tags shared with a copy of the packet. */
+  {
+    Ptr<Packet> tmp = Create<Packet> (50);
+    tmp->AddByteTag (ATestTag<25> ());
+    Ptr<Packet> tail = Create<Packet> (50);
+    tail->AddByteTag (ATestTag<10> ());
+    tmp->AddAtEnd (tail);
+    CHECK (tmp, 2, E (25, 0, 50), E (10, 50, 100));
+    tmp->RemoveAtStart (50);
+    Ptr<Packet> copy = tmp->Copy ();
+    copy->AddHeader (ATestHeader<50> ());
+    CHECK (copy, 1, E (10, 50, 100));
+    CHECK (tmp, 1, E (10, 0, 50));
+    tmp->AddHeader (ATestHeader<10> ());
+    CHECK (tmp, 1, E (10, 10, 60));
+    copy->AddTrailer (ATestTrailer<20> ());
+    CHECK (copy, 1, E (10, 50, 100));
+    CHECK (tmp, 1, E (10, 10, 60));
+    copy->AddByteTag (ATestTag<5> ());
+    CHECK (copy, 2, E (10, 50, 100), E (5, 0, 120));
+    copy->RemoveAtStart (60);
+    CHECK (copy, 2, E (10, 0, 40), E (5, 0, 60));
+    copy->AddHeader (ATestHeader<10> ());
+    CHECK (copy, 2, E (10, 10, 50), E (5, 10, 70));
+    CHECK (tmp, 1, E (10, 10, 60));
+  }
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
@@ -862,3 +911,112 @@ PacketTestSuite::PacketTestSuite ()
 }
 
 static PacketTestSuite g_packetTestSuite;
+
+//-----------------------------------------------------------------------------
+class PacketTagsTimeTestCase : public TestCase
+{
+public:
+  PacketTagsTimeTestCase ();
+private:
+  virtual void DoRun (void);
+  void Report (const std::string how, clock_t delta) const;
+
+  enum { REPETITIONS = 100000 };
+};
+
+PacketTagsTimeTestCase::PacketTagsTimeTestCase ()
+  : TestCase ("Measure the time per packet of packet and byte tags")
+{
+}
+
+void
+PacketTagsTimeTestCase::DoRun (void)
+{
+  // the tags of a UDP datagram over Wi-Fi: a byte tag for the flow
+  // monitor and a ttl added by the socket, a flow id added by the
+  // application, a sequence number and a queue timestamp added by the
+  // MAC, and the packet info added by IP at the receiver.
+  ATestTag<4> flow (1);
+  ATestTag<1> ttl (2);
+  ATestTag<3> flowId (3);
+  ATestTag<2> sequence (4);
+  ATestTag<8> timestamp (5);
+  ATestTag<19> packetInfo (6);
+  ATestHeader<8> udp;
+  ATestHeader<20> ipv4;
+  ATestHeader<24> mac;
+  ATestTrailer<4> fcs;
+
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddPacketTag (flowId);
+      p->AddByteTag (flow);
+      p->AddPacketTag (ttl);
+      p->AddHeader (udp);
+      p->AddHeader (ipv4);
+      p->AddPacketTag (sequence);
+      p->AddPacketTag (timestamp);
+      p->AddHeader (mac);
+      p->AddTrailer (fcs);
+      // the MAC keeps the packet until it is acknowledged, and sends
+      // a copy of it.
+      Ptr<Packet> received = p->Copy ();
+      received->RemovePacketTag (timestamp);
+      received->RemoveHeader (mac);
+      received->RemoveTrailer (fcs);
+      received->RemovePacketTag (sequence);
+      received->RemoveHeader (ipv4);
+      received->AddPacketTag (packetInfo);
+      received->RemoveHeader (udp);
+      received->PeekPacketTag (flowId);
+      received->FindFirstMatchingByteTag (flow);
+      received->RemovePacketTag (packetInfo);
+      received->RemovePacketTag (ttl);
+    }
+  Report ("udp over wifi", clock () - start);
+
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddByteTag (flow);
+      p->AddPacketTag (flowId);
+      p->AddHeader (udp);
+      for (uint32_t offset = 0; offset < p->GetSize (); offset += 300)
+        {
+          uint32_t size = std::min (p->GetSize () - offset, (uint32_t)300);
+          Ptr<Packet> fragment = p->CreateFragment (offset, size);
+          fragment->AddHeader (ipv4);
+          fragment->AddTrailer (fcs);
+          fragment->ReplacePacketTag (flowId);
+        }
+    }
+  Report ("fragmentation", clock () - start);
+}
+
+void
+PacketTagsTimeTestCase::Report (const std::string how, clock_t delta) const
+{
+  double per = 1E9 * double (delta) / (double (REPETITIONS) * double (CLOCKS_PER_SEC));
+  std::cout << "packet-tags-perf: " << how << ": "
+            << "ticks: " << delta
+            << "\tper: " << per
+            << " ns/packet"
+            << std::endl;
+}
+
+class PacketTagsPerformanceSuite : public TestSuite
+{
+public:
+  PacketTagsPerformanceSuite ();
+};
+
+PacketTagsPerformanceSuite::PacketTagsPerformanceSuite ()
+  : TestSuite ("packet-tags-perf", PERFORMANCE)
+{
+  AddTestCase (new PacketTagsTimeTestCase, TestCase::QUICK);
+}
+
+static PacketTagsPerformanceSuite g_packetTagsPerformanceSuite;
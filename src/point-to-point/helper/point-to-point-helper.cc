@@ -28,6 +28,8 @@
 #include "ns3/config.h"
 #include "ns3/packet.h"
 #include "ns3/names.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
 #include "ns3/mpi-interface.h"
 #include "ns3/mpi-receiver.h"
 
@@ -238,7 +240,10 @@ PointToPointHelper::Install (Ptr<Node> a, Ptr<Node> b)
   devB->SetQueue (queueB);
   // If MPI is enabled, we need to see if both nodes have the same system id 
   // (rank), and the rank is the same as this instance.  If both are true, 
-  //use a normal p2p channel, otherwise use a remote channel
+  //use a normal p2p channel, otherwise use a remote channel.  Without MPI,
+  //nodes with different system ids are run by different threads of the
+  //multithreaded simulator, and also need a remote channel; the other
+  //simulators run them in a single thread, over a normal channel.
   bool useNormalChannel = true;
   Ptr<PointToPointChannel> channel = 0;
 
@@ -252,6 +257,15 @@ PointToPointHelper::Install (Ptr<Node> a, Ptr<Node> b)
           useNormalChannel = false;
         }
     }
+  else if (a->GetSystemId () != b->GetSystemId ())
+    {
+      StringValue simulationType;
+      if (GlobalValue::GetValueByNameFailSafe ("SimulatorImplementationType", simulationType)
+          && simulationType.Get () == "ns3::MultithreadedSimulatorImpl")
+        {
+          useNormalChannel = false;
+        }
+    }
   if (useNormalChannel)
     {
       channel = m_channelFactory.Create<PointToPointChannel> ();
@@ -259,12 +273,15 @@ PointToPointHelper::Install (Ptr<Node> a, Ptr<Node> b)
   else
     {
       channel = m_remoteChannelFactory.Create<PointToPointRemoteChannel> ();
-      Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver> ();
-      Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver> ();
-      mpiRecA->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devA));
-      mpiRecB->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devB));
-      devA->AggregateObject (mpiRecA);
-      devB->AggregateObject (mpiRecB);
+      if (MpiInterface::IsEnabled ())
+        {
+          Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver> ();
+          Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver> ();
+          mpiRecA->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devA));
+          mpiRecB->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devB));
+          devA->AggregateObject (mpiRecA);
+          devB->AggregateObject (mpiRecB);
+        }
     }
 
   devA->Attach (channel);
@@ -120,7 +120,9 @@ public:
    *
    * Saves you from having to construct a temporary NodeContainer. 
    * Also, if MPI is enabled, for distributed simulations, 
-   * appropriate remote point-to-point channels are created.
+   * appropriate remote point-to-point channels are created.  So are
+   * they between nodes of different system ids when the
+   * SimulatorImplementationType is ns3::MultithreadedSimulatorImpl.
    */
   NetDeviceContainer Install (Ptr<Node> a, Ptr<Node> b);
 
@@ -19,6 +19,7 @@
  */
 
 #include <iostream>
+#include <vector>
 
 #include "point-to-point-remote-channel.h"
 #include "point-to-point-net-device.h"
@@ -46,12 +47,36 @@ PointToPointRemoteChannel::GetTypeId (void)
 
 PointToPointRemoteChannel::PointToPointRemoteChannel ()
 {
+  m_dstDevice[0] = m_dstDevice[1] = 0;
+  m_dstNode[0] = m_dstNode[1] = 0;
 }
 
 PointToPointRemoteChannel::~PointToPointRemoteChannel ()
 {
 }
 
+void
+PointToPointRemoteChannel::Attach (Ptr<PointToPointNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  PointToPointChannel::Attach (device);
+  if (GetNDevices () == 2 && GetSource (0)->GetNode () != 0 && GetSource (1)->GetNode () != 0)
+    {
+      CacheDestinations ();
+    }
+}
+
+void
+PointToPointRemoteChannel::CacheDestinations (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      m_dstDevice[i] = PeekPointer (GetDestination (i));
+      m_dstNode[i] = GetDestination (i)->GetNode ()->GetId ();
+    }
+}
+
 bool
 PointToPointRemoteChannel::TransmitStart (
   Ptr<Packet> p,
@@ -63,16 +88,32 @@ PointToPointRemoteChannel::TransmitStart (
 
   IsInitialized ();
 
-  uint32_t wire = src == GetSource (0) ? 0 : 1;
-  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
-
 #ifdef NS3_MPI
-  // Calculate the rxTime (absolute)
-  Time rxTime = Simulator::Now () + txTime + GetDelay ();
-  MpiInterface::SendPacket (p, rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+  if (MpiInterface::IsEnabled ())
+    {
+      uint32_t wire = src == GetSource (0) ? 0 : 1;
+      Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+
+      // Calculate the rxTime (absolute)
+      Time rxTime = Simulator::Now () + txTime + GetDelay ();
+      MpiInterface::SendPacket (p, rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
+      return true;
+    }
 #endif
+
+  if (m_dstDevice[0] == 0)
+    {
+      // the devices were attached before being added to their node
+      CacheDestinations ();
+    }
+  // the source of wire 0 is the destination of wire 1
+  uint32_t wire = PeekPointer (src) == m_dstDevice[1] ? 0 : 1;
+
+  std::vector<uint8_t> buffer (p->GetSerializedSize ());
+  p->Serialize (&buffer[0], buffer.size ());
+  Ptr<Packet> copy = Create<Packet> (&buffer[0], buffer.size (), true);
+  Simulator::ScheduleWithContext (m_dstNode[wire], txTime + GetDelay (),
+                                  &PointToPointNetDevice::Receive, m_dstDevice[wire], copy);
   return true;
 }
 
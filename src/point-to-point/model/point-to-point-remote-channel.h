@@ -20,7 +20,8 @@
 
 // This object connects two point-to-point net devices where at least one
 // is not local to this simulator object.  It simply over-rides the transmit
-// method and uses an MPI Send operation instead.
+// method and uses an MPI Send operation instead, or hands a private copy of
+// the packet to the thread running the other device.
 
 #ifndef POINT_TO_POINT_REMOTE_CHANNEL_H
 #define POINT_TO_POINT_REMOTE_CHANNEL_H
@@ -37,6 +38,14 @@ namespace ns3 {
  * This object connects two point-to-point net devices where at least one
  * is not local to this simulator object. It simply override the transmit
  * method and uses an MPI Send operation instead.
+ *
+ * Without MPI, the devices are run by different threads of the
+ * MultithreadedSimulatorImpl.  The packet is then copied with
+ * Packet::Serialize, so that the receiving thread gets by pointer a
+ * packet which shares no reference counted data with the one of the
+ * sending thread, and the reception is scheduled through the raw pointer
+ * of the device, so that its reference count is not touched by the
+ * sending thread either.
  */
 class PointToPointRemoteChannel : public PointToPointChannel
 {
@@ -68,6 +77,21 @@ public:
    */
   virtual bool TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Attach a given netdevice to this channel
+   * \param device pointer to the netdevice to attach to the channel
+   */
+  virtual void Attach (Ptr<PointToPointNetDevice> device);
+
+private:
+  /**
+   * \brief Record the destination device and node of both wires
+   */
+  void CacheDestinations (void);
+
+  PointToPointNetDevice *m_dstDevice[2]; //!< Destination device of each wire
+  uint32_t m_dstNode[2];                 //!< Id of the destination node of each wire
 };
 
 } // namespace ns3
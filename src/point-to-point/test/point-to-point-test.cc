@@ -23,6 +23,13 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-remote-channel.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/node.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include <vector>
+#include <utility>
 
 using namespace ns3;
 
@@ -93,6 +100,155 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for the multithreaded simulator over PointToPoint links
+ *
+ * Node A, of system 0, sends packets to node B, of system 1, which
+ * forwards them to node C, of system 1 too, and echoes a smaller packet
+ * back to A.  The packets received by each node, and their times, must
+ * be the same with the MultithreadedSimulatorImpl, which runs A and B in
+ * different threads, as with the DefaultSimulatorImpl.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointMultithreadedTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /** Time step and size of a received packet. */
+  typedef std::pair<int64_t, uint32_t> Reception;
+
+  /**
+   * \brief Run the scenario with a simulator implementation
+   *
+   * \param simulatorType the TypeId name of the implementation
+   * \returns the packets received, by node
+   */
+  std::vector<std::vector<Reception> > RunScenario (std::string simulatorType);
+
+  /**
+   * \brief Record a received packet, forward and echo it at node B
+   *
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Send one packet
+   *
+   * \param device NetDevice to send from
+   * \param size size of the packet
+   */
+  static void SendOnePacket (Ptr<NetDevice> device, uint32_t size);
+
+  uint32_t m_firstNode; //!< Id of node A
+  std::vector<std::vector<Reception> > m_rx; //!< Received packets, by node
+};
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest ()
+  : TestCase ("PointToPoint links between the threads of the multithreaded simulator")
+{
+}
+
+void
+PointToPointMultithreadedTest::SendOnePacket (Ptr<NetDevice> device, uint32_t size)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                        uint16_t protocol, const Address &from)
+{
+  Ptr<Node> node = device->GetNode ();
+  uint32_t index = node->GetId () - m_firstNode;
+  m_rx[index].push_back (Reception (Simulator::Now ().GetTimeStep (), packet->GetSize ()));
+  if (index == 1)
+    {
+      // node B: device 0 is linked to A and device 1 to C
+      SendOnePacket (node->GetDevice (1), packet->GetSize ());
+      SendOnePacket (device, packet->GetSize () / 2);
+    }
+  return true;
+}
+
+std::vector<std::vector<PointToPointMultithreadedTest::Reception> >
+PointToPointMultithreadedTest::RunScenario (std::string simulatorType)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+
+  Ptr<Node> a = CreateObject<Node> (0);
+  Ptr<Node> b = CreateObject<Node> (1);
+  Ptr<Node> c = CreateObject<Node> (1);
+  m_firstNode = a->GetId ();
+  m_rx.assign (3, std::vector<Reception> ());
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  NetDeviceContainer ab = p2p.Install (a, b);
+  NetDeviceContainer bc = p2p.Install (b, c);
+  bool remote = DynamicCast<PointToPointRemoteChannel> (ab.Get (0)->GetChannel ()) != 0;
+  NS_TEST_EXPECT_MSG_EQ (remote, (simulatorType == "ns3::MultithreadedSimulatorImpl"),
+                         "Only the multithreaded simulator links nodes of different systems by a remote channel");
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      ab.Get (i)->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+      bc.Get (i)->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+    }
+
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      Simulator::ScheduleWithContext (a->GetId (), Seconds (1.0 + 0.0005 * i),
+                                      &PointToPointMultithreadedTest::SendOnePacket, ab.Get (0), 100 + 10 * i);
+    }
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (2.0), "The simulation did not stop at the stop time");
+  Simulator::Destroy ();
+
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  return m_rx;
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  TypeId tid;
+  if (!TypeId::LookupByNameFailSafe ("ns3::MultithreadedSimulatorImpl", &tid))
+    {
+      // built without threads
+      return;
+    }
+  std::vector<std::vector<Reception> > expected = RunScenario ("ns3::DefaultSimulatorImpl");
+  std::vector<std::vector<Reception> > rx = RunScenario ("ns3::MultithreadedSimulatorImpl");
+
+  NS_TEST_ASSERT_MSG_EQ (expected[0].size (), 20, "Node A did not receive the echoes");
+  NS_TEST_ASSERT_MSG_EQ (expected[1].size (), 20, "Node B did not receive the packets");
+  NS_TEST_ASSERT_MSG_EQ (expected[2].size (), 20, "Node C did not receive the forwarded packets");
+  for (uint32_t node = 0; node < 3; node++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (rx[node].size (), expected[node].size (), "Wrong number of packets received by node " << node);
+      for (uint32_t i = 0; i < rx[node].size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (rx[node][i].first, expected[node][i].first, "Wrong reception time at node " << node);
+          NS_TEST_EXPECT_MSG_EQ (rx[node][i].second, expected[node][i].second, "Wrong packet size at node " << node);
+        }
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -109,6 +265,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -0,0 +1,600 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "replication-helper.h"
+#include "ns3/data-calculator.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulation-checkpoint.h"
+#include "ns3/nstime.h"
+#include "ns3/fatal-error.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <map>
+#include <string>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationHelper");
+
+namespace {
+
+/** The kinds of records of the output of a DataCalculator. */
+enum RecordKind
+{
+  STATISTIC = 'S',   //!< OutputStatistic.
+  INT = 'i',         //!< OutputSingleton of an int.
+  UINT = 'u',        //!< OutputSingleton of a uint32_t.
+  DOUBLE = 'd',      //!< OutputSingleton of a double.
+  STRING = 's',      //!< OutputSingleton of a string.
+  TIME = 't'         //!< OutputSingleton of a Time.
+};
+
+/**
+ * Append a value to a buffer, in the representation of this machine.
+ *
+ * \param [in,out] buffer The buffer.
+ * \param [in] value The value.
+ */
+template <typename T>
+void
+Put (std::string *buffer, T value)
+{
+  buffer->append (reinterpret_cast<const char *> (&value), sizeof (value));
+}
+
+/**
+ * Append a string to a buffer.
+ *
+ * \param [in,out] buffer The buffer.
+ * \param [in] value The string.
+ */
+void
+PutString (std::string *buffer, const std::string &value)
+{
+  Put<uint32_t> (buffer, value.size ());
+  buffer->append (value);
+}
+
+/** Read the values written by Put and PutString from a buffer. */
+class Reader
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] buffer The buffer, which must outlive the reader.
+   */
+  Reader (const std::string &buffer)
+    : m_buffer (buffer),
+      m_offset (0)
+  {
+  }
+  /**
+   * Check if the whole buffer was read.
+   *
+   * \returns \c true at the end of the buffer.
+   */
+  bool IsEnd (void) const
+  {
+    return m_offset >= m_buffer.size ();
+  }
+  /**
+   * Read a value.
+   *
+   * \returns The value.
+   */
+  template <typename T>
+  T Get (void)
+  {
+    T value;
+    NS_ABORT_MSG_IF (m_offset + sizeof (value) > m_buffer.size (), "Truncated replication results");
+    std::memcpy (&value, m_buffer.data () + m_offset, sizeof (value));
+    m_offset += sizeof (value);
+    return value;
+  }
+  /**
+   * Read a string.
+   *
+   * \returns The string.
+   */
+  std::string GetString (void)
+  {
+    uint32_t size = Get<uint32_t> ();
+    NS_ABORT_MSG_IF (m_offset + size > m_buffer.size (), "Truncated replication results");
+    std::string value = m_buffer.substr (m_offset, size);
+    m_offset += size;
+    return value;
+  }
+
+private:
+  const std::string &m_buffer;   //!< The buffer.
+  std::string::size_type m_offset;   //!< The offset of the next value.
+};
+
+/** A DataOutputCallback which records the output in a buffer. */
+class RecordingCallback : public DataOutputCallback
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in,out] buffer The buffer.
+   */
+  RecordingCallback (std::string *buffer)
+    : m_buffer (buffer)
+  {
+  }
+  virtual void OutputStatistic (std::string key, std::string variable,
+                                const StatisticalSummary *statSum)
+  {
+    Start (STATISTIC, key, variable);
+    Put<int64_t> (m_buffer, statSum->getCount ());
+    Put<double> (m_buffer, statSum->getSum ());
+    Put<double> (m_buffer, statSum->getSqrSum ());
+    Put<double> (m_buffer, statSum->getMin ());
+    Put<double> (m_buffer, statSum->getMax ());
+    Put<double> (m_buffer, statSum->getMean ());
+    Put<double> (m_buffer, statSum->getStddev ());
+    Put<double> (m_buffer, statSum->getVariance ());
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, int val)
+  {
+    Start (INT, key, variable);
+    Put<int32_t> (m_buffer, val);
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, uint32_t val)
+  {
+    Start (UINT, key, variable);
+    Put<uint32_t> (m_buffer, val);
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, double val)
+  {
+    Start (DOUBLE, key, variable);
+    Put<double> (m_buffer, val);
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, std::string val)
+  {
+    Start (STRING, key, variable);
+    PutString (m_buffer, val);
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, Time val)
+  {
+    Start (TIME, key, variable);
+    Put<int64_t> (m_buffer, val.GetTimeStep ());
+  }
+
+private:
+  /**
+   * Start a record.
+   *
+   * \param [in] kind The kind of record.
+   * \param [in] key The key of the calculator.
+   * \param [in] variable The name of the variable.
+   */
+  void Start (enum RecordKind kind, const std::string &key, const std::string &variable)
+  {
+    Put<uint8_t> (m_buffer, kind);
+    PutString (m_buffer, key);
+    PutString (m_buffer, variable);
+  }
+
+  std::string *m_buffer;   //!< The buffer.
+};
+
+/** A StatisticalSummary of recorded values. */
+class RecordedSummary : public StatisticalSummary
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in,out] reader The reader of the recorded values.
+   */
+  RecordedSummary (Reader *reader)
+  {
+    m_count = reader->Get<int64_t> ();
+    m_sum = reader->Get<double> ();
+    m_sqrSum = reader->Get<double> ();
+    m_min = reader->Get<double> ();
+    m_max = reader->Get<double> ();
+    m_mean = reader->Get<double> ();
+    m_stddev = reader->Get<double> ();
+    m_variance = reader->Get<double> ();
+  }
+  virtual long getCount () const { return m_count; }
+  virtual double getSum () const { return m_sum; }
+  virtual double getSqrSum () const { return m_sqrSum; }
+  virtual double getMin () const { return m_min; }
+  virtual double getMax () const { return m_max; }
+  virtual double getMean () const { return m_mean; }
+  virtual double getStddev () const { return m_stddev; }
+  virtual double getVariance () const { return m_variance; }
+
+private:
+  long m_count;        //!< Count.
+  double m_sum;        //!< Sum.
+  double m_sqrSum;     //!< Sum of the squares.
+  double m_min;        //!< Minimum.
+  double m_max;        //!< Maximum.
+  double m_mean;       //!< Mean.
+  double m_stddev;     //!< Standard deviation.
+  double m_variance;   //!< Variance.
+};
+
+/** A DataCalculator which replays the output of a replication. */
+class RecordedCalculator : public DataCalculator
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::RecordedCalculator")
+      .SetParent<DataCalculator> ()
+      .SetGroupName ("Stats")
+      .HideFromDocumentation ()
+    ;
+    return tid;
+  }
+  /**
+   * Set the output to replay.
+   *
+   * \param [in] records The records written by RecordingCallback.
+   */
+  void SetRecords (const std::string &records)
+  {
+    m_records = records;
+  }
+  virtual void Output (DataOutputCallback &callback) const
+  {
+    Reader reader (m_records);
+    while (!reader.IsEnd ())
+      {
+        uint8_t kind = reader.Get<uint8_t> ();
+        std::string key = reader.GetString ();
+        std::string variable = reader.GetString ();
+        switch (kind)
+          {
+          case STATISTIC:
+            {
+              RecordedSummary summary (&reader);
+              callback.OutputStatistic (key, variable, &summary);
+            }
+            break;
+          case INT:
+            callback.OutputSingleton (key, variable, static_cast<int> (reader.Get<int32_t> ()));
+            break;
+          case UINT:
+            callback.OutputSingleton (key, variable, reader.Get<uint32_t> ());
+            break;
+          case DOUBLE:
+            callback.OutputSingleton (key, variable, reader.Get<double> ());
+            break;
+          case STRING:
+            callback.OutputSingleton (key, variable, reader.GetString ());
+            break;
+          case TIME:
+            callback.OutputSingleton (key, variable, TimeStep (reader.Get<int64_t> ()));
+            break;
+          default:
+            NS_FATAL_ERROR ("Corrupted replication results");
+          }
+      }
+  }
+
+private:
+  std::string m_records;   //!< The records.
+};
+
+/**
+ * Write a DataCollector to a buffer.
+ *
+ * \param [in] collector The collector.
+ * \returns The buffer.
+ */
+std::string
+Serialize (Ptr<DataCollector> collector)
+{
+  std::string buffer;
+  PutString (&buffer, collector->GetExperimentLabel ());
+  PutString (&buffer, collector->GetStrategyLabel ());
+  PutString (&buffer, collector->GetInputLabel ());
+  PutString (&buffer, collector->GetRunLabel ());
+  PutString (&buffer, collector->GetDescription ());
+  for (MetadataList::iterator i = collector->MetadataBegin (); i != collector->MetadataEnd (); ++i)
+    {
+      Put<uint8_t> (&buffer, 'M');
+      PutString (&buffer, i->first);
+      PutString (&buffer, i->second);
+    }
+  for (DataCalculatorList::iterator i = collector->DataCalculatorBegin ();
+       i != collector->DataCalculatorEnd (); ++i)
+    {
+      std::string records;
+      RecordingCallback callback (&records);
+      (*i)->Output (callback);
+      Put<uint8_t> (&buffer, 'C');
+      PutString (&buffer, (*i)->GetKey ());
+      PutString (&buffer, (*i)->GetContext ());
+      PutString (&buffer, records);
+    }
+  return buffer;
+}
+
+/**
+ * Read a DataCollector from a buffer.
+ *
+ * \param [in] buffer The buffer written by Serialize.
+ * \returns The collector, with RecordedCalculator objects.
+ */
+Ptr<DataCollector>
+Deserialize (const std::string &buffer)
+{
+  Ptr<DataCollector> collector = CreateObject<DataCollector> ();
+  Reader reader (buffer);
+  std::string experiment = reader.GetString ();
+  std::string strategy = reader.GetString ();
+  std::string input = reader.GetString ();
+  std::string run = reader.GetString ();
+  std::string description = reader.GetString ();
+  collector->DescribeRun (experiment, strategy, input, run, description);
+  while (!reader.IsEnd ())
+    {
+      uint8_t kind = reader.Get<uint8_t> ();
+      std::string key = reader.GetString ();
+      std::string value = reader.GetString ();
+      if (kind == 'M')
+        {
+          collector->AddMetadata (key, value);
+          continue;
+        }
+      NS_ABORT_MSG_IF (kind != 'C', "Corrupted replication results");
+      Ptr<RecordedCalculator> calculator = CreateObject<RecordedCalculator> ();
+      calculator->SetKey (key);
+      calculator->SetContext (value);
+      calculator->SetRecords (reader.GetString ());
+      collector->AddDataCalculator (calculator);
+    }
+  return collector;
+}
+
+/**
+ * Write a whole buffer to a file descriptor.
+ *
+ * \param [in] fd The file descriptor.
+ * \param [in] buffer The buffer.
+ * \returns \c true on success.
+ */
+bool
+WriteAll (int fd, const std::string &buffer)
+{
+  std::string::size_type offset = 0;
+  while (offset < buffer.size ())
+    {
+      ssize_t written = write (fd, buffer.data () + offset, buffer.size () - offset);
+      if (written < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (written <= 0)
+        {
+          return false;
+        }
+      offset += written;
+    }
+  return true;
+}
+
+/** A replication running in a child process. */
+struct Child
+{
+  pid_t pid;             //!< The process.
+  uint32_t replication;  //!< The index of the replication.
+  std::string buffer;    //!< The results read so far.
+};
+
+} // unnamed namespace
+
+ReplicationHelper::ReplicationHelper ()
+  : m_replications (1),
+    m_parallel (1),
+    m_firstRun (RngSeedManager::GetRun ()),
+    m_nextStreamIndex (RngSeedManager::PeekNextStreamIndex ())
+{
+  NS_LOG_FUNCTION (this);
+  long processors = sysconf (_SC_NPROCESSORS_ONLN);
+  if (processors > 1)
+    {
+      m_parallel = processors;
+    }
+}
+
+void
+ReplicationHelper::SetReplications (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_replications = n;
+}
+
+void
+ReplicationHelper::SetParallel (uint32_t parallel)
+{
+  NS_LOG_FUNCTION (this << parallel);
+  NS_ASSERT (parallel > 0);
+  m_parallel = parallel;
+}
+
+void
+ReplicationHelper::SetFirstRun (uint64_t run)
+{
+  NS_LOG_FUNCTION (this << run);
+  m_firstRun = run;
+}
+
+void
+ReplicationHelper::AddOutput (Ptr<DataOutputInterface> output)
+{
+  NS_LOG_FUNCTION (this << output);
+  m_outputs.push_back (output);
+}
+
+Ptr<DataCollector>
+ReplicationHelper::RunOne (Replication replication, uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  // restart the streams which already exist too, and number the new
+  // ones, as they would be in a process started with this run number
+  SimulationCheckpoint::ResetStreams (m_firstRun + i);
+  RngSeedManager::SetNextStreamIndex (m_nextStreamIndex);
+  Ptr<DataCollector> collector = CreateObject<DataCollector> ();
+  replication (i, collector);
+  return collector;
+}
+
+void
+ReplicationHelper::Run (Replication replication)
+{
+  NS_LOG_FUNCTION (this);
+  // do not let the children write the buffered output again
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  m_collectors.assign (m_replications, Ptr<DataCollector> ());
+  std::map<int, struct Child> running;
+  uint32_t next = 0;
+  while (next < m_replications || !running.empty ())
+    {
+      if (next < m_replications && running.size () < m_parallel)
+        {
+          int fds[2];
+          if (pipe (fds) != 0)
+            {
+              NS_FATAL_ERROR ("Cannot create a pipe: " << std::strerror (errno));
+            }
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("Cannot fork replication " << next << ": " << std::strerror (errno));
+            }
+          if (pid == 0)
+            {
+              close (fds[0]);
+              std::string results = Serialize (RunOne (replication, next));
+              std::cout.flush ();
+              std::cerr.flush ();
+              std::fflush (0);
+              _exit (WriteAll (fds[1], results) ? 0 : 1);
+            }
+          close (fds[1]);
+          NS_LOG_LOGIC ("replication " << next << " is process " << pid);
+          struct Child child;
+          child.pid = pid;
+          child.replication = next;
+          running[fds[0]] = child;
+          next++;
+          continue;
+        }
+
+      // read the results of the children as they come, so that none of
+      // them blocks on a full pipe
+      std::vector<struct pollfd> fds;
+      for (std::map<int, struct Child>::const_iterator i = running.begin (); i != running.end (); ++i)
+        {
+          struct pollfd fd;
+          fd.fd = i->first;
+          fd.events = POLLIN;
+          fd.revents = 0;
+          fds.push_back (fd);
+        }
+      if (poll (&fds[0], fds.size (), -1) < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("Cannot wait for the replications: " << std::strerror (errno));
+        }
+      for (std::vector<struct pollfd>::const_iterator i = fds.begin (); i != fds.end (); ++i)
+        {
+          if (i->revents == 0)
+            {
+              continue;
+            }
+          struct Child &child = running[i->fd];
+          char chunk[65536];
+          ssize_t n = read (i->fd, chunk, sizeof (chunk));
+          if (n > 0)
+            {
+              child.buffer.append (chunk, n);
+              continue;
+            }
+          if (n < 0 && errno == EINTR)
+            {
+              continue;
+            }
+          close (i->fd);
+          int status;
+          while (waitpid (child.pid, &status, 0) < 0)
+            {
+              if (errno != EINTR)
+                {
+                  NS_FATAL_ERROR ("Cannot wait for replication " << child.replication << ": "
+                                  << std::strerror (errno));
+                }
+            }
+          if (n < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+            {
+              NS_FATAL_ERROR ("Replication " << child.replication << " failed");
+            }
+          m_collectors[child.replication] = Deserialize (child.buffer);
+          running.erase (i->fd);
+        }
+    }
+
+  for (std::vector<Ptr<DataOutputInterface> >::const_iterator output = m_outputs.begin ();
+       output != m_outputs.end (); ++output)
+    {
+      for (std::vector<Ptr<DataCollector> >::iterator i = m_collectors.begin ();
+           i != m_collectors.end (); ++i)
+        {
+          (*output)->Output (**i);
+        }
+    }
+}
+
+Ptr<DataCollector>
+ReplicationHelper::GetCollector (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  NS_ASSERT (i < m_collectors.size ());
+  return m_collectors[i];
+}
+
+} // namespace ns3
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLICATION_HELPER_H
+#define REPLICATION_HELPER_H
+
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+#include "ns3/data-collector.h"
+#include "ns3/data-output-interface.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup dataoutput
+ *
+ * \brief Run the independent replications of a Monte Carlo study in
+ * parallel, and gather their results.
+ *
+ * Each replication is run by a callback in a child process, which
+ * builds the simulation, runs it, fills the DataCollector it is given
+ * and destroys the simulation.  Replication \c i uses the random number
+ * run FirstRun + \c i, so that its random numbers come from its own
+ * sub-streams of the MRG32k3a generator, disjoint from those of the
+ * other replications.  It gets exactly the same random numbers as a
+ * process which calls the callback after setting the RngRun global
+ * value to this run number: the results are bit-for-bit those of the
+ * single-run mode.  The random number streams created by the
+ * replications are numbered from the next stream index when the helper
+ * is constructed, as they are in each such process.
+ *
+ * The child processes send their DataCollector back to the parent:
+ * its labels, its metadata and the output of its DataCalculator
+ * objects.  Once all the replications are done, the parent writes them
+ * in the order of the replications to the DataOutputInterface objects,
+ * for instance to a single SqliteDataOutput database, and keeps them
+ * for GetCollector().
+ *
+ * \code
+ *   void
+ *   RunOne (uint32_t replication, Ptr<DataCollector> collector)
+ *   {
+ *     // build the topology, install the calculators in collector
+ *     Simulator::Run ();
+ *     Simulator::Destroy ();
+ *   }
+ *
+ *   ReplicationHelper helper;
+ *   helper.SetReplications (200);
+ *   helper.AddOutput (CreateObject<SqliteDataOutput> ());
+ *   helper.Run (MakeCallback (&RunOne));
+ * \endcode
+ *
+ * The replications are processes rather than threads because the
+ * simulator and the random number streams are process-wide singletons.
+ */
+class ReplicationHelper
+{
+public:
+  /**
+   * The function which runs a replication: it is given the index of
+   * the replication and the DataCollector to fill.
+   */
+  typedef Callback<void, uint32_t, Ptr<DataCollector> > Replication;
+
+  /** Constructor. */
+  ReplicationHelper ();
+
+  /**
+   * Set the number of replications.
+   *
+   * \param [in] n The number of replications, 1 by default.
+   */
+  void SetReplications (uint32_t n);
+  /**
+   * Set the maximum number of replications run at once.
+   *
+   * \param [in] parallel The number of processes, by default the
+   *             number of processors online.
+   */
+  void SetParallel (uint32_t parallel);
+  /**
+   * Set the run number of the first replication.
+   *
+   * \param [in] run The run number, by default the RngRun global value
+   *             when the helper is constructed.
+   */
+  void SetFirstRun (uint64_t run);
+  /**
+   * Add an output to which the results of the replications are written.
+   *
+   * \param [in] output The output.
+   */
+  void AddOutput (Ptr<DataOutputInterface> output);
+
+  /**
+   * Run the replications, and write their results to the outputs.
+   *
+   * Must not be called while Simulator::Run is running.  The callback
+   * is never called in the calling process.
+   *
+   * \param [in] replication The function which runs a replication.
+   */
+  void Run (Replication replication);
+  /**
+   * Run a single replication in the calling process, as one of the
+   * replications of Run() would.
+   *
+   * The random number streams which exist in the process are
+   * restarted from the run of the replication, and the run number and
+   * the next stream index of RngSeedManager are left to those of the
+   * replication.
+   *
+   * \param [in] replication The function which runs a replication.
+   * \param [in] i The index of the replication.
+   * \returns The results of the replication.
+   */
+  Ptr<DataCollector> RunOne (Replication replication, uint32_t i) const;
+
+  /**
+   * Get the results of a replication of the last Run().
+   *
+   * The DataCalculator objects of the collector replay the output
+   * of those of the replication.
+   *
+   * \param [in] i The index of the replication.
+   * \returns The results.
+   */
+  Ptr<DataCollector> GetCollector (uint32_t i) const;
+
+private:
+  uint32_t m_replications;  //!< The number of replications.
+  uint32_t m_parallel;      //!< The maximum number of processes.
+  uint64_t m_firstRun;      //!< The run number of the first replication.
+  uint64_t m_nextStreamIndex;  //!< The stream index of the first new stream.
+  std::vector<Ptr<DataOutputInterface> > m_outputs;  //!< The outputs.
+  std::vector<Ptr<DataCollector> > m_collectors;     //!< The results.
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_HELPER_H */
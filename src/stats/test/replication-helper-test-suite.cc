@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/replication-helper.h"
+#include "ns3/basic-data-calculators.h"
+#include "ns3/data-collector.h"
+#include "ns3/data-output-interface.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/rng-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+// ===========================================================================
+// Output which writes the results of each run to a string, with the
+// exact bits of the floating point values.
+// ===========================================================================
+
+class StringDataOutput : public DataOutputInterface
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual void Output (DataCollector &dc);
+  std::vector<std::string> m_runs;
+
+private:
+  class Callback : public DataOutputCallback
+  {
+  public:
+    Callback (std::ostream &os) : m_os (os) {}
+    virtual void OutputStatistic (std::string key, std::string variable,
+                                  const StatisticalSummary *statSum)
+    {
+      m_os << key << " " << variable << " " << statSum->getCount ()
+           << " " << Hex (statSum->getSum ()) << " " << Hex (statSum->getMin ())
+           << " " << Hex (statSum->getMax ()) << " " << Hex (statSum->getVariance ()) << "\n";
+    }
+    virtual void OutputSingleton (std::string key, std::string variable, int val)
+    {
+      m_os << key << " " << variable << " int " << val << "\n";
+    }
+    virtual void OutputSingleton (std::string key, std::string variable, uint32_t val)
+    {
+      m_os << key << " " << variable << " uint " << val << "\n";
+    }
+    virtual void OutputSingleton (std::string key, std::string variable, double val)
+    {
+      m_os << key << " " << variable << " double " << Hex (val) << "\n";
+    }
+    virtual void OutputSingleton (std::string key, std::string variable, std::string val)
+    {
+      m_os << key << " " << variable << " string " << val << "\n";
+    }
+    virtual void OutputSingleton (std::string key, std::string variable, Time val)
+    {
+      m_os << key << " " << variable << " time " << val.GetTimeStep () << "\n";
+    }
+  private:
+    static std::string Hex (double value)
+    {
+      char buffer[64];
+      std::sprintf (buffer, "%a", value);
+      return buffer;
+    }
+    std::ostream &m_os;
+  };
+};
+
+TypeId
+StringDataOutput::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::StringDataOutput")
+    .SetParent<DataOutputInterface> ()
+    .HideFromDocumentation ()
+  ;
+  return tid;
+}
+
+void
+StringDataOutput::Output (DataCollector &dc)
+{
+  std::ostringstream oss;
+  oss << dc.GetExperimentLabel () << "/" << dc.GetRunLabel () << "\n";
+  for (MetadataList::iterator i = dc.MetadataBegin (); i != dc.MetadataEnd (); ++i)
+    {
+      oss << i->first << "=" << i->second << "\n";
+    }
+  Callback callback (oss);
+  for (DataCalculatorList::iterator i = dc.DataCalculatorBegin (); i != dc.DataCalculatorEnd (); ++i)
+    {
+      (*i)->Output (callback);
+    }
+  m_runs.push_back (oss.str ());
+}
+
+// ===========================================================================
+// A replication which draws random numbers in simulation events.
+// ===========================================================================
+
+static void
+Draw (Ptr<UniformRandomVariable> random, Ptr<MinMaxAvgTotalCalculator<double> > calculator)
+{
+  calculator->Update (random->GetValue ());
+}
+
+static void
+Count (Ptr<CounterCalculator<> > calculator)
+{
+  calculator->Update ();
+}
+
+static void
+RunReplication (uint32_t replication, Ptr<DataCollector> collector)
+{
+  std::ostringstream run;
+  run << replication;
+  collector->DescribeRun ("replication-test", "uniform", "none", run.str ());
+  collector->AddMetadata ("replication", replication);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  Ptr<MinMaxAvgTotalCalculator<double> > values = CreateObject<MinMaxAvgTotalCalculator<double> > ();
+  values->SetKey ("values");
+  Ptr<CounterCalculator<> > events = CreateObject<CounterCalculator<> > ();
+  events->SetKey ("events");
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &Draw, random, values);
+      Simulator::Schedule (Seconds (i), &Count, events);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  collector->AddDataCalculator (values);
+  collector->AddDataCalculator (events);
+}
+
+// ===========================================================================
+// Test case for the results of parallel replications.
+// ===========================================================================
+
+class ReplicationHelperTestCase : public TestCase
+{
+public:
+  ReplicationHelperTestCase ();
+  virtual ~ReplicationHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ReplicationHelperTestCase::ReplicationHelperTestCase ()
+  : TestCase ("Replications in parallel give the results of the single-run mode")
+{
+}
+
+ReplicationHelperTestCase::~ReplicationHelperTestCase ()
+{
+}
+
+void
+ReplicationHelperTestCase::DoRun (void)
+{
+  const uint32_t replications = 5;
+  // RunOne restarts the streams of the process, which the suites run
+  // later in this process may use: save them to restore them
+  uint64_t run = RngSeedManager::GetRun ();
+  uint64_t next = RngSeedManager::PeekNextStreamIndex ();
+  std::vector<uint32_t> states;
+  for (RngStream *stream = RngStream::GetFirst (); stream != 0; stream = stream->GetNext ())
+    {
+      uint32_t state[6];
+      stream->GetState (state);
+      states.insert (states.end (), state, state + 6);
+    }
+  ReplicationHelper helper;
+  helper.SetReplications (replications);
+  helper.SetParallel (3);
+  helper.SetFirstRun (10);
+  Ptr<StringDataOutput> output = CreateObject<StringDataOutput> ();
+  helper.AddOutput (output);
+  helper.Run (MakeCallback (&RunReplication));
+
+  NS_TEST_ASSERT_MSG_EQ (output->m_runs.size (), replications, "Missing replications");
+  Ptr<StringDataOutput> single = CreateObject<StringDataOutput> ();
+  for (uint32_t i = 0; i < replications; ++i)
+    {
+      single->Output (*helper.RunOne (MakeCallback (&RunReplication), i));
+      NS_TEST_EXPECT_MSG_EQ (output->m_runs[i], single->m_runs[i],
+                             "Replication " << i << " differs from the single-run mode");
+      std::ostringstream expected;
+      expected << "replication-test/" << i << "\nreplication=" << i << "\n";
+      NS_TEST_EXPECT_MSG_EQ (output->m_runs[i].substr (0, expected.str ().size ()), expected.str (),
+                             "Wrong labels or metadata");
+      NS_TEST_EXPECT_MSG_NE (output->m_runs[i].find (" events uint 100"), std::string::npos,
+                             "Counter not replayed");
+    }
+  NS_TEST_EXPECT_MSG_NE (output->m_runs[0], output->m_runs[1], "Replications share their random numbers");
+  NS_TEST_EXPECT_MSG_EQ (helper.GetCollector (2)->GetRunLabel (), "2", "Wrong collector");
+  RngSeedManager::SetRun (run);
+  RngSeedManager::SetNextStreamIndex (next);
+  std::vector<uint32_t>::const_iterator state = states.begin ();
+  for (RngStream *stream = RngStream::GetFirst (); stream != 0; stream = stream->GetNext ())
+    {
+      NS_TEST_ASSERT_MSG_EQ ((state != states.end ()), true, "Stream left by the replications");
+      stream->SetState (&*state);
+      state += 6;
+    }
+  NS_TEST_EXPECT_MSG_EQ ((state == states.end ()), true, "Stream destroyed by the replications");
+}
+
+class ReplicationHelperTestSuite : public TestSuite
+{
+public:
+  ReplicationHelperTestSuite ();
+};
+
+ReplicationHelperTestSuite::ReplicationHelperTestSuite ()
+  : TestSuite ("replication-helper", UNIT)
+{
+  AddTestCase (new ReplicationHelperTestCase, TestCase::QUICK);
+}
+
+static ReplicationHelperTestSuite replicationHelperTestSuite;
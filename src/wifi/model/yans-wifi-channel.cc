@@ -20,6 +20,7 @@
 
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/event-batch.h"
 #include "ns3/mobility-model.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
@@ -84,6 +85,7 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
   uint32_t j = 0;
+  EventBatch batch;
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
     {
       if (sender != (*i))
@@ -118,11 +120,12 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
           parameters.txVector = txVector;
           parameters.preamble = preamble;
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, parameters);
+          batch.Add (dstNode,
+                     delay, &YansWifiChannel::Receive, this,
+                     j, copy, parameters);
         }
     }
+  Simulator::ScheduleBatch (batch);
 }
 
 void
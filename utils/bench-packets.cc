@@ -350,6 +350,11 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
+  if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
+
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
@@ -184,6 +184,7 @@ int main (int argc, char *argv[])
 
   bool schedCal  = false;
   bool schedHeap = false;
+  bool schedLadder = false;
   bool schedList = false;
   bool schedMap  = true;
 
@@ -203,6 +204,7 @@ int main (int argc, char *argv[])
              "to be ascii, giving the relative event times in ns.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
@@ -218,6 +220,7 @@ int main (int argc, char *argv[])
   ObjectFactory factory ("ns3::MapScheduler");
   if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
   if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
+  if (schedLadder) { factory.SetTypeId ("ns3::LadderScheduler"); }
   if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
   Simulator::SetScheduler (factory);
 